@@ -0,0 +1,159 @@
+#ifndef CRYPTOQTAPP_H
+#define CRYPTOQTAPP_H
+
+/*
+ * C ABI of the CryptoQtApp engine (libcryptoqtapp.so), for in-process use
+ * by services that would otherwise spawn the CryptoQtApp CLI.
+ *
+ * Every exported symbol carries the ELF version of the release that added
+ * it, CQA_1.0, CQA_1.1 or CQA_1.2 (see src/cryptoqtapp.map). Later additions
+ * go into new version nodes and existing signatures never change, so binaries
+ * linked against this header keep working with newer libraries of the same
+ * major version. Check cqa_abi_version() at startup if you depend on a newer minor
+ * version.
+ *
+ * Contexts are opaque and not thread-safe; use one per stream. Functions
+ * return CQA_OK (0) or a negative CQA_E_* status and never throw.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CQA_ABI_VERSION_MAJOR 1
+#define CQA_ABI_VERSION_MINOR 2
+#define CQA_ABI_VERSION ((CQA_ABI_VERSION_MAJOR << 16) | CQA_ABI_VERSION_MINOR)
+
+#if defined(__GNUC__)
+#define CQA_API __attribute__((visibility("default")))
+#else
+#define CQA_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum cqa_status {
+    CQA_OK = 0,
+    CQA_E_ARGUMENT = -1,   /* bad parameter (null pointer, key size, ...) */
+    CQA_E_STATE = -2,      /* update after final, or a context that already failed */
+    CQA_E_IO = -3,         /* the write callback or a file operation failed */
+    CQA_E_AUTH = -4,       /* authentication or padding check failed (corrupt or wrong key) */
+    CQA_E_FORMAT = -5,     /* not a container / unsupported version / trailing data */
+    CQA_E_TRUNCATED = -6,  /* input ended before the final record */
+    CQA_E_NOMEM = -7,
+    CQA_E_INTERNAL = -8,
+    CQA_E_FILE = -9        /* a file of a batch failed; see the per-file results */
+};
+
+/* Output sink for cipher streams: return 0 on success, non-zero to abort. */
+typedef int (*cqa_write_fn)(void* user, const uint8_t* data, size_t len);
+
+/* (major << 16) | minor of the loaded library. */
+CQA_API uint32_t cqa_abi_version(void);
+CQA_API const char* cqa_strerror(int status);
+
+/* ---- Cipher streams ---- */
+
+enum cqa_cipher_format {
+    CQA_FORMAT_CONTAINER = 1, /* .cqac: AES-GCM records, authenticated */
+    CQA_FORMAT_AESCBC = 2     /* .aescbc: IV || AES-CBC (PKCS#7), as written by the GUI */
+};
+
+enum cqa_direction {
+    CQA_ENCRYPT = 1,
+    CQA_DECRYPT = 2
+};
+
+typedef struct cqa_cipher cqa_cipher;
+
+/*
+ * key_len: 16, 24 or 32. chunk_size: container record size, 0 = 1 MiB.
+ * iv_len: .aescbc IV size, 0 = 16. Output is passed to `write` as soon as
+ * it is available; when decrypting a container, plaintext is only passed
+ * on after its record authenticated.
+ */
+CQA_API int cqa_cipher_init(cqa_cipher** ctx, int format, int direction, const uint8_t* key, size_t key_len,
+                            uint32_t chunk_size, size_t iv_len, cqa_write_fn write, void* user);
+CQA_API int cqa_cipher_update(cqa_cipher* ctx, const uint8_t* data, size_t len);
+CQA_API int cqa_cipher_final(cqa_cipher* ctx);
+CQA_API void cqa_cipher_free(cqa_cipher* ctx);
+
+/* ---- Hashes ---- */
+
+enum cqa_hash_algo {
+    CQA_SHA256 = 1,
+    CQA_SHA512 = 2
+};
+
+typedef struct cqa_hash cqa_hash;
+
+CQA_API int cqa_hash_init(cqa_hash** ctx, int algo);
+CQA_API int cqa_hash_update(cqa_hash* ctx, const uint8_t* data, size_t len);
+/* *digest_len: capacity of digest on input, digest size on output (32 / 64). */
+CQA_API int cqa_hash_final(cqa_hash* ctx, uint8_t* digest, size_t* digest_len);
+CQA_API void cqa_hash_free(cqa_hash* ctx);
+
+/* ---- MAC (HMAC-SHA256) ---- */
+
+typedef struct cqa_mac cqa_mac;
+
+CQA_API int cqa_mac_init(cqa_mac** ctx, const uint8_t* key, size_t key_len);
+CQA_API int cqa_mac_update(cqa_mac* ctx, const uint8_t* data, size_t len);
+/* *mac_len: capacity on input, 32 on output. */
+CQA_API int cqa_mac_final(cqa_mac* ctx, uint8_t* mac, size_t* mac_len);
+CQA_API void cqa_mac_free(cqa_mac* ctx);
+
+/* ---- Small messages: AES-GCM seal / open (since 1.1) ---- */
+
+/*
+ * For tokens and other short payloads where latency matters. The key
+ * schedule is computed once by cqa_sealer_init; seal and open allocate
+ * nothing. Sealed messages are nonce (12) || ciphertext || tag (16); the
+ * sealer picks unique nonces itself. aad may be NULL when aad_len is 0.
+ */
+#define CQA_SEAL_OVERHEAD 28
+
+typedef struct cqa_sealer cqa_sealer;
+
+CQA_API int cqa_sealer_init(cqa_sealer** ctx, const uint8_t* key, size_t key_len);
+/* *out_len: capacity on input (at least len + CQA_SEAL_OVERHEAD), sealed size on output. */
+CQA_API int cqa_seal(cqa_sealer* ctx, const uint8_t* aad, size_t aad_len, const uint8_t* in, size_t len,
+                     uint8_t* out, size_t* out_len);
+/* *out_len: capacity on input (at least len - CQA_SEAL_OVERHEAD), plaintext size on output.
+   CQA_E_AUTH if the message was altered or sealed with another key or aad. */
+CQA_API int cqa_open(cqa_sealer* ctx, const uint8_t* aad, size_t aad_len, const uint8_t* in, size_t len,
+                     uint8_t* out, size_t* out_len);
+CQA_API void cqa_sealer_free(cqa_sealer* ctx);
+
+/* ---- Bulk AES-CTR, in parallel on the engine's worker pool (since 1.2) ---- */
+
+/*
+ * XORs len bytes of AES-CTR keystream into out (which may equal in); the
+ * same call encrypts and decrypts. iv is the 16-byte initial counter block,
+ * incremented as one big-endian 128-bit number. offset is the position of
+ * in[0] in the stream, so a large stream can be processed in pieces of any
+ * size. Buffers of 1 MiB or more are split over the worker pool.
+ * Unauthenticated: pair it with a MAC, or use the container format.
+ */
+CQA_API int cqa_ctr_xor(const uint8_t* key, size_t key_len, const uint8_t iv[16], uint64_t offset,
+                        const uint8_t* in, uint8_t* out, size_t len);
+
+/* ---- Files, in parallel on the engine's worker pool ---- */
+
+/*
+ * Encrypts src[i] into the container dst[i] (written as "<dst>.part", synced,
+ * renamed). results (may be NULL) receives a status per file. Returns CQA_OK
+ * if every file succeeded, CQA_E_FILE otherwise.
+ */
+CQA_API int cqa_encrypt_files(const char* const* src, const char* const* dst, size_t count,
+                              const uint8_t* key, size_t key_len, uint32_t chunk_size, int* results);
+/* Decrypts .cqac / .aescbc files (chosen by extension) into dst[i]. iv_len: 0 = 16. */
+CQA_API int cqa_decrypt_files(const char* const* src, const char* const* dst, size_t count,
+                              const uint8_t* key, size_t key_len, size_t iv_len, int* results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRYPTOQTAPP_H */
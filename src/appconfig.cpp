@@ -0,0 +1,29 @@
+#include "appconfig.h"
+
+#include <QFile>          // read config file
+#include <QJsonDocument>  // parse JSON
+#include <QJsonObject>    // JSON objects
+
+
+/**
+ * @brief Loads cryptographic configuration from a JSON file.
+ *
+ * @param path Path of the config file (normally "config.json").
+ * @param cfg Receives the values; left untouched unless the file parses.
+ * @return Loaded, or Missing / Invalid when defaults must be used.
+ */
+ConfigStatus loadCryptoConfig(const QString& path, CryptoConfig& cfg) {
+    QFile f(path);
+    if (!f.open(QFile::ReadOnly)) return ConfigStatus::Missing; ///< Use defaults if file missing
+
+    QJsonDocument doc = QJsonDocument::fromJson(f.readAll()); ///< Parse JSON
+    if (!doc.isObject()) return ConfigStatus::Invalid;        ///< Use defaults if invalid
+
+    QJsonObject obj = doc.object();
+    ///< Read config values, provide defaults if missing
+    cfg.aesKeyBytes  = obj.value("aes_key_bytes").toInt(cfg.aesKeyBytes);
+    cfg.aesIvBytes   = obj.value("aes_iv_bytes").toInt(cfg.aesIvBytes);
+    cfg.hmacKeyBytes = obj.value("hmac_key_bytes").toInt(cfg.hmacKeyBytes);
+    cfg.hashAlgorithm = obj.value("hash_algorithm").toString(cfg.hashAlgorithm);
+    return ConfigStatus::Loaded;
+}
@@ -0,0 +1,16 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <QString>  // config file path
+
+// Crypto parameters read from config.json, shared by the GUI and the CLI.
+struct CryptoConfig {
+    int aesKeyBytes = 32;
+    int aesIvBytes = 16;
+    int hmacKeyBytes = 32;
+    QString hashAlgorithm = "SHA-256"; // digests: CLI hash / --digests, GUI encrypt digests
+};
+
+enum class ConfigStatus { Loaded, Missing, Invalid };
+
+// Fills `cfg` from the JSON file at `path`; missing keys keep their defaults.
+ConfigStatus loadCryptoConfig(const QString& path, CryptoConfig& cfg);
@@ -0,0 +1,212 @@
+#include "armor.h"
+
+#include <algorithm>  // std::min
+#include <cstring>    // memcpy
+
+using namespace CryptoPP;
+
+static const char kBeginPrefix[] = "-----BEGIN ";
+static const char kEndPrefix[] = "-----END ";
+static const char kDashes[] = "-----";
+
+// ---------------- Helper functions ------------------
+
+static bool startsWith(const std::string& s, const char* prefix) {
+    return s.compare(0, std::strlen(prefix), prefix) == 0;
+}
+
+/**
+ * @brief Returns the label of a "-----BEGIN <label>-----" / "-----END <label>-----" line, or "".
+ */
+static std::string lineLabel(const std::string& line, const char* prefix) {
+    const size_t p = std::strlen(prefix), d = std::strlen(kDashes);
+    if (line.size() <= p + d || !startsWith(line, prefix) || line.compare(line.size() - d, d, kDashes) != 0)
+        return std::string();
+    return line.substr(p, line.size() - p - d);
+}
+
+/**
+ * @brief Removes trailing CR / spaces (armor copied through Windows tools or mail).
+ */
+static std::string trimLine(const char* data, size_t n) {
+    while (n > 0 && (data[n - 1] == '\r' || data[n - 1] == ' ' || data[n - 1] == '\t')) --n;
+    return std::string(data, n);
+}
+
+static std::string crcHex(CRC32C& crc) {
+    unsigned char digest[CRC32C::DIGESTSIZE];
+    crc.Final(digest);
+    return toHex(digest, sizeof(digest));
+}
+
+
+bool looksArmored(const char* data, size_t n) {
+    size_t i = 0;
+    while (i < n && (data[i] == ' ' || data[i] == '\t' || data[i] == '\r' || data[i] == '\n')) ++i;
+    const size_t p = std::strlen(kBeginPrefix);
+    return n - i >= p && std::memcmp(data + i, kBeginPrefix, p) == 0;
+}
+
+
+// ---------------- ArmorWriter ------------------
+
+ArmorWriter::ArmorWriter(ByteWriter out, std::string label, size_t lineLength)
+    : out(std::move(out)), label(std::move(label)), encoder(lineLength) {}
+
+
+bool ArmorWriter::begin() {
+    begun = true;
+    const std::string line = kBeginPrefix + label + kDashes + "\n";
+    return out(reinterpret_cast<const unsigned char*>(line.data()), line.size());
+}
+
+
+/**
+ * @brief Checksums and encodes `data`; whole lines are passed on immediately.
+ */
+bool ArmorWriter::update(const unsigned char* data, size_t n) {
+    if (!begun && !begin()) return false;
+    crc.Update(data, n);
+    text.clear();
+    encoder.update(data, n, text);
+    return out(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+}
+
+
+/**
+ * @brief Writes the padded last line, the checksum line and the END line.
+ */
+bool ArmorWriter::final() {
+    if (!begun && !begin()) return false; ///< empty input still gets a complete armor block
+    text.clear();
+    encoder.final(text);
+    text += "=" + crcHex(crc) + "\n" + kEndPrefix + label + kDashes + "\n";
+    return out(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+}
+
+
+ByteWriter ArmorWriter::writer() {
+    return [this](const unsigned char* data, size_t n) { return update(data, n); };
+}
+
+
+// ---------------- ArmorReader ------------------
+
+ArmorReader::ArmorReader(ByteReader in) : in(std::move(in)) {}
+
+
+bool ArmorReader::fail(const std::string& why) {
+    if (failure.empty()) failure = why;
+    return false;
+}
+
+
+/**
+ * @brief Consumes the complete lines at the start of `text`.
+ *
+ * Body text is handed to the decoder in large spans: only lines starting
+ * with '=' (checksum) or '-' (END), neither of which is in the base64
+ * alphabet, end it. `text` always starts at a line boundary.
+ *
+ * @param last No more input follows, so a final line without '\n' counts.
+ */
+bool ArmorReader::parse(bool last) {
+    size_t pos = 0;
+    while (pos < text.size() && state != State::Done) {
+        if (state == State::Body && text[pos] != '=' && text[pos] != '-') {
+            const size_t stop = std::min(text.find("\n=", pos), text.find("\n-", pos));
+            size_t end = text.size();
+            if (stop != std::string::npos) {
+                end = stop + 1;
+            } else if (!last) { ///< keep an incomplete last line for the next chunk
+                const size_t nl = text.rfind('\n');
+                if (nl == std::string::npos || nl < pos) break;
+                end = nl + 1;
+            }
+            const size_t at = decoded.size();
+            if (!decoder.update(text.data() + pos, end - pos, decoded))
+                return fail("armor body is not valid base64");
+            crc.Update(reinterpret_cast<const byte*>(decoded.data() + at), decoded.size() - at);
+            pos = end;
+            continue;
+        }
+
+        const size_t nl = text.find('\n', pos);
+        if (nl == std::string::npos && !last) break;
+        const size_t lineEnd = nl == std::string::npos ? text.size() : nl;
+        const std::string line = trimLine(text.data() + pos, lineEnd - pos);
+        pos = nl == std::string::npos ? text.size() : nl + 1;
+
+        switch (state) {
+        case State::Preamble:
+            armorLabel = lineLabel(line, kBeginPrefix);
+            if (!armorLabel.empty()) state = State::Body;
+            break;
+        case State::Body:
+            if (line[0] == '-') return fail("armor has no checksum line");
+            {
+                const size_t at = decoded.size();
+                if (!decoder.final(decoded)) return fail("armor body is truncated");
+                crc.Update(reinterpret_cast<const byte*>(decoded.data() + at), decoded.size() - at);
+            }
+            if (line.substr(1) != crcHex(crc)) return fail("armor checksum mismatch (damaged in transit)");
+            state = State::Trailer;
+            break;
+        case State::Trailer:
+            if (line.empty()) break;
+            if (lineLabel(line, kEndPrefix) != armorLabel) return fail("armor END line does not match BEGIN");
+            state = State::Done;
+            break;
+        case State::Done:
+            break;
+        }
+    }
+    text.erase(0, state == State::Done ? text.size() : pos);
+    if (state == State::Preamble && text.size() > kStreamChunkBytes)
+        return fail("no armor BEGIN line found"); ///< binary input would otherwise be buffered whole
+    return true;
+}
+
+
+/**
+ * @brief Reads one chunk of text and decodes what it completes.
+ */
+bool ArmorReader::fill() {
+    const size_t at = text.size();
+    text.resize(at + kStreamChunkBytes);
+    const ssize_t n = in(reinterpret_cast<unsigned char*>(&text[at]), kStreamChunkBytes);
+    if (n < 0) {
+        text.resize(at);
+        return fail("read failed");
+    }
+    text.resize(at + static_cast<size_t>(n));
+    inputEnded = static_cast<size_t>(n) < kStreamChunkBytes;
+    if (!parse(inputEnded)) return false;
+    if (inputEnded && state != State::Done)
+        return fail(state == State::Preamble ? "no armor BEGIN line found" : "armor is truncated (no END line)");
+    return true;
+}
+
+
+/**
+ * @brief Returns up to `n` dearmored bytes; fewer only once the END line was checked.
+ */
+ssize_t ArmorReader::read(unsigned char* buf, size_t n) {
+    if (!failure.empty()) return -1;
+    while (decoded.size() - decodedPos < n && state != State::Done) {
+        if (decodedPos > 0) { ///< drop what was already returned before growing
+            decoded.erase(0, decodedPos);
+            decodedPos = 0;
+        }
+        if (!fill()) return -1;
+    }
+    const size_t take = std::min(n, decoded.size() - decodedPos);
+    std::memcpy(buf, decoded.data() + decodedPos, take);
+    decodedPos += take;
+    return static_cast<ssize_t>(take);
+}
+
+
+ByteReader ArmorReader::reader() {
+    return [this](unsigned char* buf, size_t n) { return read(buf, n); };
+}
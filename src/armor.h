@@ -0,0 +1,81 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include "fdio.h"       // ByteReader / ByteWriter
+#include "textcodec.h"  // streaming base64
+
+#include <cstddef>  // size_t
+#include <string>   // labels, error text
+
+#include <cryptopp/crc.h> // CRC-32C (hardware accelerated where available)
+
+// ASCII armor for ciphertext on text-only transports. Layout:
+//
+//   -----BEGIN <label>-----
+//   <base64, kArmorLineLength characters per line>
+//   =<CRC-32C of the binary data, 8 hex digits>
+//   -----END <label>-----
+//
+// Encoding and decoding wrap the binary writer / reader of an encryption
+// pass, so armoring costs no extra pass over the data. The checksum catches
+// transport damage before (CBC) or in addition to (container) the cipher's
+// own checks.
+
+constexpr size_t kArmorLineLength = 64;
+constexpr const char* kArmorLabelAescbc = "CRYPTOQTAPP AESCBC";
+constexpr const char* kArmorLabelContainer = "CRYPTOQTAPP CONTAINER";
+
+// True if `data` (leading whitespace skipped) starts with a BEGIN line.
+bool looksArmored(const char* data, size_t n);
+
+// Armors everything written through it into `out`. The BEGIN line goes out
+// with the first write; call final() once after the last one.
+class ArmorWriter {
+public:
+    ArmorWriter(ByteWriter out, std::string label, size_t lineLength = kArmorLineLength);
+
+    bool update(const unsigned char* data, size_t n);
+    bool final();                 // last line, checksum and END line
+    ByteWriter writer();          // update() as a ByteWriter; this object must outlive it
+
+private:
+    bool begin();
+
+    ByteWriter out;
+    std::string label;
+    Base64StreamEncoder encoder;
+    CryptoPP::CRC32C crc;
+    std::string text;             ///< encoded output of the current call
+    bool begun = false;
+};
+
+// Dearmors `in` on the fly. Text before the BEGIN line is ignored; read()
+// fails (-1, see error()) on malformed armor, a missing END line or a
+// checksum mismatch, which is detected before the last short read.
+class ArmorReader {
+public:
+    explicit ArmorReader(ByteReader in);
+
+    ssize_t read(unsigned char* buf, size_t n); // like readFull()
+    ByteReader reader();                        // read() as a ByteReader; this object must outlive it
+
+    const std::string& label() const { return armorLabel; } // from the BEGIN line, once seen
+    const std::string& error() const { return failure; }
+
+private:
+    enum class State { Preamble, Body, Trailer, Done };
+
+    bool fill();                          // reads and parses more input
+    bool parse(bool last);                // consumes complete lines of `text`
+    bool fail(const std::string& why);
+
+    ByteReader in;
+    std::string text;                     ///< input not yet parsed
+    std::string decoded;                  ///< binary data not yet returned
+    size_t decodedPos = 0;
+    Base64StreamDecoder decoder;
+    CryptoPP::CRC32C crc;
+    State state = State::Preamble;
+    bool inputEnded = false;
+    std::string armorLabel;
+    std::string failure;
+};
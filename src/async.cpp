@@ -0,0 +1,204 @@
+#include "async.h"
+#include "container.h"   // ContainerCodec, record layout
+#include "streamhash.h"  // fused digests
+#include "throttle.h"    // caller's throttle carried to pool steps
+#include "workerpool.h"  // shared pool
+
+#include <cstdio>     // rename
+#include <vector>     // record buffers
+
+#include <QMetaObject> // queued calls into the Qt event loop
+#include <QObject>
+
+#include <fcntl.h>    // open
+#include <unistd.h>   // close, fdatasync, unlink
+
+// Crypto++ includes
+#include <cryptopp/cryptlib.h> // CryptoPP::Exception
+#include <cryptopp/osrng.h>    // salt generation
+
+using namespace CryptoPP;
+
+// ---------------- Executors ------------------
+
+void QtExecutor::post(std::function<void()> fn) {
+    QMetaObject::invokeMethod(context, std::move(fn), Qt::QueuedConnection);
+}
+
+
+void LoopExecutor::post(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(fn));
+    }
+    cv.notify_one();
+}
+
+
+/**
+ * @brief Runs posted continuations on the calling thread until stop().
+ */
+void LoopExecutor::run() {
+    for (;;) {
+        std::function<void()> fn;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                stopping = false; ///< the loop can be run again
+                return;
+            }
+            fn = std::move(queue.front());
+            queue.pop_front();
+        }
+        fn();
+    }
+}
+
+
+void LoopExecutor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_one();
+}
+
+
+/**
+ * @brief Queues fn on the shared pool, running it under the submitting thread's throttle.
+ */
+void submitToPool(std::function<void()> fn) {
+    Throttle* throttle = currentThrottle();
+    WorkerPool::shared().submit([throttle, fn = std::move(fn)] {
+        ThrottleScope scope(throttle);
+        fn();
+    });
+}
+
+
+// ---------------- Engine operations ------------------
+
+/**
+ * @brief Encrypts a stream into a container without blocking the caller.
+ *
+ * Same output as encryptContainer(); each pool step reads one chunk ahead,
+ * seals the current record and writes it, then the coroutine continues on
+ * opt.executor (progress, cancellation) before scheduling the next step.
+ *
+ * @param in Plaintext source (used on pool threads, one step at a time).
+ * @param out Container destination (same).
+ * @param key Master key.
+ * @param opt Executor, chunk size, progress, cancellation and digests.
+ * @return Result with ok / error and the plaintext size.
+ */
+Task<AsyncResult> encryptAsync(ByteReader in, ByteWriter out, SecByteBlock key, AsyncOptions opt) {
+    AsyncResult res;
+    const uint32_t chunkSize = opt.chunkSize;
+    if (chunkSize == 0 || chunkSize > kMaxChunkBytes) {
+        res.error = "invalid chunk size";
+        co_return res;
+    }
+
+    HashTransformation* plainHash = opt.digests ? opt.digests->plain : nullptr;
+    out = hashingWriter(std::move(out), opt.digests ? opt.digests->cipher : nullptr);
+
+    try {
+        ContainerHeader hdr;
+        hdr.chunkSize = chunkSize;
+        AutoSeededRandomPool rng;
+        rng.GenerateBlock(hdr.salt, kContainerSaltBytes);
+        ContainerCodec codec(key, hdr);
+
+        std::vector<byte> cur(chunkSize), next(chunkSize);
+        std::vector<byte> record(containerRecordBytes(chunkSize));
+        ssize_t curLen = co_await onPool(opt.executor, [&] {
+            return out(codec.headerBytes(), kContainerHeaderBytes) ? in(cur.data(), chunkSize) : ssize_t(-2);
+        });
+        if (curLen < 0) {
+            res.error = curLen == -2 ? "write failed" : "read failed";
+            co_return res;
+        }
+
+        for (uint32_t index = 0;; ++index) {
+            if (opt.cancel && opt.cancel->load()) {
+                res.error = "cancelled";
+                co_return res;
+            }
+            struct Step { ssize_t nextLen; bool written; };
+            Step step = co_await onPool(opt.executor, [&]() -> Step {
+                ssize_t nextLen = 0;
+                if (static_cast<size_t>(curLen) == chunkSize) {
+                    nextLen = in(next.data(), chunkSize);
+                    if (nextLen < 0) return { -1, false };
+                }
+                const bool last = (nextLen == 0);
+                if (index == UINT32_MAX && !last) return { -2, false };
+                if (plainHash) plainHash->Update(cur.data(), static_cast<size_t>(curLen));
+                codec.seal(index, static_cast<uint8_t>(kRecordData | (last ? kRecordFinal : 0)),
+                           cur.data(), static_cast<size_t>(curLen), record.data());
+                return { nextLen, out(record.data(), containerRecordBytes(static_cast<size_t>(curLen))) };
+            });
+            if (step.nextLen == -1) { res.error = "read failed"; co_return res; }
+            if (step.nextLen == -2) { res.error = "input too large for this chunk size"; co_return res; }
+            if (!step.written) { res.error = "write failed"; co_return res; }
+
+            res.plainBytes += static_cast<uint64_t>(curLen);
+            if (opt.progress) opt.progress(res.plainBytes);
+            if (step.nextLen == 0) break;
+            cur.swap(next);
+            curLen = step.nextLen;
+        }
+        res.ok = true;
+    } catch (const Exception& e) {
+        res.error = e.what();
+    }
+    co_return res;
+}
+
+
+/**
+ * @brief Encrypts a file into a container, publishing it with an atomic rename.
+ *
+ * @param src Plaintext file.
+ * @param dst Final container path; "<dst>.part" is used while writing.
+ * @param key Master key.
+ * @param opt Executor, chunk size, progress, cancellation and digests.
+ * @return Result with ok / error and the plaintext size.
+ */
+Task<AsyncResult> encryptAsync(std::string src, std::string dst, SecByteBlock key, AsyncOptions opt) {
+    const std::string tmp = dst + ".part";
+    struct Fds { int in = -1, out = -1; };
+    Fds fds = co_await onPool(opt.executor, [&] {
+        Fds f;
+        f.in = ::open(src.c_str(), O_RDONLY | O_CLOEXEC);
+        if (f.in >= 0) {
+            tuneStreamFd(f.in);
+            f.out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        }
+        return f;
+    });
+    if (fds.in < 0 || fds.out < 0) {
+        if (fds.in >= 0) ::close(fds.in);
+        AsyncResult res;
+        res.error = fds.in < 0 ? "cannot open " + src : "cannot create " + tmp;
+        co_return res;
+    }
+
+    AsyncResult res = co_await encryptAsync(fdReader(fds.in), fdWriter(fds.out), key, opt);
+
+    std::string error = co_await onPool(opt.executor, [&] {
+        std::string e;
+        ::close(fds.in);
+        if (res.ok && ::fdatasync(fds.out) != 0) e = "sync failed"; ///< data must be on disk before the name appears
+        if (::close(fds.out) != 0 && res.ok && e.empty()) e = "close failed";
+        if (res.ok && e.empty() && std::rename(tmp.c_str(), dst.c_str()) != 0) e = "rename failed";
+        if (!res.ok || !e.empty()) ::unlink(tmp.c_str());
+        return e;
+    });
+    if (res.ok && !error.empty()) {
+        res.ok = false;
+        res.error = error;
+    }
+    co_return res;
+}
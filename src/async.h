@@ -0,0 +1,238 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include "fdio.h"       // ByteReader / ByteWriter
+
+#include <atomic>       // cancellation flag
+#include <condition_variable> // LoopExecutor wake-up
+#include <coroutine>    // C++20 coroutines
+#include <cstdint>      // byte counts
+#include <deque>        // LoopExecutor queue
+#include <exception>    // exception_ptr across threads
+#include <functional>   // posted continuations
+#include <mutex>        // LoopExecutor queue
+#include <optional>     // task results
+#include <string>       // paths, error text
+#include <type_traits>  // invoke_result
+#include <utility>      // exchange, move
+
+#include <cryptopp/secblock.h> // SecByteBlock keys
+
+class QObject;
+
+// Coroutine API for event-driven callers (the GUI, services with their own
+// loop): `co_await encryptAsync(...)` never blocks the calling thread.
+// Each step that touches files or AES runs on WorkerPool::shared(); the
+// coroutine then continues on its Executor, i.e. back on the caller's event
+// loop, where it can update widgets or answer requests between chunks.
+//
+// Tasks are lazy: nothing runs until the task is awaited or spawn()ed.
+
+// Where a coroutine continues after an offloaded step.
+class Executor {
+public:
+    virtual ~Executor() = default;
+    virtual void post(std::function<void()> fn) = 0; // thread-safe
+};
+
+// Continues on the thread of `context` via its Qt event loop (queued call).
+class QtExecutor : public Executor {
+public:
+    explicit QtExecutor(QObject* context) : context(context) {}
+    void post(std::function<void()> fn) override;
+
+private:
+    QObject* context;
+};
+
+// Small event loop for code without Qt: posted continuations run inside run().
+class LoopExecutor : public Executor {
+public:
+    void post(std::function<void()> fn) override;
+    void run();   // until stop()
+    void stop();
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> queue;
+    bool stopping = false;
+};
+
+// ---------------- Task ------------------
+
+template<class T> class Task;
+
+namespace asyncdetail {
+
+template<class Promise>
+struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+        std::coroutine_handle<> next = h.promise().continuation;
+        return next ? next : std::noop_coroutine(); ///< symmetric transfer to the awaiting coroutine
+    }
+    void await_resume() noexcept {}
+};
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+// Fire-and-forget frame used by spawn(); frees itself when done.
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+} // namespace asyncdetail
+
+// Lazily started coroutine producing a T (or nothing for Task<void>).
+template<class T>
+class Task {
+public:
+    struct promise_type : asyncdetail::PromiseBase {
+        std::optional<T> value;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        asyncdetail::FinalAwaiter<promise_type> final_suspend() noexcept { return {}; }
+        void return_value(T v) { value = std::move(v); }
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { if (handle) handle.destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    T await_resume() {
+        if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+        return std::move(*handle.promise().value);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    std::coroutine_handle<promise_type> handle;
+};
+
+template<>
+class Task<void> {
+public:
+    struct promise_type : asyncdetail::PromiseBase {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        asyncdetail::FinalAwaiter<promise_type> final_suspend() noexcept { return {}; }
+        void return_void() {}
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { if (handle) handle.destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    void await_resume() {
+        if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Starts a task from non-coroutine code (e.g. a Qt slot); `done` receives
+// its result on the thread the task finishes on (its executor).
+template<class T, class Done>
+void spawn(Task<T> task, Done done) {
+    [](Task<T> t, Done d) -> asyncdetail::Detached {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(t);
+            d();
+        } else {
+            d(co_await std::move(t));
+        }
+    }(std::move(task), std::move(done));
+}
+
+// ---------------- Offloading ------------------
+
+// Submits fn to the shared WorkerPool under the caller's throttle (defined in async.cpp).
+void submitToPool(std::function<void()> fn);
+
+// Awaitable returned by onPool(): runs fn on the pool, resumes on `exec`
+// (or directly on the pool thread when exec is null).
+template<class F>
+class PoolAwaiter {
+public:
+    using Result = std::invoke_result_t<F&>;
+
+    PoolAwaiter(Executor* exec, F fn) : exec(exec), fn(std::move(fn)) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+        submitToPool([this, h] {
+            try {
+                if constexpr (std::is_void_v<Result>) fn();
+                else result.emplace(fn());
+            } catch (...) {
+                error = std::current_exception();
+            }
+            if (exec) exec->post([h] { h.resume(); });
+            else h.resume();
+        });
+    }
+    Result await_resume() {
+        if (error) std::rethrow_exception(error);
+        if constexpr (!std::is_void_v<Result>) return std::move(*result);
+    }
+
+private:
+    struct Empty {};
+    Executor* exec;
+    F fn;
+    std::conditional_t<std::is_void_v<Result>, Empty, std::optional<Result>> result;
+    std::exception_ptr error;
+};
+
+template<class F>
+PoolAwaiter<F> onPool(Executor* exec, F fn) {
+    return PoolAwaiter<F>(exec, std::move(fn));
+}
+
+// ---------------- Engine operations ------------------
+
+struct StreamDigests; // streamhash.h
+
+struct AsyncOptions {
+    Executor* executor = nullptr;               // where the coroutine continues; null = pool threads
+    uint32_t chunkSize = 1u << 20;              // container record size
+    std::function<void(uint64_t plainBytes)> progress; // after each record, on the executor
+    const std::atomic<bool>* cancel = nullptr;  // checked between records
+    const StreamDigests* digests = nullptr;     // plaintext / container hashes, updated on pool threads
+};
+
+struct AsyncResult {
+    bool ok = false;
+    std::string error;
+    uint64_t plainBytes = 0;
+};
+
+// Encrypts a stream into a container (.cqac), one record per pool step.
+Task<AsyncResult> encryptAsync(ByteReader in, ByteWriter out, CryptoPP::SecByteBlock key, AsyncOptions opt);
+// Encrypts a file into a container at `dst` ("<dst>.part", fdatasync, rename).
+Task<AsyncResult> encryptAsync(std::string src, std::string dst, CryptoPP::SecByteBlock key, AsyncOptions opt);
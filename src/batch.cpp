@@ -0,0 +1,321 @@
+#include "batch.h"
+#include "container.h"   // encryptContainer
+#include "fdio.h"        // fdReader / writeAll, tuneStreamFd
+#include "journal.h"     // resumable runs
+#include "numa.h"        // ScratchBuffer
+#include "textcodec.h"   // journaled output digest
+#include "throttle.h"    // ConcurrencyLimiter, throttle propagation
+#include "workerpool.h"  // shared pool
+
+#include <algorithm>          // min
+#include <condition_variable> // wait for queued jobs
+#include <cstdio>             // rename
+#include <filesystem>         // create_directories
+#include <mutex>
+
+#include <fcntl.h>     // open
+#include <sys/stat.h>  // fstat (input identity)
+#include <unistd.h>    // close, fdatasync, ftruncate, pread, access
+
+// Crypto++ includes
+#include <cryptopp/cryptlib.h> // CryptoPP::Exception
+#include <cryptopp/sha.h>      // SHA-256 of each output
+
+namespace fs = std::filesystem;
+using namespace CryptoPP;
+
+static const unsigned kJobsPerWorker = 2; ///< queued ahead so workers never wait on the walk
+static const uint64_t kCheckpointBytes = 64ull << 20; ///< journal progress interval per file
+
+// ---------------- Single file ------------------
+
+/**
+ * @brief Whether the input is provably the file a partial output was sealed from.
+ *
+ * Resuming keeps the partial output's salt, so records from the checkpoint
+ * on are sealed again under the same (key, nonce) pairs; different plaintext
+ * there would reuse GCM nonces. Size and mtime alone do not prove identity
+ * (rsync -t, touch -r and 1 s timestamps preserve them), so the inode and the
+ * ctime, which every write bumps and nothing can set back, must match too.
+ * A ctime without a sub-second part comes from a coarse-timestamp filesystem
+ * where a rewrite within the same second would go unnoticed, so it is not
+ * trusted. Journals from older builds carry no ctime (0) and never match.
+ */
+static bool sameInput(const JobJournal::Job& journaled, const JobJournal::Job& now) {
+    return journaled.ctimeNs != 0 && now.ctimeNs % 1000000000 != 0
+        && journaled.size == now.size && journaled.mtimeNs == now.mtimeNs
+        && journaled.inode == now.inode && journaled.ctimeNs == now.ctimeNs;
+}
+
+
+/**
+ * @brief Checks whether a journaled partial output can be continued.
+ *
+ * The last kept record must authenticate under `key` as a non-final data
+ * record, so a run with a different key (or a prefix that was already
+ * finished) starts over instead of appending to a container nobody can open.
+ *
+ * @param out Partial output, opened read/write.
+ * @param job Journal state (InProgress) with the durable record count.
+ * @param key Master key of this run.
+ * @param hdr Receives the container header of the partial output.
+ * @param sha Receives the output digest state over the kept prefix.
+ * @return true if the prefix matches the journal and the key; the file is then cut to it.
+ */
+static bool prepareResume(int out, const JobJournal::Job& job, const SecByteBlock& key,
+                          ContainerHeader& hdr, SHA256& sha) {
+    byte hb[kContainerHeaderBytes];
+    if (::pread(out, hb, sizeof(hb), 0) != static_cast<ssize_t>(sizeof(hb)) || !hdr.parse(hb)) return false;
+    if (hdr.version != kContainerVersion) return false; ///< record offsets of sparse outputs are not fixed
+    if (job.records == 0 || job.records >= UINT32_MAX
+        || job.outputBytes != kContainerHeaderBytes + job.records * containerRecordBytes(hdr.chunkSize))
+        return false;
+    struct stat st;
+    if (::fstat(out, &st) != 0 || static_cast<uint64_t>(st.st_size) < job.outputBytes) return false;
+
+    const size_t recLen = containerRecordBytes(hdr.chunkSize);
+    const uint64_t lastOffset = job.outputBytes - recLen;
+    ScratchBuffer record(recLen), plain(hdr.chunkSize);
+    if (::pread(out, record.data(), recLen, static_cast<off_t>(lastOffset)) != static_cast<ssize_t>(recLen)
+        || record.data()[0] != kRecordData ///< full, non-final data record
+        || !ContainerCodec(key, hdr).open(static_cast<uint32_t>(job.records - 1), record.data(), recLen, plain.data()))
+        return false;
+    if (::ftruncate(out, static_cast<off_t>(job.outputBytes)) != 0) return false; ///< drop the torn tail
+
+    ScratchBuffer buf(kStreamChunkBytes); ///< node-local on pinned batch workers
+    for (uint64_t off = 0; off < job.outputBytes;) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(kStreamChunkBytes, job.outputBytes - off));
+        ssize_t n = ::pread(out, buf.data(), want, static_cast<off_t>(off));
+        if (n <= 0) return false;
+        sha.Update(buf.data(), static_cast<size_t>(n));
+        off += static_cast<uint64_t>(n);
+    }
+    return ::lseek(out, static_cast<off_t>(job.outputBytes), SEEK_SET) >= 0;
+}
+
+
+/**
+ * @brief Encrypts (or continues encrypting) one file, publishing it with an atomic rename.
+ *
+ * @param src Plaintext file.
+ * @param dst Final container path; "<dst>.part" is used while writing.
+ * @param key Master key.
+ * @param chunkSize Container record size for a fresh output.
+ * @param sparse Optional hole / zero-chunk handling for a fresh output (probe is filled in here).
+ * @param journal Optional journal for checkpoints and the final state.
+ * @param rel Journal name of the job.
+ * @param previous Journal state from an earlier run, or nullptr.
+ * @param resumed Set to true if a partial output was continued.
+ * @param encrypted Set to the plaintext bytes encrypted by this call (excludes a resumed prefix).
+ * @return Empty string on success, otherwise the reason.
+ */
+static std::string encryptFile(const std::string& src, const std::string& dst, const SecByteBlock& key,
+                               uint32_t chunkSize, const SparseInput* sparse, JobJournal* journal,
+                               const std::string& rel, const JobJournal::Job* previous, bool& resumed,
+                               uint64_t& encrypted) {
+    resumed = false;
+    encrypted = 0;
+    std::error_code ec;
+    fs::create_directories(fs::path(dst).parent_path(), ec);
+    if (ec) return "cannot create directory: " + ec.message();
+
+    int in = ::open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return "cannot open input";
+    tuneStreamFd(in);
+    struct stat st;
+    if (::fstat(in, &st) != 0) {
+        ::close(in);
+        return "cannot stat input";
+    }
+    JobJournal::Job identity;
+    identity.size = static_cast<uint64_t>(st.st_size);
+    identity.mtimeNs = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    identity.inode = static_cast<uint64_t>(st.st_ino);
+    identity.ctimeNs = int64_t(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+    const uint64_t size = identity.size;
+
+    const std::string tmp = dst + ".part";
+    SHA256 sha;
+    ContainerHeader hdr;
+    int out = -1;
+    uint64_t records = 0, outBytes = 0;
+    if (journal && previous && previous->state == JobJournal::State::InProgress && sameInput(*previous, identity)) {
+        out = ::open(tmp.c_str(), O_RDWR | O_CLOEXEC);
+        if (out >= 0 && prepareResume(out, *previous, key, hdr, sha)
+            && ::lseek(in, static_cast<off_t>(previous->records * hdr.chunkSize), SEEK_SET) >= 0) {
+            resumed = true;
+            records = previous->records;
+            outBytes = previous->outputBytes;
+        } else if (out >= 0) {
+            ::close(out);
+            out = -1;
+            sha.Restart();
+        }
+    }
+    if (!resumed) {
+        if (journal) journal->queued(rel, identity); ///< new identity, forgets stale progress
+        out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (out < 0) {
+            ::close(in);
+            return "cannot create output";
+        }
+    }
+
+    // Every output byte feeds the digest; every kCheckpointBytes the partial
+    // output is synced and only then journaled.
+    ByteWriter writer = [out, &sha, &outBytes](const byte* data, size_t n) {
+        sha.Update(data, n);
+        outBytes += n;
+        return writeAll(out, data, n);
+    };
+    uint64_t sinceCheckpoint = 0;
+    RecordHook hook = [&](size_t recordBytes) {
+        ++records;
+        sinceCheckpoint += recordBytes;
+        if (!journal || sinceCheckpoint < kCheckpointBytes) return;
+        sinceCheckpoint = 0;
+        if (::fdatasync(out) == 0) journal->progress(rel, records, outBytes);
+    };
+
+    SparseInput holes;
+    if (sparse) {
+        holes.holes = fdHoleProbe(in);
+        holes.zeroChunks = sparse->zeroChunks;
+    }
+    std::string error;
+    bool ok;
+    try {
+        ok = resumed ? resumeContainer(fdReader(in), writer, key, hdr, static_cast<uint32_t>(records), error, hook)
+                     : encryptContainer(fdReader(in), writer, key, chunkSize, error, hook, sparse ? &holes : nullptr);
+    } catch (const Exception& e) {
+        ok = false;
+        error = e.what();
+    }
+    ::close(in);
+    if (ok && ::fdatasync(out) != 0) { ///< data must be on disk before the name appears
+        ok = false;
+        error = "sync failed";
+    }
+    if (::close(out) != 0 && ok) {
+        ok = false;
+        error = "close failed";
+    }
+    if (ok && std::rename(tmp.c_str(), dst.c_str()) != 0) {
+        ok = false;
+        error = "rename failed";
+    }
+    if (!ok) {
+        ::unlink(tmp.c_str());
+        if (journal) journal->failed(rel);
+        return error;
+    }
+    encrypted = size - (resumed ? previous->records * hdr.chunkSize : 0);
+    if (journal) {
+        byte digest[SHA256::DIGESTSIZE];
+        sha.Final(digest);
+        journal->done(rel, toHex(digest, sizeof(digest)));
+    }
+    return error;
+}
+
+
+/**
+ * @brief Encrypts one file into a container, publishing it with an atomic rename.
+ *
+ * @param src Plaintext file.
+ * @param dst Final container path; "<dst>.part" is used while writing.
+ * @param key Master key.
+ * @param chunkSize Container record size.
+ * @param sparse Store holes as zero extents.
+ * @param zeroChunks With sparse, also store all-zero chunks as extents.
+ * @return Empty string on success, otherwise the reason.
+ */
+std::string encryptFileToContainer(const std::string& src, const std::string& dst,
+                                   const SecByteBlock& key, uint32_t chunkSize, bool sparse, bool zeroChunks) {
+    SparseInput mode;
+    mode.zeroChunks = zeroChunks;
+    bool resumed;
+    uint64_t encrypted;
+    return encryptFile(src, dst, key, chunkSize, sparse ? &mode : nullptr, nullptr, std::string(), nullptr,
+                       resumed, encrypted);
+}
+
+
+// ---------------- Batch ------------------
+
+/**
+ * @brief Encrypts every matching file under opt.srcRoot into opt.dstRoot.
+ *
+ * @param opt Source / target roots, globs, chunk size.
+ * @param key Master key.
+ * @param stats Live counters (may be polled by other threads).
+ * @param report Optional per-file callback (called from workers).
+ * @param error Receives a description if the source cannot be walked.
+ * @return true if the walk ran; check stats for per-file failures.
+ */
+bool runBatchEncrypt(const BatchOptions& opt, const SecByteBlock& key, BatchStats& stats,
+                     const BatchReport& report, std::string& error) {
+    JobJournal journalStore;
+    JobJournal* journal = nullptr;
+    if (!opt.journalPath.empty()) {
+        std::error_code ec;
+        fs::create_directories(fs::path(opt.journalPath).parent_path(), ec); ///< usually the target root
+        if (!journalStore.open(opt.journalPath, error)) return false;
+        journal = &journalStore;
+    }
+
+    SparseInput sparseMode;
+    sparseMode.zeroChunks = opt.zeroChunks;
+    const SparseInput* sparse = opt.sparse ? &sparseMode : nullptr;
+
+    WorkerPool& pool = WorkerPool::shared();
+    Throttle* throttle = currentThrottle();
+    ConcurrencyLimiter inFlight(pool.size() * kJobsPerWorker);
+
+    std::mutex m;
+    std::condition_variable idle;
+    size_t queued = 0;
+
+    WalkStats walkStats;
+    bool walked = walkTree(opt.srcRoot, opt.walk, [&](const WalkedFile& f) {
+        const std::string dst = opt.dstRoot + "/" + f.path + ".cqac";
+        const bool exists = ::access(dst.c_str(), F_OK) == 0;
+        JobJournal::Job previous;
+        const bool known = journal && !opt.overwrite && journal->lookup(f.path, previous);
+        if (exists && !opt.overwrite) { ///< also covers a crash between rename and the journal's D entry
+            ++stats.filesSkipped;
+            return true;
+        }
+        inFlight.acquire(); ///< back-pressure: the walk waits for the pool
+        {
+            std::lock_guard<std::mutex> lock(m);
+            ++queued;
+        }
+        pool.submit([&, rel = f.path, dst, known, previous] {
+            ThrottleScope scope(throttle);
+            if (throttle) throttle->workers.acquire();
+            bool resumed;
+            uint64_t encrypted;
+            std::string err = encryptFile(opt.srcRoot + "/" + rel, dst, key, opt.chunkSize, sparse, journal, rel,
+                                          known ? &previous : nullptr, resumed, encrypted);
+            if (throttle) throttle->workers.release();
+
+            if (resumed) ++stats.filesResumed;
+            if (err.empty()) {
+                ++stats.filesOk;
+                stats.bytesIn += encrypted; ///< a resumed file only counts what this run sealed
+            } else {
+                ++stats.filesFailed;
+            }
+            if (report) report(rel, err);
+            inFlight.release();
+            std::lock_guard<std::mutex> lock(m);
+            if (--queued == 0) idle.notify_all();
+        });
+        return true;
+    }, walkStats, error);
+
+    std::unique_lock<std::mutex> lock(m);
+    idle.wait(lock, [&] { return queued == 0; });
+    return walked;
+}
@@ -0,0 +1,58 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include "dirwalk.h"  // WalkOptions
+
+#include <atomic>     // live counters
+#include <cstdint>    // byte counts
+#include <functional> // per-file report
+#include <string>     // paths
+
+#include <cryptopp/secblock.h> // SecByteBlock keys
+
+// Batch encryption of a directory tree into containers (.cqac).
+//
+// Files found by the parallel walker (dirwalk.h) are queued on the shared
+// WorkerPool immediately, so encryption starts with the first directory
+// read. At most a few jobs per worker are in flight; the walk pauses when
+// the pool falls behind, so memory stays bounded on huge trees. Each output
+// is written to "<name>.cqac.part" and renamed into place when complete,
+// so the target tree never holds partial containers under their final name.
+//
+// With a journal (journal.h), a restarted run skips files that are done and
+// continues partial outputs from their last checkpoint (every 64 MiB) instead
+// of re-encrypting them, as long as the input's size and mtime are unchanged.
+// Sparse outputs (container version 2) cannot be continued and start over.
+
+struct BatchOptions {
+    std::string srcRoot;                 // tree to encrypt
+    std::string dstRoot;                 // mirrored tree of "<rel>.cqac" files
+    WalkOptions walk;                    // include / exclude globs etc.
+    uint32_t chunkSize = 1u << 20;       // container record size
+    bool overwrite = false;              // replace existing outputs (default: skip them)
+    bool sparse = false;                 // store holes as zero extents (container version 2)
+    bool zeroChunks = false;             // with sparse: also all-zero chunks
+    std::string journalPath;             // job journal; empty = no journal (no resume)
+};
+
+struct BatchStats {
+    std::atomic<uint64_t> filesOk{0};
+    std::atomic<uint64_t> filesFailed{0};
+    std::atomic<uint64_t> filesSkipped{0}; // output already present / journaled as done
+    std::atomic<uint64_t> filesResumed{0}; // continued from a journal checkpoint
+    std::atomic<uint64_t> bytesIn{0};      // plaintext bytes encrypted
+};
+
+// Encrypts one file into a container at `dst` (via "<dst>.part", fdatasync and
+// rename; parent directories are created). Returns "" or the failure reason.
+std::string encryptFileToContainer(const std::string& src, const std::string& dst,
+                                   const CryptoPP::SecByteBlock& key, uint32_t chunkSize,
+                                   bool sparse = false, bool zeroChunks = false);
+
+// Called from worker threads for every finished file; `error` is empty on success.
+using BatchReport = std::function<void(const std::string& relPath, const std::string& error)>;
+
+// Runs the batch under the calling thread's throttle (throttle.h) and blocks
+// until every queued file is done. Must not be called from a pool task.
+// Returns false only if the walk could not start; per-file failures are reported.
+bool runBatchEncrypt(const BatchOptions& opt, const CryptoPP::SecByteBlock& key, BatchStats& stats,
+                     const BatchReport& report, std::string& error);
@@ -0,0 +1,353 @@
+#include "bench.h"
+#include "container.h"   // ContainerCodec (the engine's hot loop)
+#include "ctrcipher.h"   // parallel AES-CTR
+#include "numa.h"        // topology, NodeBuffer
+#include "sealbox.h"     // small-message AEAD
+#include "textcodec.h"   // SIMD hex / base64
+#include "workerpool.h"  // pinned pools
+
+#include <algorithm>           // nth_element (percentiles)
+#include <atomic>              // byte counters
+#include <chrono>              // run time
+#include <condition_variable>  // wait for pinned workers
+#include <cstring>             // memcmp
+#include <functional>          // timed loop bodies
+#include <memory>              // per-measurement pools
+#include <mutex>
+#include <stdexcept>           // codec mismatch
+#include <string>
+
+// Crypto++ includes
+#include <cryptopp/aes.h>     // provider name, reference GCM path
+#include <cryptopp/base64.h>  // reference base64 filters
+#include <cryptopp/filters.h>
+#include <cryptopp/gcm.h>
+#include <cryptopp/hex.h>     // reference hex filters
+#include <cryptopp/modes.h>   // reference CTR pass
+#include <cryptopp/osrng.h>  // random benchmark key
+
+using namespace CryptoPP;
+using Clock = std::chrono::steady_clock;
+
+// ---------------- Helper functions ------------------
+
+/**
+ * @brief Seals records on every worker of `pool` until the deadline.
+ *
+ * Tasks are submitted one per worker (not via parallelFor, whose calling
+ * thread would join in unpinned) and each allocates its buffers on
+ * `bufferNode` before starting the clock.
+ *
+ * @return Aggregate throughput in MB/s.
+ */
+static double sealOnPool(WorkerPool& pool, const ContainerCodec& codec, int bufferNode,
+                         double seconds, size_t chunkBytes) {
+    std::atomic<uint64_t> bytes{0};
+    std::mutex m;
+    std::condition_variable cv;
+    unsigned ready = 0, done = 0;
+    bool go = false;
+    const unsigned n = pool.size();
+
+    Clock::time_point start;
+    for (unsigned w = 0; w < n; ++w) {
+        pool.submit([&] {
+            NodeBuffer plain(chunkBytes, bufferNode);
+            NodeBuffer record(containerRecordBytes(chunkBytes), bufferNode);
+            {
+                std::unique_lock<std::mutex> lock(m);
+                ++ready;
+                cv.notify_all();
+                cv.wait(lock, [&] { return go; }); ///< start together, after all allocations
+            }
+            const Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(
+                                                      std::chrono::duration<double>(seconds));
+            uint64_t mine = 0;
+            for (uint32_t i = 0; Clock::now() < end; ++i) {
+                codec.seal(i, kRecordData, plain.data(), chunkBytes, record.data());
+                mine += chunkBytes;
+            }
+            bytes += mine;
+            std::lock_guard<std::mutex> lock(m);
+            ++done;
+            cv.notify_all();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(m);
+    cv.wait(lock, [&] { return ready == n; });
+    start = Clock::now();
+    go = true;
+    cv.notify_all();
+    cv.wait(lock, [&] { return done == n; });
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    return elapsed > 0 ? double(bytes.load()) / elapsed / 1e6 : 0;
+}
+
+
+/**
+ * @brief Runs `body` repeatedly until `seconds` have passed.
+ *
+ * @param bytes Binary bytes processed per call.
+ * @return Throughput in MB/s.
+ */
+static double timedLoop(double seconds, size_t bytes, const std::function<void()>& body) {
+    uint64_t total = 0;
+    const Clock::time_point start = Clock::now();
+    double elapsed = 0;
+    do {
+        body();
+        total += bytes;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < seconds);
+    return double(total) / elapsed / 1e6;
+}
+
+
+/**
+ * @brief Times single calls of `body` for up to `seconds`, in nanoseconds each.
+ *
+ * The cost of reading the clock (median of empty intervals) is subtracted,
+ * so sub-microsecond operations are not dominated by it.
+ *
+ * @param maxSamples Stops earlier once this many calls were timed.
+ */
+static std::vector<double> latencySamples(double seconds, size_t maxSamples, const std::function<void()>& body) {
+    std::vector<double> clockCost(1001);
+    for (double& c : clockCost) {
+        const Clock::time_point a = Clock::now();
+        c = std::chrono::duration<double, std::nano>(Clock::now() - a).count();
+    }
+    std::nth_element(clockCost.begin(), clockCost.begin() + 500, clockCost.end());
+    const double overhead = clockCost[500];
+
+    for (int i = 0; i < 1000; ++i) body(); ///< warm caches and branch predictors
+    std::vector<double> samples;
+    samples.reserve(maxSamples);
+    const Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                                     std::chrono::duration<double>(seconds));
+    while (samples.size() < maxSamples) {
+        const Clock::time_point a = Clock::now();
+        body();
+        const Clock::time_point b = Clock::now();
+        samples.push_back(std::max(0.0, std::chrono::duration<double, std::nano>(b - a).count() - overhead));
+        if ((samples.size() & 255) == 0 && b >= end) break;
+    }
+    return samples;
+}
+
+
+static double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) return 0;
+    const size_t k = static_cast<size_t>(p * double(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(k), samples.end());
+    return samples[k];
+}
+
+
+// ---------------- Benchmarks ------------------
+
+/**
+ * @brief Measures per-node sealing throughput with local and remote buffers.
+ *
+ * @param seconds Run time of each measurement.
+ * @param chunkBytes Record payload size.
+ */
+std::vector<NodeThroughput> benchNodeThroughput(double seconds, size_t chunkBytes) {
+    const CpuTopology& topo = CpuTopology::system();
+    SecByteBlock key(32);
+    AutoSeededRandomPool rng;
+    rng.GenerateBlock(key, key.size());
+    ContainerHeader hdr;
+    hdr.chunkSize = static_cast<uint32_t>(chunkBytes);
+    ContainerCodec codec(key, hdr);
+
+    std::vector<NodeThroughput> results;
+    for (unsigned node = 0; node < topo.nodes; ++node) {
+        std::vector<unsigned> cpus = topo.cpusOfNode(node);
+        if (cpus.empty()) continue;
+        WorkerPool pool(static_cast<unsigned>(cpus.size()), cpus);
+
+        NodeThroughput r;
+        r.node = node;
+        r.threads = pool.size();
+        r.localMBps = sealOnPool(pool, codec, static_cast<int>(node), seconds, chunkBytes);
+        if (topo.nodes > 1)
+            r.remoteMBps = sealOnPool(pool, codec, static_cast<int>((node + 1) % topo.nodes), seconds, chunkBytes);
+        results.push_back(r);
+    }
+    return results;
+}
+
+/**
+ * @brief Compares the textcodec.h hex and base64 paths with the Crypto++ filters.
+ *
+ * Each direction is checked against the other implementation once before
+ * timing, so a broken fast path shows up as an error rather than a number.
+ *
+ * @param seconds Run time of each measurement.
+ * @param bufferBytes Size of the binary buffer encoded per iteration.
+ */
+std::vector<CodecThroughput> benchTextCodecs(double seconds, size_t bufferBytes) {
+    std::string raw(bufferBytes, '\0');
+    AutoSeededRandomPool rng;
+    rng.GenerateBlock(reinterpret_cast<byte*>(&raw[0]), raw.size());
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(raw.data());
+
+    std::string hex(2 * raw.size(), '\0'), b64(base64EncodedSize(raw.size()), '\0');
+    std::string back(raw.size(), '\0'), ref;
+    hexEncode(in, raw.size(), &hex[0]);
+    base64Encode(in, raw.size(), &b64[0]);
+    StringSource(raw, true, new HexEncoder(new StringSink(ref), false));
+    if (ref != hex) throw std::runtime_error("hex encoder mismatch");
+    ref.clear();
+    StringSource(raw, true, new Base64Encoder(new StringSink(ref), false));
+    if (ref != b64) throw std::runtime_error("base64 encoder mismatch");
+
+    std::vector<CodecThroughput> results(4);
+    results[0].name = "hex encode";
+    results[0].fastMBps = timedLoop(seconds, raw.size(), [&] { hexEncode(in, raw.size(), &hex[0]); });
+    results[0].cryptoppMBps = timedLoop(seconds, raw.size(), [&] {
+        ref.clear();
+        StringSource(raw, true, new HexEncoder(new StringSink(ref), false));
+    });
+
+    results[1].name = "hex decode";
+    results[1].fastMBps = timedLoop(seconds, raw.size(), [&] {
+        hexDecode(hex.data(), hex.size(), reinterpret_cast<unsigned char*>(&back[0]));
+    });
+    results[1].cryptoppMBps = timedLoop(seconds, raw.size(), [&] {
+        ref.clear();
+        StringSource(hex, true, new HexDecoder(new StringSink(ref)));
+    });
+
+    results[2].name = "base64 encode";
+    results[2].fastMBps = timedLoop(seconds, raw.size(), [&] { base64Encode(in, raw.size(), &b64[0]); });
+    results[2].cryptoppMBps = timedLoop(seconds, raw.size(), [&] {
+        ref.clear();
+        StringSource(raw, true, new Base64Encoder(new StringSink(ref), false));
+    });
+
+    results[3].name = "base64 decode";
+    results[3].fastMBps = timedLoop(seconds, raw.size(), [&] {
+        Base64StreamDecoder dec;
+        back.clear();
+        dec.update(b64.data(), b64.size(), back);
+        dec.final(back);
+    });
+    if (back != raw) throw std::runtime_error("base64 decoder mismatch");
+    results[3].cryptoppMBps = timedLoop(seconds, raw.size(), [&] {
+        ref.clear();
+        StringSource(b64, true, new Base64Decoder(new StringSink(ref)));
+    });
+    return results;
+}
+
+
+std::string aesProvider() {
+    return AES::Encryption().AlgorithmProvider();
+}
+
+
+/**
+ * @brief Measures seal / open latency of SealBox for token-sized messages.
+ *
+ * Each size is first checked against a plain Crypto++ GCM filter run with
+ * the same nonce, then timed call by call. The filter path, with a fresh
+ * GCM object, key setup and strings per message, is timed as well for
+ * comparison.
+ *
+ * @param seconds Run time of each measurement.
+ */
+std::vector<SealLatency> benchSealLatency(double seconds) {
+    static const size_t kSizes[] = { 16, 64, 256, 512 };
+    static const size_t kMaxSamples = 2000000;
+    byte key[32];
+    AutoSeededRandomPool rng;
+    rng.GenerateBlock(key, sizeof(key));
+    SealBox box;
+    box.setKey(key, sizeof(key));
+
+    std::vector<SealLatency> results;
+    for (size_t n : kSizes) {
+        byte plain[512], sealed[512 + kSealOverheadBytes], back[512]; ///< stack only, like a caller would
+        rng.GenerateBlock(plain, n);
+        box.seal(nullptr, 0, plain, n, sealed);
+
+        std::string reference;
+        GCM<AES>::Encryption ref;
+        ref.SetKeyWithIV(key, sizeof(key), sealed, kSealNonceBytes);
+        StringSource(plain, n, true, new AuthenticatedEncryptionFilter(ref, new StringSink(reference), false,
+                                                                       static_cast<int>(kSealTagBytes)));
+        if (reference.size() != n + kSealTagBytes
+            || std::memcmp(reference.data(), sealed + kSealNonceBytes, reference.size()) != 0
+            || !box.open(nullptr, 0, sealed, n + kSealOverheadBytes, back) || std::memcmp(back, plain, n) != 0)
+            throw std::runtime_error("seal box mismatch");
+
+        SealLatency r;
+        r.bytes = n;
+        std::vector<double> t = latencySamples(seconds, kMaxSamples, [&] { box.seal(nullptr, 0, plain, n, sealed); });
+        r.sealP50Ns = percentile(t, 0.50);
+        r.sealP99Ns = percentile(t, 0.99);
+        t = latencySamples(seconds, kMaxSamples, [&] { box.open(nullptr, 0, sealed, n + kSealOverheadBytes, back); });
+        r.openP50Ns = percentile(t, 0.50);
+        r.openP99Ns = percentile(t, 0.99);
+        const std::string message(reinterpret_cast<const char*>(plain), n);
+        t = latencySamples(seconds, kMaxSamples, [&] {
+            std::string out;
+            GCM<AES>::Encryption e;
+            e.SetKeyWithIV(key, sizeof(key), sealed, kSealNonceBytes);
+            StringSource(message, true, new AuthenticatedEncryptionFilter(e, new StringSink(out), false,
+                                                                          static_cast<int>(kSealTagBytes)));
+        });
+        r.filterP50Ns = percentile(t, 0.50);
+        results.push_back(r);
+    }
+    return results;
+}
+
+
+/**
+ * @brief Measures CtrCipher throughput from one thread up to every usable CPU.
+ *
+ * The parallel result is first compared with a single CTR_Mode pass over
+ * the same buffer. Each thread count gets its own unpinned pool of
+ * threads - 1 workers, since parallelFor's calling thread works as well.
+ *
+ * @param seconds Run time of each measurement.
+ * @param bufferBytes Size of the buffer encrypted per iteration.
+ */
+std::vector<CtrScaling> benchCtrScaling(double seconds, size_t bufferBytes) {
+    byte key[32], iv[16];
+    AutoSeededRandomPool rng;
+    rng.GenerateBlock(key, sizeof(key));
+    rng.GenerateBlock(iv, sizeof(iv));
+    CtrCipher cipher;
+    cipher.setKey(key, sizeof(key), iv);
+
+    const unsigned maxThreads = CpuTopology::system().usableThreads();
+    SecByteBlock buf(bufferBytes), reference(bufferBytes);
+    rng.GenerateBlock(buf, buf.size());
+    CTR_Mode<AES>::Encryption ref;
+    ref.SetKeyWithIV(key, sizeof(key), iv, sizeof(iv));
+    ref.ProcessData(reference, buf, buf.size());
+    {
+        WorkerPool pool(std::max(1u, maxThreads - 1));
+        cipher.process(0, buf, buf, buf.size(), &pool);
+    }
+    if (std::memcmp(buf, reference, buf.size()) != 0) throw std::runtime_error("parallel CTR mismatch");
+
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads);
+
+    std::vector<CtrScaling> results;
+    for (unsigned t : counts) {
+        std::unique_ptr<WorkerPool> pool(t > 1 ? new WorkerPool(t - 1) : nullptr);
+        CtrScaling r;
+        r.threads = t;
+        r.totalMBps = timedLoop(seconds, buf.size(), [&] { cipher.process(0, buf, buf, buf.size(), pool.get()); });
+        results.push_back(r);
+    }
+    return results;
+}
@@ -0,0 +1,60 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <cstddef>  // size_t
+#include <string>   // provider name
+#include <vector>   // per-node results
+
+// Built-in throughput benchmarks (`CryptoQtApp bench <suite>`), so placement
+// and engine changes can be measured on the target hosts themselves.
+
+// AES-GCM container sealing throughput of one NUMA node's CPUs.
+struct NodeThroughput {
+    unsigned node = 0;
+    unsigned threads = 0;      // pinned workers (one per CPU of the node)
+    double localMBps = 0;      // buffers on the workers' own node
+    double remoteMBps = -1;    // buffers on the next node (-1 on single-node hosts)
+};
+
+// Runs, for every node, a pool pinned to that node's CPUs that seals
+// `chunkBytes` records for `seconds` from node-local buffers and then from
+// buffers on another node. Nodes are measured one after another.
+std::vector<NodeThroughput> benchNodeThroughput(double seconds, size_t chunkBytes);
+
+// Hex / base64 throughput of textcodec.h next to the Crypto++ filters it
+// replaced, in MB of binary data per second.
+struct CodecThroughput {
+    const char* name = "";     // "hex encode", "hex decode", "base64 encode", "base64 decode"
+    double fastMBps = 0;       // textcodec.h
+    double cryptoppMBps = 0;   // HexEncoder / HexDecoder / Base64Encoder / Base64Decoder
+};
+
+// Encodes and decodes a random `bufferBytes` buffer repeatedly for
+// `seconds` per measurement, single-threaded.
+std::vector<CodecThroughput> benchTextCodecs(double seconds, size_t bufferBytes);
+
+// Latency of the small-message AEAD (sealbox.h), single-threaded.
+struct SealLatency {
+    size_t bytes = 0;          // message size
+    double sealP50Ns = 0;
+    double sealP99Ns = 0;
+    double openP50Ns = 0;
+    double openP99Ns = 0;
+    double filterP50Ns = 0;    // the same seal through per-call GCM setup and Crypto++ filters
+};
+
+// Times seal and open call by call for 16, 64, 256 and 512-byte messages,
+// `seconds` per measurement.
+std::vector<SealLatency> benchSealLatency(double seconds);
+
+// Bulk AES-CTR (ctrcipher.h) throughput with a growing number of threads.
+struct CtrScaling {
+    unsigned threads = 0;      // calling thread + pool workers
+    double totalMBps = 0;
+};
+
+// Encrypts a `bufferBytes` buffer in place repeatedly for `seconds` per
+// thread count: 1, 2, 4, ... and finally every usable CPU.
+std::vector<CtrScaling> benchCtrScaling(double seconds, size_t bufferBytes);
+
+// Crypto++'s AES implementation on this CPU ("AESNI", "ARMv8", "C++", ...).
+std::string aesProvider();
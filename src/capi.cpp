@@ -0,0 +1,483 @@
+#include "cryptoqtapp.h"
+
+#include "batch.h"        // encryptFileToContainer
+#include "container.h"    // ContainerSealer / ContainerOpener
+#include "ctrcipher.h"    // parallel AES-CTR
+#include "restore.h"      // restoreFile
+#include "sealbox.h"      // small-message AEAD
+#include "streamcipher.h" // AES-CBC streams
+#include "workerpool.h"   // parallel file API
+
+#include <algorithm> // min
+#include <memory>    // unique_ptr
+#include <new>       // bad_alloc, nothrow
+#include <string>    // output buffers
+#include <vector>    // results
+
+// Crypto++ includes
+#include <cryptopp/cryptlib.h> // CryptoPP::Exception
+#include <cryptopp/hmac.h>
+#include <cryptopp/osrng.h>    // AES-CBC IVs
+#include <cryptopp/sha.h>
+
+using namespace CryptoPP;
+
+// Every entry point catches everything: no C++ exception may cross the C ABI.
+
+namespace {
+
+bool validAesKey(const uint8_t* key, size_t len) {
+    return key && (len == 16 || len == 24 || len == 32);
+}
+
+int fromContainerStatus(ContainerReport::Status status) {
+    switch (status) {
+    case ContainerReport::Status::Ok: return CQA_OK;
+    case ContainerReport::Status::IoError: return CQA_E_IO;
+    case ContainerReport::Status::BadHeader: return CQA_E_FORMAT;
+    case ContainerReport::Status::Corrupt: return CQA_E_AUTH;
+    case ContainerReport::Status::Truncated: return CQA_E_TRUNCATED;
+    case ContainerReport::Status::TrailingData: return CQA_E_FORMAT;
+    }
+    return CQA_E_INTERNAL;
+}
+
+} // namespace
+
+struct cqa_cipher {
+    int format = 0;
+    int direction = 0;
+    cqa_write_fn write = nullptr;
+    void* user = nullptr;
+    SecByteBlock key;
+    size_t ivLen = 16;
+    int failed = CQA_OK;    ///< sticky status after an error
+    bool finished = false;
+
+    std::unique_ptr<ContainerSealer> sealer;
+    std::unique_ptr<ContainerOpener> opener;
+    std::unique_ptr<StreamCipher> cbc; ///< created once the IV is known
+    std::string ivBuf;                 ///< decrypt: IV bytes received so far
+    std::string out;                   ///< AES-CBC output of one call
+
+    ByteWriter writer() {
+        return [this](const unsigned char* data, size_t n) { return n == 0 || write(user, data, n) == 0; };
+    }
+
+    int flush() {
+        const bool ok = out.empty() || write(user, reinterpret_cast<const uint8_t*>(out.data()), out.size()) == 0;
+        out.clear();
+        return ok ? CQA_OK : CQA_E_IO;
+    }
+};
+
+struct cqa_hash {
+    int algo = 0;
+    SHA256 sha256;
+    SHA512 sha512;
+    HashTransformation& hash() { return algo == CQA_SHA512 ? static_cast<HashTransformation&>(sha512) : sha256; }
+};
+
+struct cqa_mac {
+    HMAC<SHA256> hmac;
+};
+
+struct cqa_sealer {
+    SealBox box;
+};
+static_assert(CQA_SEAL_OVERHEAD == kSealOverheadBytes, "C and C++ seal layouts differ");
+
+
+uint32_t cqa_abi_version(void) {
+    return CQA_ABI_VERSION;
+}
+
+
+const char* cqa_strerror(int status) {
+    switch (status) {
+    case CQA_OK: return "ok";
+    case CQA_E_ARGUMENT: return "invalid argument";
+    case CQA_E_STATE: return "invalid call for the context state";
+    case CQA_E_IO: return "write or file operation failed";
+    case CQA_E_AUTH: return "authentication failed (corrupt data or wrong key)";
+    case CQA_E_FORMAT: return "unsupported or malformed format";
+    case CQA_E_TRUNCATED: return "input truncated";
+    case CQA_E_NOMEM: return "out of memory";
+    case CQA_E_INTERNAL: return "internal error";
+    case CQA_E_FILE: return "one or more files failed";
+    }
+    return "unknown status";
+}
+
+// ---------------- Cipher streams ------------------
+
+/**
+ * @brief Creates a cipher stream context.
+ *
+ * @param ctx Receives the new context (null on failure).
+ * @param format CQA_FORMAT_CONTAINER or CQA_FORMAT_AESCBC.
+ * @param direction CQA_ENCRYPT or CQA_DECRYPT.
+ * @param key AES key (16, 24 or 32 bytes).
+ * @param chunk_size Container record size (0 = 1 MiB); ignored for AES-CBC.
+ * @param iv_len AES-CBC IV size (0 = 16); ignored for containers.
+ * @param write Output callback.
+ * @param user Passed to write.
+ * @return CQA_OK or an error status.
+ */
+int cqa_cipher_init(cqa_cipher** ctx, int format, int direction, const uint8_t* key, size_t key_len,
+                    uint32_t chunk_size, size_t iv_len, cqa_write_fn write, void* user) {
+    if (!ctx) return CQA_E_ARGUMENT;
+    *ctx = nullptr;
+    if ((format != CQA_FORMAT_CONTAINER && format != CQA_FORMAT_AESCBC) ||
+        (direction != CQA_ENCRYPT && direction != CQA_DECRYPT) || !validAesKey(key, key_len) || !write)
+        return CQA_E_ARGUMENT;
+    if (chunk_size == 0) chunk_size = 1u << 20;
+    if (iv_len == 0) iv_len = 16;
+    if (chunk_size > kMaxChunkBytes || iv_len < 16) return CQA_E_ARGUMENT; ///< CBC uses the first 16 IV bytes
+
+    try {
+        std::unique_ptr<cqa_cipher> c(new cqa_cipher);
+        c->format = format;
+        c->direction = direction;
+        c->write = write;
+        c->user = user;
+        c->key = SecByteBlock(key, key_len);
+        c->ivLen = iv_len;
+        if (format == CQA_FORMAT_CONTAINER) {
+            if (direction == CQA_ENCRYPT) c->sealer.reset(new ContainerSealer(c->key, chunk_size));
+            else c->opener.reset(new ContainerOpener(c->key));
+        }
+        *ctx = c.release();
+        return CQA_OK;
+    } catch (const std::bad_alloc&) {
+        return CQA_E_NOMEM;
+    } catch (...) {
+        return CQA_E_INTERNAL;
+    }
+}
+
+
+/**
+ * @brief Feeds input; output goes to the context's write callback as it becomes available.
+ */
+int cqa_cipher_update(cqa_cipher* ctx, const uint8_t* data, size_t len) {
+    if (!ctx || (!data && len > 0)) return CQA_E_ARGUMENT;
+    if (ctx->failed != CQA_OK || ctx->finished) return CQA_E_STATE;
+
+    int status = CQA_OK;
+    try {
+        if (ctx->sealer) {
+            std::string error;
+            if (!ctx->sealer->update(data, len, ctx->writer(), error)) status = CQA_E_IO;
+        } else if (ctx->opener) {
+            status = fromContainerStatus(ctx->opener->update(data, len, ctx->writer()));
+        } else {
+            if (!ctx->cbc) {
+                if (ctx->direction == CQA_ENCRYPT) {
+                    ctx->ivBuf.resize(ctx->ivLen);
+                    AutoSeededRandomPool rng;
+                    rng.GenerateBlock(reinterpret_cast<byte*>(&ctx->ivBuf[0]), ctx->ivLen);
+                    ctx->out = ctx->ivBuf; ///< the file format starts with the IV
+                } else {
+                    const size_t take = std::min(len, ctx->ivLen - ctx->ivBuf.size());
+                    ctx->ivBuf.append(reinterpret_cast<const char*>(data), take);
+                    data += take;
+                    len -= take;
+                }
+                if (ctx->ivBuf.size() == ctx->ivLen) {
+                    ctx->cbc.reset(new StreamCipher(ctx->direction == CQA_ENCRYPT ? StreamCipher::Direction::Encrypt
+                                                                                  : StreamCipher::Direction::Decrypt,
+                                                    ctx->key, reinterpret_cast<const byte*>(ctx->ivBuf.data()),
+                                                    ctx->ivLen));
+                }
+            }
+            if (ctx->cbc && len > 0) ctx->cbc->update(data, len, ctx->out);
+            status = ctx->flush();
+        }
+    } catch (const std::bad_alloc&) {
+        status = CQA_E_NOMEM;
+    } catch (...) {
+        status = CQA_E_INTERNAL;
+    }
+    ctx->failed = status;
+    return status;
+}
+
+
+/**
+ * @brief Ends the stream: writes the last record / padded block, or verifies that the input was complete.
+ *
+ * For decryption, CQA_OK means every byte passed to the callback is authentic
+ * (containers) or correctly padded (AES-CBC).
+ */
+int cqa_cipher_final(cqa_cipher* ctx) {
+    if (!ctx) return CQA_E_ARGUMENT;
+    if (ctx->failed != CQA_OK || ctx->finished) return CQA_E_STATE;
+    ctx->finished = true;
+
+    int status = CQA_OK;
+    try {
+        if (ctx->sealer) {
+            std::string error;
+            if (!ctx->sealer->final(ctx->writer(), error)) status = CQA_E_IO;
+        } else if (ctx->opener) {
+            status = fromContainerStatus(ctx->opener->final());
+        } else {
+            if (!ctx->cbc && ctx->direction == CQA_ENCRYPT) {
+                ctx->finished = false;
+                status = cqa_cipher_update(ctx, nullptr, 0); ///< empty input still gets an IV and a padding block
+                ctx->finished = true;
+            }
+            if (status == CQA_OK) {
+                if (!ctx->cbc) {
+                    status = CQA_E_TRUNCATED;
+                } else {
+                    try {
+                        ctx->cbc->final(ctx->out);
+                        status = ctx->flush();
+                    } catch (const Exception&) {
+                        status = ctx->direction == CQA_DECRYPT ? CQA_E_AUTH : CQA_E_INTERNAL;
+                    }
+                }
+            }
+        }
+    } catch (const std::bad_alloc&) {
+        status = CQA_E_NOMEM;
+    } catch (...) {
+        status = CQA_E_INTERNAL;
+    }
+    ctx->failed = status;
+    return status;
+}
+
+
+void cqa_cipher_free(cqa_cipher* ctx) {
+    delete ctx;
+}
+
+// ---------------- Hashes ------------------
+
+int cqa_hash_init(cqa_hash** ctx, int algo) {
+    if (!ctx) return CQA_E_ARGUMENT;
+    *ctx = nullptr;
+    if (algo != CQA_SHA256 && algo != CQA_SHA512) return CQA_E_ARGUMENT;
+    cqa_hash* h = new (std::nothrow) cqa_hash;
+    if (!h) return CQA_E_NOMEM;
+    h->algo = algo;
+    *ctx = h;
+    return CQA_OK;
+}
+
+
+int cqa_hash_update(cqa_hash* ctx, const uint8_t* data, size_t len) {
+    if (!ctx || (!data && len > 0)) return CQA_E_ARGUMENT;
+    if (len > 0) ctx->hash().Update(data, len);
+    return CQA_OK;
+}
+
+
+/**
+ * @brief Writes the digest and resets the context for a new message.
+ */
+int cqa_hash_final(cqa_hash* ctx, uint8_t* digest, size_t* digest_len) {
+    if (!ctx || !digest || !digest_len) return CQA_E_ARGUMENT;
+    HashTransformation& hash = ctx->hash();
+    if (*digest_len < hash.DigestSize()) return CQA_E_ARGUMENT;
+    hash.Final(digest);
+    *digest_len = hash.DigestSize();
+    return CQA_OK;
+}
+
+
+void cqa_hash_free(cqa_hash* ctx) {
+    delete ctx;
+}
+
+// ---------------- MAC ------------------
+
+int cqa_mac_init(cqa_mac** ctx, const uint8_t* key, size_t key_len) {
+    if (!ctx) return CQA_E_ARGUMENT;
+    *ctx = nullptr;
+    if (!key && key_len > 0) return CQA_E_ARGUMENT;
+    try {
+        std::unique_ptr<cqa_mac> m(new cqa_mac);
+        m->hmac.SetKey(key, key_len);
+        *ctx = m.release();
+        return CQA_OK;
+    } catch (const std::bad_alloc&) {
+        return CQA_E_NOMEM;
+    } catch (...) {
+        return CQA_E_INTERNAL;
+    }
+}
+
+
+int cqa_mac_update(cqa_mac* ctx, const uint8_t* data, size_t len) {
+    if (!ctx || (!data && len > 0)) return CQA_E_ARGUMENT;
+    if (len > 0) ctx->hmac.Update(data, len);
+    return CQA_OK;
+}
+
+
+/**
+ * @brief Writes the MAC and resets the context (same key) for a new message.
+ */
+int cqa_mac_final(cqa_mac* ctx, uint8_t* mac, size_t* mac_len) {
+    if (!ctx || !mac || !mac_len) return CQA_E_ARGUMENT;
+    if (*mac_len < ctx->hmac.DigestSize()) return CQA_E_ARGUMENT;
+    ctx->hmac.Final(mac);
+    *mac_len = ctx->hmac.DigestSize();
+    return CQA_OK;
+}
+
+
+void cqa_mac_free(cqa_mac* ctx) {
+    delete ctx;
+}
+
+// ---------------- Small messages ------------------
+
+int cqa_sealer_init(cqa_sealer** ctx, const uint8_t* key, size_t key_len) {
+    if (!ctx) return CQA_E_ARGUMENT;
+    *ctx = nullptr;
+    if (!validAesKey(key, key_len)) return CQA_E_ARGUMENT;
+    try {
+        std::unique_ptr<cqa_sealer> s(new cqa_sealer);
+        s->box.setKey(key, key_len);
+        *ctx = s.release();
+        return CQA_OK;
+    } catch (const std::bad_alloc&) {
+        return CQA_E_NOMEM;
+    } catch (...) {
+        return CQA_E_INTERNAL;
+    }
+}
+
+
+/**
+ * @brief Seals one message into `out` (nonce || ciphertext || tag).
+ */
+int cqa_seal(cqa_sealer* ctx, const uint8_t* aad, size_t aad_len, const uint8_t* in, size_t len,
+             uint8_t* out, size_t* out_len) {
+    if (!ctx || (!aad && aad_len > 0) || (!in && len > 0) || !out || !out_len) return CQA_E_ARGUMENT;
+    if (*out_len < len + CQA_SEAL_OVERHEAD) return CQA_E_ARGUMENT;
+    try {
+        ctx->box.seal(aad, aad_len, in, len, out);
+    } catch (...) {
+        return CQA_E_INTERNAL;
+    }
+    *out_len = len + CQA_SEAL_OVERHEAD;
+    return CQA_OK;
+}
+
+
+/**
+ * @brief Verifies and decrypts one sealed message; `out` is zeroed on CQA_E_AUTH.
+ */
+int cqa_open(cqa_sealer* ctx, const uint8_t* aad, size_t aad_len, const uint8_t* in, size_t len,
+             uint8_t* out, size_t* out_len) {
+    if (!ctx || (!aad && aad_len > 0) || !in || !out_len) return CQA_E_ARGUMENT;
+    if (len < CQA_SEAL_OVERHEAD) return CQA_E_FORMAT;
+    if (*out_len < len - CQA_SEAL_OVERHEAD || (!out && len > CQA_SEAL_OVERHEAD)) return CQA_E_ARGUMENT;
+    try {
+        if (!ctx->box.open(aad, aad_len, in, len, out)) return CQA_E_AUTH;
+    } catch (...) {
+        return CQA_E_INTERNAL;
+    }
+    *out_len = len - CQA_SEAL_OVERHEAD;
+    return CQA_OK;
+}
+
+
+void cqa_sealer_free(cqa_sealer* ctx) {
+    delete ctx;
+}
+
+// ---------------- Bulk AES-CTR ------------------
+
+/**
+ * @brief XORs AES-CTR keystream at stream position `offset` into `out`.
+ */
+int cqa_ctr_xor(const uint8_t* key, size_t key_len, const uint8_t iv[16], uint64_t offset,
+                const uint8_t* in, uint8_t* out, size_t len) {
+    if (!validAesKey(key, key_len) || !iv || (len > 0 && (!in || !out))) return CQA_E_ARGUMENT;
+    try {
+        CtrCipher cipher;
+        cipher.setKey(key, key_len, iv);
+        cipher.process(offset, in, out, len);
+        return CQA_OK;
+    } catch (const std::bad_alloc&) {
+        return CQA_E_NOMEM;
+    } catch (...) {
+        return CQA_E_INTERNAL;
+    }
+}
+
+// ---------------- Files ------------------
+
+namespace {
+
+// Runs fn(i) for every file on the shared pool; per-file statuses go to results.
+template<class Fn>
+int forEachFile(const char* const* src, const char* const* dst, size_t count, int* results, Fn fn) {
+    if ((!src || !dst) && count > 0) return CQA_E_ARGUMENT;
+    for (size_t i = 0; i < count; ++i)
+        if (!src[i] || !dst[i]) return CQA_E_ARGUMENT;
+    try {
+        std::vector<int> status(count, CQA_OK);
+        WorkerPool::shared().parallelFor(count, [&](size_t i) {
+            try {
+                status[i] = fn(i).empty() ? CQA_OK : CQA_E_FILE;
+            } catch (const std::bad_alloc&) {
+                status[i] = CQA_E_NOMEM;
+            } catch (...) {
+                status[i] = CQA_E_INTERNAL;
+            }
+        });
+        int overall = CQA_OK;
+        for (size_t i = 0; i < count; ++i) {
+            if (results) results[i] = status[i];
+            if (status[i] != CQA_OK) overall = CQA_E_FILE;
+        }
+        return overall;
+    } catch (const std::bad_alloc&) {
+        return CQA_E_NOMEM;
+    } catch (...) {
+        return CQA_E_INTERNAL;
+    }
+}
+
+} // namespace
+
+
+/**
+ * @brief Encrypts files into containers in parallel (same output as `CryptoQtApp encrypt`).
+ */
+int cqa_encrypt_files(const char* const* src, const char* const* dst, size_t count,
+                      const uint8_t* key, size_t key_len, uint32_t chunk_size, int* results) {
+    if (!validAesKey(key, key_len) || chunk_size > kMaxChunkBytes) return CQA_E_ARGUMENT;
+    if (chunk_size == 0) chunk_size = 1u << 20;
+    const SecByteBlock k(key, key_len);
+    return forEachFile(src, dst, count, results, [&](size_t i) {
+        return encryptFileToContainer(src[i], dst[i], k, chunk_size);
+    });
+}
+
+
+/**
+ * @brief Decrypts .cqac / .aescbc files in parallel (same rules as `CryptoQtApp restore`).
+ */
+int cqa_decrypt_files(const char* const* src, const char* const* dst, size_t count,
+                      const uint8_t* key, size_t key_len, size_t iv_len, int* results) {
+    if (!validAesKey(key, key_len)) return CQA_E_ARGUMENT;
+    if (iv_len == 0) iv_len = 16;
+    if (iv_len < 16) return CQA_E_ARGUMENT;
+    const SecByteBlock k(key, key_len);
+    return forEachFile(src, dst, count, results, [&](size_t i) {
+        RestoreItem item;
+        item.src = src[i];
+        item.dst = dst[i];
+        uint64_t plainBytes = 0;
+        return restoreFile(item, k, iv_len, plainBytes);
+    });
+}
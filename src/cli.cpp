@@ -0,0 +1,1192 @@
+#include "cli.h"
+#include "appconfig.h"    // config.json (key / IV sizes)
+#include "armor.h"        // ASCII-armored ciphertext
+#include "batch.h"        // directory tree encryption
+#include "bench.h"        // built-in benchmarks
+#include "consumer.h"     // decrypt into a command, fifo or socket
+#include "container.h"    // chunked authenticated container format
+#include "ctrcipher.h"    // counter range size (bench ctr)
+#include "fdio.h"         // writeAll, tuneStreamFd
+#include "history.h"      // operation history store
+#include "numa.h"         // CPU topology (bench output)
+#include "restore.h"      // parallel multi-file decrypt
+#include "sealbox.h"      // seal overhead (bench seal)
+#include "scrubber.h"     // background integrity scrub
+#include "sealedlog.h"    // encrypted append-only logs
+#include "streamcipher.h" // encryptStream / decryptStream
+#include "streamhash.h"   // hashFd, fused digests, sidecars
+#include "textcodec.h"    // hex keys and digests
+#include "throttle.h"     // background job rate / concurrency limits
+#include "volumes.h"      // multi-part volume sets
+#include "watchfolder.h"  // spool directory ingest
+#include "workerpool.h"   // shared pool pinning
+
+#include <QFile>          // key file reading
+#include <QString>
+
+#include <fcntl.h>        // open
+#include <sys/stat.h>     // history record sizes
+#include <csignal>        // SIGINT / SIGTERM stop the watcher
+#include <unistd.h>       // close, STDIN_FILENO, usleep
+#include <atomic>         // watch stop flag
+#include <cerrno>         // EINTR
+#include <chrono>         // restore wall time
+#include <cstdio>         // fprintf
+#include <cstdlib>        // getenv
+#include <cstring>        // strcmp
+#include <functional>     // recorded commands
+#include <memory>
+#include <mutex>          // serialized per-file output
+#include <string>
+#include <vector>
+
+// Crypto++ includes
+#include <cryptopp/sha.h>     // SHA-256 / SHA-512
+#include <cryptopp/hmac.h>    // HMAC
+
+using namespace CryptoPP;
+
+// Exit codes
+static const int kExitOk = 0;
+static const int kExitFailure = 1;
+static const int kExitUsage = 2;
+
+// Parsed command line
+struct CliOptions {
+    std::string command;
+    std::string inPath = "-";  ///< "-" = stdin
+    std::string outPath = "-"; ///< "-" = stdout
+    std::string keyHex;
+    std::string hmacKeyHex;
+    std::string algo;                          ///< hash / --digests; empty = config hash_algorithm
+    std::string format = "cbc";                ///< cbc (.aescbc) or container (.cqac)
+    uint64_t chunkSize = kDefaultChunkBytes;   ///< container record size
+    bool sparse = false;                       ///< container: store holes as zero extents
+    bool zeroChunks = false;                   ///< container: also all-zero chunks (implies sparse)
+    bool digests = false;                      ///< encrypt: plaintext + ciphertext digests in one pass
+    bool armor = false;                        ///< encrypt / decrypt: ASCII-armored ciphertext
+    uint64_t volumeSize = 0;                   ///< volumes: maximum bytes per part
+    std::vector<std::string> volumeDirs;       ///< volumes: part directories, round-robin
+    std::string statePath;                     ///< scrub checkpoint file
+    uint64_t rate = 0;                         ///< read bytes/second, 0 = unlimited
+    unsigned workers = 0;                      ///< concurrent items in batch work, 0 = unlimited
+    IoClass ioClass = IoClass::Default;
+    std::string controlPath;                   ///< throttle control file, re-read while running
+    bool lowPriority = true;                   ///< scrub at idle I/O / nice 19
+    bool pin = false;                          ///< pin shared pool workers to CPUs
+    double seconds = 3;                        ///< bench run time per measurement
+    std::vector<std::string> include;          ///< encrypt-dir globs
+    std::vector<std::string> exclude;
+    bool overwrite = false;                    ///< encrypt-dir: replace existing outputs
+    std::string journalPath;                   ///< encrypt-dir: default DST/.cqac-batch.journal
+    bool journal = true;                       ///< encrypt-dir: keep a resumable job journal
+    bool hashOnly = false;                     ///< watch: write .sha512 instead of .cqac
+    uint64_t settleMs = 250;                   ///< watch: quiet time for files still open
+    bool removeSource = false;                 ///< watch: delete spool files once published
+    bool record = false;                       ///< encrypt / decrypt / hash / mac: append to the history
+    std::string historyPath;                   ///< history store, default HistoryStore::defaultPath()
+    bool tail = false;                         ///< log-read: start at the last tailCount records
+    uint64_t tailCount = 0;
+    bool follow = false;                       ///< log-read: keep reading appended records until stopped
+    std::string checkpointPath;                ///< log-read: resume cursor, updated after each read
+    std::string consumer;                      ///< decrypt: exec:CMD / fifo:PATH / unix:PATH instead of -o
+    std::vector<std::string> positional;
+    QString configPath = "config.json";
+};
+
+// ---------------- Helper functions ------------------
+
+static void printUsage() {
+    std::fprintf(stderr,
+        "Usage: CryptoQtApp <command> [options]\n"
+        "\n"
+        "Commands (stdin -> stdout unless -i/-o are given):\n"
+        "  encrypt   AES-CBC encrypt, output IV || ciphertext (.aescbc format)\n"
+        "  decrypt   reverse of encrypt\n"
+        "  hash      print hex digest (--algo sha256|sha512, default: config hash_algorithm)\n"
+        "  mac       print hex HMAC-SHA256\n"
+        "  verify    check every record of a container (or volume set), no plaintext written\n"
+        "  scrub DIR verify all *.cqac under DIR at low priority, resumable\n"
+        "  encrypt-dir SRC DST  encrypt every file under SRC into DST/<path>.cqac\n"
+        "  restore SRC DST      decrypt *.cqac / *.aescbc under SRC (or listed in file SRC, - = stdin) into DST\n"
+        "  watch SPOOL DST      encrypt files dropped into SPOOL to DST/<name>.cqac until stopped\n"
+        "  bench SUITE  run a benchmark (suites: numa, codec, seal, ctr)\n"
+        "  history   print the operation history as JSON lines\n"
+        "  log-append  seal each stdin line as a record of the encrypted log -o LOG\n"
+        "  log-read    verify and print the records of the encrypted log -i LOG\n"
+        "\n"
+        "Options:\n"
+        "  -i, --in PATH        input file (default: stdin)\n"
+        "  -o, --out PATH       output file (default: stdout)\n"
+        "  --key-file PATH      key pair file saved by the GUI (*.keypair.hex)\n"
+        "  --key HEX            symmetric key (prefer --key-file or CRYPTOQTAPP_KEY)\n"
+        "  --hmac-key HEX       HMAC key (prefer --key-file or CRYPTOQTAPP_HMAC_KEY)\n"
+        "  --algo NAME          hash algorithm for 'hash' and --digests\n"
+        "  --format FMT         encrypt/decrypt format: cbc (default), container or volumes\n"
+        "  --chunk-size N       container record size (default 1M)\n"
+        "  --sparse             container encrypt / encrypt-dir: store file holes as zero extents\n"
+        "  --zero-chunks        like --sparse, and also store all-zero chunks as extents\n"
+        "  --digests            encrypt: also hash plaintext and ciphertext in the same pass, into OUT.sha256\n"
+        "                       (or OUT.sha512 per --algo; printed to stderr when writing to stdout)\n"
+        "  --armor              encrypt: write base64 text with a checksum (text-only transports);\n"
+        "                       decrypt: read such text\n"
+        "  --to CONSUMER        decrypt: stream plaintext to exec:CMD (stdin of CMD), fifo:PATH or\n"
+        "                       unix:PATH (socket) instead of a file\n"
+        "  --volume-size N      volumes: maximum size of one part file (K/M/G suffixes)\n"
+        "  --volume-dir DIR     volumes: write parts round-robin into DIR (repeatable)\n"
+        "  --state PATH         scrub checkpoint (default DIR/.cqac-scrub.state)\n"
+        "  --no-low-priority    scrub at normal CPU / I/O priority\n"
+        "  --include GLOB       encrypt-dir: only matching files (repeatable; '*' matches dot files too)\n"
+        "  --exclude GLOB       encrypt-dir: skip matching files / directories (repeatable)\n"
+        "  --overwrite          encrypt-dir: replace outputs that already exist\n"
+        "  --journal PATH       encrypt-dir: job journal (default DST/.cqac-batch.journal)\n"
+        "  --no-journal         encrypt-dir: no journal, an interrupted run starts over\n"
+        "  --hash               watch: write DST/<name>.sha512 instead of encrypting\n"
+        "  --settle MS          watch: quiet time before a still-open file counts as complete (250)\n"
+        "  --remove-source      watch: delete spool files after their output is published\n"
+        "  --seconds N          bench run time per measurement (default 3)\n"
+        "  --record             encrypt/decrypt/hash/mac: append timing and sizes to the history\n"
+        "  --history PATH       history store (default ~/.local/share/CryptoQtApp/history.cqah)\n"
+        "  --tail N             log-read: only the last N records\n"
+        "  --follow             log-read: keep printing appended records until SIGINT / SIGTERM\n"
+        "  --checkpoint PATH    log-read: resume after the last record read, detecting removed records\n"
+        "\n"
+        "Resource limits (all commands; adjustable at runtime via --control):\n"
+        "  --rate N             read limit in bytes/s (K/M/G suffixes)\n"
+        "  --workers N          max files processed concurrently (0 = unlimited, up to 4096)\n"
+        "  --ioclass CLASS      Linux I/O class: default, best-effort, idle\n"
+        "  --control PATH       file with rate=/workers=/ioclass= lines, polled every second\n"
+        "  --pin                pin worker threads to CPUs, spread over NUMA nodes\n"
+        "  --config PATH        config file (default: config.json)\n"
+        "\n"
+        "Without a command the GUI starts.\n");
+}
+
+
+/**
+ * @brief Reads "symmetric_key_hex:" / "hmac_key_hex:" lines from a GUI key pair file.
+ *
+ * Keys already given on the command line take precedence.
+ */
+static bool readKeyPairFile(const std::string& path, CliOptions& opt) {
+    QFile f(QFile::decodeName(path.c_str()));
+    if (!f.open(QFile::ReadOnly)) return false;
+    for (const QByteArray& raw : f.readAll().split('\n')) {
+        QByteArray line = raw.trimmed();
+        if (line.startsWith("symmetric_key_hex:") && opt.keyHex.empty())
+            opt.keyHex = line.mid(18).trimmed().toStdString();
+        else if (line.startsWith("hmac_key_hex:") && opt.hmacKeyHex.empty())
+            opt.hmacKeyHex = line.mid(13).trimmed().toStdString();
+    }
+    return true;
+}
+
+
+/**
+ * @brief Decodes a hex key and checks its length.
+ */
+static bool decodeKey(const std::string& hex, size_t expectedBytes, SecByteBlock& key) {
+    if (hex.size() != 2 * expectedBytes) return false;
+    key.resize(expectedBytes);
+    return hexDecode(hex.data(), hex.size(), key.BytePtr()); ///< straight into the SecByteBlock, no temporary copy
+}
+
+
+/**
+ * @brief Opens the input ("-" = stdin). Returns -1 on failure.
+ */
+static int openInput(const std::string& path) {
+    int fd = (path == "-") ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) tuneStreamFd(fd);
+    return fd;
+}
+
+
+/**
+ * @brief Opens (creates/truncates) the output ("-" = stdout). Returns -1 on failure.
+ */
+static int openOutput(const std::string& path) {
+    int fd = (path == "-") ? STDOUT_FILENO
+                           : ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd >= 0) tuneStreamFd(fd);
+    return fd;
+}
+
+
+/**
+ * @brief Parses argv into options. Returns false (after printing why) on bad usage.
+ */
+static bool parseArgs(int argc, char** argv, CliOptions& opt) {
+    opt.command = argv[1];
+    std::string keyFile;
+    for (int i = 2; i < argc; ++i) {
+        std::string a = argv[i];
+        auto value = [&](std::string& dst) {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "CryptoQtApp: %s needs a value\n", a.c_str());
+                return false;
+            }
+            dst = argv[++i];
+            return true;
+        };
+        std::string cfg, num;
+        bool ok;
+        if (a == "-i" || a == "--in") ok = value(opt.inPath);
+        else if (a == "-o" || a == "--out") ok = value(opt.outPath);
+        else if (a == "--key") ok = value(opt.keyHex);
+        else if (a == "--hmac-key") ok = value(opt.hmacKeyHex);
+        else if (a == "--key-file") ok = value(keyFile);
+        else if (a == "--algo") ok = value(opt.algo);
+        else if (a == "--config") { ok = value(cfg); opt.configPath = QString::fromStdString(cfg); }
+        else if (a == "--format") ok = value(opt.format);
+        else if (a == "--chunk-size") ok = value(num) && parseByteSize(num, opt.chunkSize);
+        else if (a == "--sparse") { opt.sparse = true; ok = true; }
+        else if (a == "--zero-chunks") { opt.sparse = opt.zeroChunks = true; ok = true; }
+        else if (a == "--digests") { opt.digests = true; ok = true; }
+        else if (a == "--armor") { opt.armor = true; ok = true; }
+        else if (a == "--to") ok = value(opt.consumer);
+        else if (a == "--volume-size") ok = value(num) && parseByteSize(num, opt.volumeSize);
+        else if (a == "--volume-dir") { ok = value(num); if (ok) opt.volumeDirs.push_back(num); }
+        else if (a == "--state") ok = value(opt.statePath);
+        else if (a == "--rate") ok = value(num) && parseByteSize(num, opt.rate);
+        else if (a == "--workers") ok = value(num) && parseWorkerCount(num, opt.workers);
+        else if (a == "--ioclass") ok = value(num) && parseIoClass(num, opt.ioClass);
+        else if (a == "--control") ok = value(opt.controlPath);
+        else if (a == "--no-low-priority") { opt.lowPriority = false; ok = true; }
+        else if (a == "--pin") { opt.pin = true; ok = true; }
+        else if (a == "--include") { ok = value(num); if (ok) opt.include.push_back(num); }
+        else if (a == "--exclude") { ok = value(num); if (ok) opt.exclude.push_back(num); }
+        else if (a == "--overwrite") { opt.overwrite = true; ok = true; }
+        else if (a == "--journal") ok = value(opt.journalPath);
+        else if (a == "--no-journal") { opt.journal = false; ok = true; }
+        else if (a == "--hash") { opt.hashOnly = true; ok = true; }
+        else if (a == "--record") { opt.record = true; ok = true; }
+        else if (a == "--history") ok = value(opt.historyPath);
+        else if (a == "--tail") {
+            char* end = nullptr;
+            ok = value(num);
+            if (ok) opt.tailCount = std::strtoull(num.c_str(), &end, 10);
+            ok = ok && end != num.c_str() && *end == '\0';
+            opt.tail = true;
+        }
+        else if (a == "--follow") { opt.follow = true; ok = true; }
+        else if (a == "--checkpoint") ok = value(opt.checkpointPath);
+        else if (a == "--settle") {
+            char* end = nullptr;
+            ok = value(num);
+            if (ok) opt.settleMs = std::strtoull(num.c_str(), &end, 10);
+            ok = ok && end != num.c_str() && *end == '\0';
+        }
+        else if (a == "--remove-source") { opt.removeSource = true; ok = true; }
+        else if (a == "--seconds") {
+            char* end = nullptr;
+            ok = value(num);
+            if (ok) opt.seconds = std::strtod(num.c_str(), &end);
+            ok = ok && end && *end == '\0' && opt.seconds > 0;
+        }
+        else if (!a.empty() && a[0] != '-') { opt.positional.push_back(a); ok = true; }
+        else {
+            std::fprintf(stderr, "CryptoQtApp: unknown option %s\n", a.c_str());
+            ok = false;
+        }
+        if (!ok) return false;
+    }
+
+    if (const char* env = std::getenv("CRYPTOQTAPP_KEY"); env && opt.keyHex.empty()) opt.keyHex = env;
+    if (const char* env = std::getenv("CRYPTOQTAPP_HMAC_KEY"); env && opt.hmacKeyHex.empty()) opt.hmacKeyHex = env;
+    if (!keyFile.empty() && !readKeyPairFile(keyFile, opt)) {
+        std::fprintf(stderr, "CryptoQtApp: cannot read key file %s\n", keyFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Decodes the symmetric key (--key, --key-file or CRYPTOQTAPP_KEY); prints why on failure.
+ */
+static bool requireKey(const CliOptions& opt, const CryptoConfig& cfg, SecByteBlock& key) {
+    if (decodeKey(opt.keyHex, static_cast<size_t>(cfg.aesKeyBytes), key)) return true;
+    std::fprintf(stderr, "CryptoQtApp: a %d-byte symmetric key (hex) is required\n", cfg.aesKeyBytes);
+    return false;
+}
+
+
+/**
+ * @brief Checks --chunk-size (1 .. kMaxChunkBytes); prints why on failure.
+ */
+static bool checkChunkSize(const CliOptions& opt) {
+    if (opt.chunkSize != 0 && opt.chunkSize <= kMaxChunkBytes) return true;
+    std::fprintf(stderr, "CryptoQtApp: --chunk-size must be 1 .. %uM\n", static_cast<unsigned>(kMaxChunkBytes >> 20));
+    return false;
+}
+
+
+// ---------------- Commands ------------------
+
+/**
+ * @brief encrypt / decrypt --format volumes: -o (encrypt) / -i (decrypt) name the index file.
+ */
+static int cmdVolumes(const CliOptions& opt, const SecByteBlock& key, bool encrypt) {
+    const std::string& indexPath = encrypt ? opt.outPath : opt.inPath;
+    if (indexPath == "-") {
+        std::fprintf(stderr, "CryptoQtApp: volumes need the index path (%s)\n", encrypt ? "-o" : "-i");
+        return kExitUsage;
+    }
+    std::string error;
+    bool ok;
+    if (encrypt) {
+        VolumeOptions vo;
+        vo.volumeBytes = opt.volumeSize;
+        vo.chunkSize = static_cast<uint32_t>(opt.chunkSize);
+        vo.partDirs = opt.volumeDirs;
+        if (volumePlainBytes(vo) == 0) {
+            std::fprintf(stderr, "CryptoQtApp: --volume-size must hold at least one record of --chunk-size\n");
+            return kExitUsage;
+        }
+        int in = openInput(opt.inPath);
+        if (in < 0) {
+            std::fprintf(stderr, "CryptoQtApp: cannot open %s\n", opt.inPath.c_str());
+            return kExitFailure;
+        }
+        ok = encryptVolumes(in, indexPath, key, vo, error);
+    } else if (!opt.consumer.empty()) {
+        ConsumerSpec to;
+        PlaintextConsumer consumer;
+        ok = parseConsumerSpec(opt.consumer, to, error) && consumer.open(to, error);
+        if (ok) ok = decryptVolumes(indexPath, consumer.writer(), key, error);
+        if (ok) ok = consumer.finish(error);
+        else if (!consumer.writeError().empty()) error += " (" + consumer.writeError() + ")";
+    } else {
+        int out = openOutput(opt.outPath);
+        if (out < 0) {
+            std::fprintf(stderr, "CryptoQtApp: cannot create %s\n", opt.outPath.c_str());
+            return kExitFailure;
+        }
+        ok = decryptVolumes(indexPath, fdWriter(out), key, error);
+        if (out != STDOUT_FILENO && ::close(out) != 0 && ok) {
+            ok = false;
+            error = "close failed";
+        }
+    }
+    if (!ok) std::fprintf(stderr, "CryptoQtApp: %s\n", error.c_str());
+    return ok ? kExitOk : kExitFailure;
+}
+
+
+/**
+ * @brief encrypt / decrypt: stream the input through AES-CBC.
+ */
+static int cmdCipher(const CliOptions& opt, const CryptoConfig& cfg, bool encrypt) {
+    SecByteBlock key;
+    if (!requireKey(opt, cfg, key)) return kExitUsage;
+    if (opt.format != "cbc" && opt.format != "container" && opt.format != "volumes") {
+        std::fprintf(stderr, "CryptoQtApp: unsupported --format %s\n", opt.format.c_str());
+        return kExitUsage;
+    }
+    if (!checkChunkSize(opt)) return kExitUsage;
+    const std::string algo = opt.algo.empty() ? cfg.hashAlgorithm.toStdString() : opt.algo;
+    std::unique_ptr<HashTransformation> plainHash, cipherHash;
+    StreamDigests digests;
+    if (opt.armor && opt.format == "volumes") {
+        std::fprintf(stderr, "CryptoQtApp: --armor is not supported for volumes\n");
+        return kExitUsage;
+    }
+    ConsumerSpec to;
+    if (!opt.consumer.empty()) {
+        std::string why;
+        if (encrypt || opt.outPath != "-") why = "--to is for decrypt and replaces -o";
+        else parseConsumerSpec(opt.consumer, to, why);
+        if (!why.empty()) {
+            std::fprintf(stderr, "CryptoQtApp: %s\n", why.c_str());
+            return kExitUsage;
+        }
+    }
+    if (!encrypt && opt.digests) {
+        std::fprintf(stderr, "CryptoQtApp: --digests is only supported for encrypt\n");
+        return kExitUsage;
+    }
+    if (opt.digests) {
+        if (opt.format == "volumes") {
+            std::fprintf(stderr, "CryptoQtApp: --digests is not supported for volumes\n");
+            return kExitUsage;
+        }
+        plainHash = makeHash(algo);
+        cipherHash = makeHash(algo);
+        if (!plainHash) {
+            std::fprintf(stderr, "CryptoQtApp: unsupported hash algorithm %s\n", algo.c_str());
+            return kExitUsage;
+        }
+        digests.plain = plainHash.get();
+        digests.cipher = cipherHash.get();
+    }
+    if (opt.format == "volumes") return cmdVolumes(opt, key, encrypt);
+    int in = openInput(opt.inPath);
+    if (in < 0) {
+        std::fprintf(stderr, "CryptoQtApp: cannot open %s\n", opt.inPath.c_str());
+        return kExitFailure;
+    }
+    // With --to the plaintext goes to the consumer as it is decrypted;
+    // writes block while it is busy, so it sets the pace.
+    PlaintextConsumer consumer;
+    int out = -1;
+    if (!opt.consumer.empty()) {
+        std::string why;
+        if (!consumer.open(to, why)) {
+            std::fprintf(stderr, "CryptoQtApp: %s\n", why.c_str());
+            return kExitFailure;
+        }
+    } else if ((out = openOutput(opt.outPath)) < 0) {
+        std::fprintf(stderr, "CryptoQtApp: cannot create %s\n", opt.outPath.c_str());
+        return kExitFailure;
+    }
+
+    // Armor sits between the cipher and the descriptor; the ciphertext
+    // digest then covers the armored text, i.e. the file that is written.
+    const char* label = opt.format == "container" ? kArmorLabelContainer : kArmorLabelAescbc;
+    ByteReader source = fdReader(in);
+    ByteWriter sink = out >= 0 ? fdWriter(out) : consumer.writer();
+    std::unique_ptr<ArmorWriter> armorOut;
+    std::unique_ptr<ArmorReader> armorIn;
+    if (opt.armor && encrypt) {
+        armorOut = std::make_unique<ArmorWriter>(hashingWriter(sink, digests.cipher), label);
+        sink = armorOut->writer();
+        digests.cipher = nullptr;
+    } else if (opt.armor) {
+        armorIn = std::make_unique<ArmorReader>(source);
+        source = armorIn->reader();
+    }
+    const StreamDigests* fused = plainHash ? &digests : nullptr;
+
+    std::string error;
+    bool ok;
+    if (opt.format == "container") {
+        if (encrypt) {
+            SparseInput sparse;
+            sparse.holes = fdHoleProbe(in); ///< empty for pipes; zero detection still works there
+            sparse.zeroChunks = opt.zeroChunks;
+            ok = encryptContainer(source, sink, key, static_cast<uint32_t>(opt.chunkSize), error,
+                                  nullptr, opt.sparse ? &sparse : nullptr, fused);
+        } else {
+            HoleWriter holes = fdHoleWriter(out); ///< recreate holes when writing a regular file
+            ContainerReport rep = readContainer(source, sink, key, nullptr, holes);
+            ok = rep.status == ContainerReport::Status::Ok;
+            if (!ok) error = describeContainerStatus(rep.status);
+            else if (holes && !finishHoles(out)) {
+                ok = false;
+                error = "cannot set output size";
+            }
+        }
+    } else {
+        ok = encrypt ? encryptStream(source, sink, key, static_cast<size_t>(cfg.aesIvBytes), error, fused)
+                     : decryptStream(source, sink, key, static_cast<size_t>(cfg.aesIvBytes), error);
+    }
+    if (ok && armorOut && !armorOut->final()) {
+        ok = false;
+        error = "write failed";
+    }
+    if (armorIn && !armorIn->error().empty()) { ///< transport damage explains any cipher error
+        ok = false;
+        error = armorIn->error();
+    }
+    if (armorIn && !armorIn->label().empty() && armorIn->label() != label) {
+        ok = false;
+        error = "input is armored as " + armorIn->label() + ", not " + label + " (check --format)";
+    }
+    if (out >= 0 && out != STDOUT_FILENO && ::close(out) != 0 && ok) {
+        ok = false;
+        error = "close failed";
+    }
+    if (out < 0) {
+        if (ok) ok = consumer.finish(error);
+        else if (!consumer.writeError().empty()) error += " (" + consumer.writeError() + ")";
+        consumer.abort(); ///< no-op after finish(); kills the command before its stdin sees EOF
+    }
+    if (ok && plainHash) {
+        auto baseName = [](const std::string& path) {
+            const size_t slash = path.rfind('/');
+            return slash == std::string::npos ? path : path.substr(slash + 1);
+        };
+        const std::string plainHex = finalHex(*plainHash), cipherHex = finalHex(*cipherHash);
+        if (opt.outPath == "-") {
+            std::fprintf(stderr, "%s  %s\n%s  -\n", plainHex.c_str(), opt.inPath.c_str(), cipherHex.c_str());
+        } else {
+            error = writeDigestSidecar(opt.outPath + "." + hashShortName(algo),
+                                       { { plainHex, baseName(opt.inPath) }, { cipherHex, baseName(opt.outPath) } });
+            ok = error.empty();
+        }
+    }
+    if (!ok) std::fprintf(stderr, "CryptoQtApp: %s\n", error.c_str());
+    return ok ? kExitOk : kExitFailure;
+}
+
+
+/**
+ * @brief hash / mac: stream the input through the digest and print it in hex.
+ */
+static int cmdDigest(const CliOptions& opt, const CryptoConfig& cfg, bool mac) {
+    SHA256 sha256;
+    SHA512 sha512;
+    HMAC<SHA256> hmac;
+    HashTransformation* h;
+    const std::string algo = opt.algo.empty() ? cfg.hashAlgorithm.toStdString() : opt.algo;
+
+    if (mac) {
+        // same fallback as the GUI: HMAC key, else the symmetric key
+        const std::string& hex = opt.hmacKeyHex.empty() ? opt.keyHex : opt.hmacKeyHex;
+        SecByteBlock key;
+        if (!decodeKey(hex, static_cast<size_t>(cfg.hmacKeyBytes), key)) {
+            std::fprintf(stderr, "CryptoQtApp: a %d-byte HMAC key (hex) is required\n", cfg.hmacKeyBytes);
+            return kExitUsage;
+        }
+        hmac.SetKey(key, key.size());
+        h = &hmac;
+    } else if (hashShortName(algo) == "sha256") {
+        h = &sha256;
+    } else if (hashShortName(algo) == "sha512") {
+        h = &sha512;
+    } else {
+        std::fprintf(stderr, "CryptoQtApp: unsupported hash algorithm %s\n", algo.c_str());
+        return kExitUsage;
+    }
+
+    int in = openInput(opt.inPath);
+    if (in < 0) {
+        std::fprintf(stderr, "CryptoQtApp: cannot open %s\n", opt.inPath.c_str());
+        return kExitFailure;
+    }
+    std::string digest;
+    if (!hashFd(in, *h, digest)) {
+        std::fprintf(stderr, "CryptoQtApp: read failed\n");
+        return kExitFailure;
+    }
+
+    std::string hex = toHex(digest) + '\n';
+    int out = openOutput(opt.outPath);
+    if (out < 0 || !writeAll(out, hex.data(), hex.size())) {
+        std::fprintf(stderr, "CryptoQtApp: cannot write %s\n", opt.outPath.c_str());
+        return kExitFailure;
+    }
+    if (out != STDOUT_FILENO) ::close(out);
+    return kExitOk;
+}
+
+
+/**
+ * @brief verify: authenticate every record of one container without writing plaintext.
+ */
+static int cmdVerify(const CliOptions& opt, const CryptoConfig& cfg) {
+    SecByteBlock key;
+    if (!requireKey(opt, cfg, key)) return kExitUsage;
+    if (opt.format == "volumes") {
+        std::string error;
+        if (!decryptVolumes(opt.inPath, ByteWriter(), key, error)) {
+            std::fprintf(stderr, "CryptoQtApp: %s\n", error.c_str());
+            return kExitFailure;
+        }
+        std::fprintf(stderr, "%s: OK\n", opt.inPath.c_str());
+        return kExitOk;
+    }
+    int in = openInput(opt.inPath);
+    if (in < 0) {
+        std::fprintf(stderr, "CryptoQtApp: cannot open %s\n", opt.inPath.c_str());
+        return kExitFailure;
+    }
+    ContainerReport rep = readContainer(fdReader(in), ByteWriter(), key);
+    if (rep.status != ContainerReport::Status::Ok) {
+        std::fprintf(stderr, "CryptoQtApp: %s: %s (record %llu)\n", opt.inPath.c_str(),
+                     describeContainerStatus(rep.status), static_cast<unsigned long long>(rep.badRecord));
+        return kExitFailure;
+    }
+    std::fprintf(stderr, "%s: OK (%llu records, %llu bytes)\n", opt.inPath.c_str(),
+                 static_cast<unsigned long long>(rep.records), static_cast<unsigned long long>(rep.plainBytes));
+    return kExitOk;
+}
+
+
+/**
+ * @brief scrub DIR: verify every container below DIR, politely and resumably.
+ *
+ * Damaged files are printed to stdout ("BAD <path>: <reason>") so the output
+ * can be fed to alerting; the exit code is 1 if any file is damaged.
+ */
+static int cmdScrub(const CliOptions& opt, const CryptoConfig& cfg) {
+    if (opt.positional.size() != 1) {
+        std::fprintf(stderr, "CryptoQtApp: scrub needs exactly one directory\n");
+        return kExitUsage;
+    }
+    SecByteBlock key;
+    if (!requireKey(opt, cfg, key)) return kExitUsage;
+
+    ScrubOptions so;
+    so.root = opt.positional[0];
+    so.statePath = opt.statePath;
+    so.throttle = &Throttle::background();
+    so.lowPriority = opt.lowPriority;
+
+    ScrubStats stats;
+    std::string error;
+    bool ok = runScrub(so, key, stats, [](const std::string& path, const std::string& problem) {
+        std::printf("BAD %s: %s\n", path.c_str(), problem.c_str());
+        std::fflush(stdout);
+    }, error);
+    if (!ok) {
+        std::fprintf(stderr, "CryptoQtApp: %s\n", error.c_str());
+        return kExitFailure;
+    }
+    std::fprintf(stderr, "scrub complete: %llu ok, %llu bad, %llu already checked, %llu unreadable entries, %llu bytes read\n",
+                 static_cast<unsigned long long>(stats.filesOk), static_cast<unsigned long long>(stats.filesBad),
+                 static_cast<unsigned long long>(stats.filesSkipped),
+                 static_cast<unsigned long long>(stats.entriesUnreadable), static_cast<unsigned long long>(stats.bytes));
+    return stats.filesBad == 0 ? kExitOk : kExitFailure;
+}
+
+
+/**
+ * @brief encrypt-dir SRC DST: encrypt a tree into containers while it is still being walked.
+ *
+ * Failed files are printed to stdout ("FAIL <path>: <reason>"); the exit
+ * code is 1 if any file failed.
+ */
+static int cmdEncryptDir(const CliOptions& opt, const CryptoConfig& cfg) {
+    if (opt.positional.size() != 2) {
+        std::fprintf(stderr, "CryptoQtApp: encrypt-dir needs a source and a target directory\n");
+        return kExitUsage;
+    }
+    SecByteBlock key;
+    if (!requireKey(opt, cfg, key)) return kExitUsage;
+    if (!checkChunkSize(opt)) return kExitUsage;
+
+    BatchOptions bo;
+    bo.srcRoot = opt.positional[0];
+    bo.dstRoot = opt.positional[1];
+    bo.walk.include = opt.include;
+    bo.walk.exclude = opt.exclude;
+    bo.chunkSize = static_cast<uint32_t>(opt.chunkSize);
+    bo.overwrite = opt.overwrite;
+    bo.sparse = opt.sparse;
+    bo.zeroChunks = opt.zeroChunks;
+    if (opt.journal) bo.journalPath = opt.journalPath.empty() ? bo.dstRoot + "/.cqac-batch.journal" : opt.journalPath;
+
+    BatchStats stats;
+    std::mutex printMutex;
+    std::string error;
+    bool ok = runBatchEncrypt(bo, key, stats, [&](const std::string& path, const std::string& err) {
+        if (err.empty()) return;
+        std::lock_guard<std::mutex> lock(printMutex);
+        std::printf("FAIL %s: %s\n", path.c_str(), err.c_str());
+        std::fflush(stdout);
+    }, error);
+    if (!ok) {
+        std::fprintf(stderr, "CryptoQtApp: %s\n", error.c_str());
+        return kExitFailure;
+    }
+    std::fprintf(stderr, "encrypt-dir: %llu encrypted (%llu resumed), %llu failed, %llu already present, %llu bytes\n",
+                 static_cast<unsigned long long>(stats.filesOk.load()),
+                 static_cast<unsigned long long>(stats.filesResumed.load()),
+                 static_cast<unsigned long long>(stats.filesFailed.load()),
+                 static_cast<unsigned long long>(stats.filesSkipped.load()),
+                 static_cast<unsigned long long>(stats.bytesIn.load()));
+    return stats.filesFailed == 0 ? kExitOk : kExitFailure;
+}
+
+
+/**
+ * @brief restore SRC DST: decrypt many files concurrently, largest first.
+ *
+ * Prints "OK <src> <bytes> <ms>" or "FAIL <src>: <reason>" per file, in the
+ * order of the directory listing / list file.
+ */
+static int cmdRestore(const CliOptions& opt, const CryptoConfig& cfg) {
+    if (opt.positional.size() != 2) {
+        std::fprintf(stderr, "CryptoQtApp: restore needs a source (directory or list file) and a target directory\n");
+        return kExitUsage;
+    }
+    SecByteBlock key;
+    if (!requireKey(opt, cfg, key)) return kExitUsage;
+
+    std::vector<RestoreItem> items;
+    std::string error;
+    if (!collectRestoreItems(opt.positional[0], opt.positional[1], items, error)) {
+        std::fprintf(stderr, "CryptoQtApp: %s\n", error.c_str());
+        return kExitFailure;
+    }
+
+    RestoreStats stats;
+    const auto start = std::chrono::steady_clock::now();
+    runRestore(items, key, static_cast<size_t>(cfg.aesIvBytes), stats,
+               [](size_t, const RestoreItem& item, const RestoreResult& r) {
+        if (r.error.empty())
+            std::printf("OK %s %llu %.1f\n", item.src.c_str(), static_cast<unsigned long long>(r.plainBytes),
+                        r.seconds * 1000);
+        else
+            std::printf("FAIL %s: %s\n", item.src.c_str(), r.error.c_str());
+        std::fflush(stdout);
+    });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "restore: %llu restored, %llu failed, %llu bytes in %.2f s\n",
+                 static_cast<unsigned long long>(stats.filesOk.load()),
+                 static_cast<unsigned long long>(stats.filesFailed.load()),
+                 static_cast<unsigned long long>(stats.bytesOut.load()), seconds);
+    return stats.filesFailed == 0 ? kExitOk : kExitFailure;
+}
+
+
+static std::atomic<bool> watchStop{false};
+
+static void onStopSignal(int) {
+    watchStop.store(true); ///< lock-free atomic: async-signal-safe
+}
+
+
+/**
+ * @brief watch SPOOL DST: encrypt (or hash) spool arrivals until SIGINT / SIGTERM.
+ *
+ * Prints "OK <name> <latency ms>" or "FAIL <name>: <reason>" per file.
+ */
+static int cmdWatch(const CliOptions& opt, const CryptoConfig& cfg) {
+    if (opt.positional.size() != 2) {
+        std::fprintf(stderr, "CryptoQtApp: watch needs a spool and a target directory\n");
+        return kExitUsage;
+    }
+    SecByteBlock key;
+    if (!opt.hashOnly && !requireKey(opt, cfg, key)) return kExitUsage;
+    if (!checkChunkSize(opt)) return kExitUsage;
+    if (opt.settleMs > 60000) {
+        std::fprintf(stderr, "CryptoQtApp: --settle must be at most 60000\n");
+        return kExitUsage;
+    }
+
+    WatchOptions wo;
+    wo.spoolDir = opt.positional[0];
+    wo.dstDir = opt.positional[1];
+    wo.action = opt.hashOnly ? WatchOptions::Action::Hash : WatchOptions::Action::Encrypt;
+    wo.include = opt.include;
+    wo.exclude = opt.exclude;
+    wo.chunkSize = static_cast<uint32_t>(opt.chunkSize);
+    wo.settleMs = static_cast<int>(opt.settleMs);
+    wo.removeSource = opt.removeSource;
+
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    WatchStats stats;
+    std::string error;
+    bool ok = runWatchFolder(wo, key, stats, [](const std::string& name, const std::string& err, double ms) {
+        if (err.empty()) std::printf("OK %s %.1f\n", name.c_str(), ms);
+        else std::printf("FAIL %s: %s\n", name.c_str(), err.c_str());
+        std::fflush(stdout);
+    }, watchStop, error);
+    if (!ok) {
+        std::fprintf(stderr, "CryptoQtApp: %s\n", error.c_str());
+        return kExitFailure;
+    }
+    std::fprintf(stderr, "watch stopped: %llu processed, %llu failed, %llu batches\n",
+                 static_cast<unsigned long long>(stats.filesOk.load()),
+                 static_cast<unsigned long long>(stats.filesFailed.load()),
+                 static_cast<unsigned long long>(stats.batches.load()));
+    return kExitOk;
+}
+
+
+/**
+ * @brief history: export the operation history store as JSON lines.
+ */
+static int cmdHistory(const CliOptions& opt) {
+    const std::string path = opt.historyPath.empty() ? HistoryStore::defaultPath() : opt.historyPath;
+    std::vector<HistoryRecord> records;
+    std::string error;
+    if (!loadHistory(path, records, error)) {
+        std::fprintf(stderr, "CryptoQtApp: %s\n", error.c_str());
+        return kExitFailure;
+    }
+    int out = openOutput(opt.outPath);
+    if (out < 0) {
+        std::fprintf(stderr, "CryptoQtApp: cannot open %s\n", opt.outPath.c_str());
+        return kExitFailure;
+    }
+    std::string text;
+    for (const HistoryRecord& r : records) text += historyJsonLine(r);
+    const bool ok = writeAll(out, text.data(), text.size());
+    if (out != STDOUT_FILENO) ::close(out);
+    return ok ? kExitOk : kExitFailure;
+}
+
+
+/**
+ * @brief log-append -o LOG: seal each line of the input as one log record.
+ *
+ * Lines are appended as they arrive (a pipe from a running program works);
+ * a last line without a newline is sealed at end of input.
+ */
+static int cmdLogAppend(const CliOptions& opt, const CryptoConfig& cfg) {
+    SecByteBlock key;
+    if (!requireKey(opt, cfg, key)) return kExitUsage;
+    if (opt.outPath == "-") {
+        std::fprintf(stderr, "CryptoQtApp: log-append needs the log file (-o LOG)\n");
+        return kExitUsage;
+    }
+    int in = openInput(opt.inPath);
+    if (in < 0) {
+        std::fprintf(stderr, "CryptoQtApp: cannot open %s\n", opt.inPath.c_str());
+        return kExitFailure;
+    }
+    SealedLogWriter log;
+    std::string error;
+    if (!log.open(opt.outPath, key, error)) {
+        std::fprintf(stderr, "CryptoQtApp: %s\n", error.c_str());
+        if (in != STDIN_FILENO) ::close(in);
+        return kExitFailure;
+    }
+
+    std::vector<byte> buf(64 * 1024);
+    std::string partial;  ///< line continued from the previous read
+    bool ok = true;
+    ssize_t n;
+    while (ok && (n = ::read(in, buf.data(), buf.size())) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            error = "read error";
+            ok = false;
+            break;
+        }
+        const byte* p = buf.data();
+        const byte* end = p + n;
+        while (ok && p < end) {
+            const byte* nl = static_cast<const byte*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            if (!nl) {
+                partial.append(reinterpret_cast<const char*>(p), static_cast<size_t>(end - p));
+                break;
+            }
+            if (partial.empty()) {
+                ok = log.append(p, static_cast<size_t>(nl - p), error);
+            } else {
+                partial.append(reinterpret_cast<const char*>(p), static_cast<size_t>(nl - p));
+                ok = log.append(reinterpret_cast<const byte*>(partial.data()), partial.size(), error);
+                partial.clear();
+            }
+            p = nl + 1;
+        }
+    }
+    if (ok && !partial.empty()) ok = log.append(reinterpret_cast<const byte*>(partial.data()), partial.size(), error);
+    if (ok) ok = log.sync(error);
+    if (in != STDIN_FILENO) ::close(in);
+    if (!ok) {
+        std::fprintf(stderr, "CryptoQtApp: %s: %s\n", opt.outPath.c_str(), error.c_str());
+        return kExitFailure;
+    }
+    return kExitOk;
+}
+
+
+/**
+ * @brief Writes a log cursor next to its final path and renames it into place.
+ */
+static bool saveLogCheckpoint(const std::string& path, const LogCursor& cursor) {
+    const std::string tmp = path + ".tmp";
+    const std::string text = cursor.toString() + "\n";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) return false;
+    const bool ok = writeAll(fd, text.data(), text.size()) && ::fsync(fd) == 0;
+    ::close(fd);
+    return ok && std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+
+/**
+ * @brief log-read -i LOG: verify the MAC chain and print each record as a line.
+ *
+ * With --checkpoint the read resumes where the last one stopped, so only new
+ * records are decrypted; --follow keeps polling for appended records.
+ */
+static int cmdLogRead(const CliOptions& opt, const CryptoConfig& cfg) {
+    SecByteBlock key;
+    if (!requireKey(opt, cfg, key)) return kExitUsage;
+    if (opt.inPath == "-") {
+        std::fprintf(stderr, "CryptoQtApp: log-read needs the log file (-i LOG)\n");
+        return kExitUsage;
+    }
+    int fd = ::open(opt.inPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::fprintf(stderr, "CryptoQtApp: cannot open %s\n", opt.inPath.c_str());
+        return kExitFailure;
+    }
+    int out = openOutput(opt.outPath);
+    if (out < 0) {
+        std::fprintf(stderr, "CryptoQtApp: cannot open %s\n", opt.outPath.c_str());
+        ::close(fd);
+        return kExitFailure;
+    }
+    auto finish = [&](int code) {
+        ::close(fd);
+        if (out != STDOUT_FILENO) ::close(out);
+        return code;
+    };
+
+    LogCursor cursor;
+    std::string error;
+    bool resumed = false;
+    if (!opt.checkpointPath.empty()) {
+        QFile f(QFile::decodeName(opt.checkpointPath.c_str()));
+        if (f.open(QFile::ReadOnly)) {
+            if (!cursor.parse(f.readAll().trimmed().toStdString())) {
+                std::fprintf(stderr, "CryptoQtApp: bad checkpoint %s\n", opt.checkpointPath.c_str());
+                return finish(kExitFailure);
+            }
+            resumed = true;
+        }
+    }
+    if (!resumed && opt.tail && !seekSealedLogTail(fd, opt.tailCount, cursor, error)) {
+        std::fprintf(stderr, "CryptoQtApp: %s: %s\n", opt.inPath.c_str(), error.c_str());
+        return finish(kExitFailure);
+    }
+
+    std::string text;
+    bool writeOk = true;
+    auto sink = [&](uint64_t, const byte* data, size_t n) {
+        text.append(reinterpret_cast<const char*>(data), n);
+        text += '\n';
+        if (text.size() >= 64 * 1024) {
+            writeOk = writeAll(out, text.data(), text.size());
+            text.clear();
+        }
+        return writeOk;
+    };
+
+    if (opt.follow) {
+        std::signal(SIGINT, onStopSignal);
+        std::signal(SIGTERM, onStopSignal);
+    }
+    for (;;) {
+        const SealedLogReport rep = readSealedLog(fd, key, cursor, sink);
+        if (writeOk && !text.empty()) writeOk = writeAll(out, text.data(), text.size());
+        text.clear();
+        if (!writeOk) {
+            std::fprintf(stderr, "CryptoQtApp: write failed\n");
+            return finish(kExitFailure);
+        }
+        if (rep.status != SealedLogReport::Status::Ok) {
+            std::fprintf(stderr, "CryptoQtApp: %s: %s", opt.inPath.c_str(), describeSealedLogStatus(rep.status));
+            if (rep.status == SealedLogReport::Status::Corrupt)
+                std::fprintf(stderr, " at record %llu", static_cast<unsigned long long>(rep.badRecord));
+            std::fprintf(stderr, "\n");
+            return finish(kExitFailure);
+        }
+        if (rep.records && !opt.checkpointPath.empty() && !saveLogCheckpoint(opt.checkpointPath, cursor)) {
+            std::fprintf(stderr, "CryptoQtApp: cannot write checkpoint %s\n", opt.checkpointPath.c_str());
+            return finish(kExitFailure);
+        }
+        if (!opt.follow) {
+            if (rep.partialTail) std::fprintf(stderr, "CryptoQtApp: %s ends in an incomplete record\n", opt.inPath.c_str());
+            break;
+        }
+        for (int i = 0; i < 10 && !watchStop.load(); ++i) ::usleep(50 * 1000); ///< poll every 500 ms
+        if (watchStop.load()) break;
+    }
+    return finish(kExitOk);
+}
+
+
+/**
+ * @brief Size of a regular file, 0 for stdin / stdout or anything unreadable.
+ */
+static uint64_t fileBytes(const std::string& path) {
+    struct stat st;
+    if (path == "-" || ::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return 0;
+    return static_cast<uint64_t>(st.st_size);
+}
+
+
+/**
+ * @brief Runs a single-stream command and, with --record, appends its timing to the history.
+ *
+ * Crypto++ / std exceptions are recorded as failures and passed on.
+ */
+static int runRecorded(const CliOptions& opt, const CryptoConfig& cfg, const std::function<int()>& command) {
+    if (!opt.record) return command();
+    HistoryRecord rec;
+    rec.startMs = historyNowMs();
+    rec.operation = "cli " + opt.command;
+    if (opt.command == "hash") rec.algorithm = opt.algo.empty() ? cfg.hashAlgorithm.toStdString() : opt.algo;
+    else if (opt.command == "mac") rec.algorithm = "HMAC-SHA256";
+    else rec.algorithm = "AES-" + std::to_string(cfg.aesKeyBytes * 8) + (opt.format == "cbc" ? "-CBC" : "-GCM");
+    rec.input = opt.inPath;
+    const auto start = std::chrono::steady_clock::now();
+    auto save = [&] {
+        rec.durationUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        rec.inputBytes = fileBytes(opt.inPath);
+        rec.outputBytes = fileBytes(opt.outPath);
+        HistoryStore store;
+        std::string error;
+        if (!store.open(opt.historyPath.empty() ? HistoryStore::defaultPath() : opt.historyPath, error))
+            std::fprintf(stderr, "CryptoQtApp: history not recorded: %s\n", error.c_str());
+        else if (!store.append(rec))
+            std::fprintf(stderr, "CryptoQtApp: history not recorded: write failed\n");
+    };
+    int code;
+    try {
+        code = command();
+    } catch (const std::exception& e) { ///< Crypto++ exceptions included; runCli reports them
+        rec.ok = false;
+        rec.error = e.what();
+        save();
+        throw;
+    }
+    rec.ok = code == kExitOk;
+    if (!rec.ok) rec.error = "exit code " + std::to_string(code);
+    save();
+    return code;
+}
+
+
+/**
+ * @brief bench SUITE: print throughput figures for this host.
+ */
+static int cmdBench(const CliOptions& opt) {
+    const std::string suite = opt.positional.empty() ? "numa" : opt.positional[0];
+    if (!checkChunkSize(opt)) return kExitUsage;
+    if (suite == "numa") {
+        const CpuTopology& topo = CpuTopology::system();
+        std::printf("usable CPUs: %zu, NUMA nodes: %u, cgroup quota: %s\n", topo.cpus.size(), topo.nodes,
+                    topo.quotaCpus ? std::to_string(topo.quotaCpus).c_str() : "none");
+        std::printf("%-6s %8s %14s %14s\n", "node", "threads", "local MB/s", "remote MB/s");
+        double total = 0;
+        for (const NodeThroughput& r : benchNodeThroughput(opt.seconds, static_cast<size_t>(opt.chunkSize))) {
+            if (r.remoteMBps < 0)
+                std::printf("%-6u %8u %14.1f %14s\n", r.node, r.threads, r.localMBps, "-");
+            else
+                std::printf("%-6u %8u %14.1f %14.1f\n", r.node, r.threads, r.localMBps, r.remoteMBps);
+            total += r.localMBps;
+        }
+        std::printf("sum of node-local throughput: %.1f MB/s\n", total);
+        return kExitOk;
+    }
+    if (suite == "codec") {
+        std::printf("bulk path: %s, buffer: %llu bytes\n", textCodecPath(),
+                    static_cast<unsigned long long>(opt.chunkSize));
+        std::printf("%-14s %14s %14s\n", "codec", "fast MB/s", "Crypto++ MB/s");
+        try {
+            for (const CodecThroughput& r : benchTextCodecs(opt.seconds, static_cast<size_t>(opt.chunkSize)))
+                std::printf("%-14s %14.1f %14.1f\n", r.name, r.fastMBps, r.cryptoppMBps);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "CryptoQtApp: %s\n", e.what());
+            return kExitFailure;
+        }
+        return kExitOk;
+    }
+    if (suite == "seal") {
+        std::printf("AES: %s, AES-256-GCM, nonce + tag overhead %zu bytes\n", aesProvider().c_str(),
+                    kSealOverheadBytes);
+        std::printf("%-6s %12s %12s %12s %12s %14s\n", "bytes", "seal p50 ns", "seal p99 ns", "open p50 ns",
+                    "open p99 ns", "filter p50 ns");
+        try {
+            for (const SealLatency& r : benchSealLatency(opt.seconds))
+                std::printf("%-6zu %12.0f %12.0f %12.0f %12.0f %14.0f\n", r.bytes, r.sealP50Ns, r.sealP99Ns,
+                            r.openP50Ns, r.openP99Ns, r.filterP50Ns);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "CryptoQtApp: %s\n", e.what());
+            return kExitFailure;
+        }
+        return kExitOk;
+    }
+    if (suite == "ctr") {
+        const CpuTopology& topo = CpuTopology::system();
+        std::printf("AES: %s, AES-256-CTR, buffer: %u bytes in %zu-byte counter ranges, NUMA nodes: %u\n",
+                    aesProvider().c_str(), kMaxChunkBytes, kCtrSliceBytes, topo.nodes);
+        std::printf("%-8s %12s %10s\n", "threads", "MB/s", "speedup");
+        try {
+            double single = 0;
+            for (const CtrScaling& r : benchCtrScaling(opt.seconds, kMaxChunkBytes)) { ///< large-backup sized buffer
+                if (r.threads == 1) single = r.totalMBps;
+                std::printf("%-8u %12.1f %9.2fx\n", r.threads, r.totalMBps, single > 0 ? r.totalMBps / single : 0);
+            }
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "CryptoQtApp: %s\n", e.what());
+            return kExitFailure;
+        }
+        return kExitOk;
+    }
+    std::fprintf(stderr, "CryptoQtApp: unknown bench suite %s\n", suite.c_str());
+    return kExitUsage;
+}
+
+
+// ---------------- Entry points ------------------
+
+/**
+ * @brief Tells main() whether argv[1] is a CLI command.
+ *
+ * @param arg argv[1].
+ * @return true for a known command or a help flag.
+ */
+bool isCliCommand(const char* arg) {
+    static const char* const commands[] = { "encrypt", "decrypt", "hash", "mac", "verify", "scrub", "encrypt-dir", "restore", "watch", "bench", "history", "log-append", "log-read", "help", "--help", "-h" };
+    for (const char* c : commands)
+        if (std::strcmp(arg, c) == 0) return true;
+    return false;
+}
+
+
+/**
+ * @brief Runs one CLI command.
+ *
+ * @param argc Argument count from main().
+ * @param argv Arguments from main(); argv[1] is the command.
+ * @return Process exit code (0 success, 1 failure, 2 usage error).
+ */
+int runCli(int argc, char** argv) {
+    CliOptions opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage();
+        return kExitUsage;
+    }
+    if (opt.command == "help" || opt.command == "--help" || opt.command == "-h") {
+        printUsage();
+        return kExitOk;
+    }
+    const bool takesArgs = opt.command == "scrub" || opt.command == "encrypt-dir" || opt.command == "restore"
+                           || opt.command == "watch" || opt.command == "bench";
+    if (!takesArgs && !opt.positional.empty()) {
+        std::fprintf(stderr, "CryptoQtApp: unexpected argument %s (use -i/-o for files)\n", opt.positional[0].c_str());
+        return kExitUsage;
+    }
+
+    CryptoConfig cfg;
+    if (loadCryptoConfig(opt.configPath, cfg) == ConfigStatus::Invalid)
+        std::fprintf(stderr, "CryptoQtApp: %s invalid - using defaults\n", opt.configPath.toLocal8Bit().constData());
+
+    // Every command runs under the background throttle; it is unlimited unless
+    // --rate / --workers / --ioclass or the control file say otherwise.
+    Throttle& throttle = Throttle::background();
+    throttle.bandwidth.setRate(opt.rate);
+    throttle.workers.setLimit(opt.workers);
+    throttle.ioClass.store(opt.ioClass);
+    std::unique_ptr<ThrottleControlFile> control;
+    if (!opt.controlPath.empty()) control.reset(new ThrottleControlFile(opt.controlPath, throttle));
+    ThrottleScope scope(&throttle);
+    if (opt.pin) WorkerPool::setSharedPinning(true);
+
+    try {
+        if (opt.command == "encrypt") return runRecorded(opt, cfg, [&] { return cmdCipher(opt, cfg, true); });
+        if (opt.command == "decrypt") return runRecorded(opt, cfg, [&] { return cmdCipher(opt, cfg, false); });
+        if (opt.command == "hash") return runRecorded(opt, cfg, [&] { return cmdDigest(opt, cfg, false); });
+        if (opt.command == "mac") return runRecorded(opt, cfg, [&] { return cmdDigest(opt, cfg, true); });
+        if (opt.command == "verify") return cmdVerify(opt, cfg);
+        if (opt.command == "scrub") return cmdScrub(opt, cfg);
+        if (opt.command == "encrypt-dir") return cmdEncryptDir(opt, cfg);
+        if (opt.command == "restore") return cmdRestore(opt, cfg);
+        if (opt.command == "watch") return cmdWatch(opt, cfg);
+        if (opt.command == "bench") return cmdBench(opt);
+        if (opt.command == "history") return cmdHistory(opt);
+        if (opt.command == "log-append") return cmdLogAppend(opt, cfg);
+        if (opt.command == "log-read") return cmdLogRead(opt, cfg);
+    } catch (const Exception& e) {
+        std::fprintf(stderr, "CryptoQtApp: Crypto++ error: %s\n", e.what());
+        return kExitFailure;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "CryptoQtApp: error: %s\n", e.what());
+        return kExitFailure;
+    }
+    printUsage();
+    return kExitUsage;
+}
@@ -0,0 +1,8 @@
+#pragma once  // ensures the header is only included once during compilation
+
+// Headless command-line mode: `CryptoQtApp <command> [options]`.
+// Commands read stdin / write stdout by default so the binary can be used as
+// a filter stage in shell pipelines (e.g. pg_dump | CryptoQtApp encrypt | ...).
+
+bool isCliCommand(const char* arg); // true if argv[1] selects the CLI instead of the GUI
+int runCli(int argc, char** argv);  // returns the process exit code
@@ -0,0 +1,318 @@
+#include "consumer.h"
+
+#include <cerrno>      // EAGAIN, EINTR, ENXIO
+#include <csignal>     // SIGPIPE, SIGTERM, SIGKILL
+#include <cstring>     // strerror, strncpy
+
+#include <fcntl.h>     // open, fcntl
+#include <poll.h>      // back-pressure waits
+#include <spawn.h>     // posix_spawn
+#include <sys/socket.h>
+#include <sys/stat.h>  // mkfifo, S_ISFIFO
+#include <sys/un.h>    // sockaddr_un
+#include <sys/wait.h>  // waitpid
+#include <unistd.h>    // pipe2, write, close, unlink
+
+extern char** environ;
+
+static const int kWaitSliceMs = 200;  ///< how often blocked writes check `stop`
+static const int kFifoPollMs = 100;   ///< how often an unread fifo is retried
+static const int kAbortGraceMs = 5000; ///< how long an aborted command may take to exit after SIGTERM
+static const int kReapPollMs = 50;
+
+// ---------------- Helper functions ------------------
+
+static std::string errnoText(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+
+static bool setNonBlocking(int fd) {
+    const int flags = ::fcntl(fd, F_GETFL);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+
+/**
+ * @brief Runs `command` under /bin/sh with the read end of a new pipe as stdin.
+ *
+ * SIGPIPE is reset to its default in the child, so pipelines inside the
+ * command behave as they do from a shell even though we ignore it here.
+ * The shell leads a process group of its own, so abort() can stop every
+ * process of a pipeline, not just the shell.
+ *
+ * @return Write end of the pipe, or -1 with `error` set.
+ */
+static int spawnCommand(const std::string& command, pid_t& pid, std::string& error) {
+    int p[2];
+    if (::pipe2(p, O_CLOEXEC) != 0) {
+        error = errnoText("pipe");
+        return -1;
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, p[0], STDIN_FILENO); ///< dup2 clears FD_CLOEXEC on stdin
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setpgroup(&attr, 0); ///< pgid = the shell's pid
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETPGROUP);
+
+    char sh[] = "sh";
+    char dashC[] = "-c";
+    std::string cmd = command;
+    char* argv[] = { sh, dashC, &cmd[0], nullptr };
+    const int rc = ::posix_spawn(&pid, "/bin/sh", &actions, &attr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    ::close(p[0]);
+    if (rc != 0) {
+        ::close(p[1]);
+        errno = rc;
+        error = errnoText("cannot start /bin/sh");
+        return -1;
+    }
+    return p[1];
+}
+
+
+/**
+ * @brief Opens a named pipe for writing once a reader has opened it.
+ *
+ * O_NONBLOCK makes open() fail with ENXIO while there is no reader, which
+ * lets the wait be abandoned.
+ */
+static int openFifo(const std::string& path, const std::function<bool()>& stop, std::string& error) {
+    for (;;) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd >= 0) return fd;
+        if (errno != ENXIO && errno != EINTR) {
+            error = errnoText(path.c_str());
+            return -1;
+        }
+        if (stop && stop()) {
+            error = "no reader on " + path;
+            return -1;
+        }
+        ::poll(nullptr, 0, kFifoPollMs);
+    }
+}
+
+
+static int connectSocket(const std::string& path, std::string& error) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        error = "socket path too long: " + path;
+        return -1;
+    }
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = errnoText("socket");
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        error = errnoText(path.c_str());
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+// ---------------- ConsumerSpec ------------------
+
+bool parseConsumerSpec(const std::string& text, ConsumerSpec& spec, std::string& error) {
+    const size_t colon = text.find(':');
+    const std::string scheme = colon == std::string::npos ? "" : text.substr(0, colon);
+    spec.target = colon == std::string::npos ? "" : text.substr(colon + 1);
+    if (scheme == "exec") spec.kind = ConsumerSpec::Kind::Command;
+    else if (scheme == "fifo") spec.kind = ConsumerSpec::Kind::Fifo;
+    else if (scheme == "unix") spec.kind = ConsumerSpec::Kind::Socket;
+    else {
+        error = "consumer must be exec:CMD, fifo:PATH or unix:PATH";
+        return false;
+    }
+    if (spec.target.empty()) {
+        error = "empty " + scheme + " target";
+        return false;
+    }
+    return true;
+}
+
+
+std::string describeConsumer(const ConsumerSpec& spec) {
+    switch (spec.kind) {
+    case ConsumerSpec::Kind::Command: return "exec: " + spec.target;
+    case ConsumerSpec::Kind::Fifo: return "fifo: " + spec.target;
+    case ConsumerSpec::Kind::Socket: return "unix: " + spec.target;
+    }
+    return spec.target;
+}
+
+
+// ---------------- PlaintextConsumer ------------------
+
+PlaintextConsumer::~PlaintextConsumer() {
+    abort();
+}
+
+
+/**
+ * @brief Starts the command, opens the named pipe or connects the socket.
+ *
+ * A fifo path that does not exist is created with mode 0600; any other
+ * existing non-fifo path is refused, since writing there would put the
+ * plaintext on disk.
+ *
+ * @param spec Consumer to feed.
+ * @param error Receives a description on failure.
+ * @param stop Polled while waiting for a fifo reader; true gives up.
+ * @return true if writer() may be used.
+ */
+bool PlaintextConsumer::open(const ConsumerSpec& target, std::string& error, std::function<bool()> stop) {
+    abort();
+    std::signal(SIGPIPE, SIG_IGN); ///< EPIPE from write() instead of a fatal signal
+    spec = target;
+    bytes = 0;
+    lastError.clear();
+    switch (spec.kind) {
+    case ConsumerSpec::Kind::Command:
+        fd = spawnCommand(spec.target, child, error);
+        break;
+    case ConsumerSpec::Kind::Fifo: {
+        struct stat st;
+        if (::stat(spec.target.c_str(), &st) != 0) {
+            if (::mkfifo(spec.target.c_str(), 0600) != 0) {
+                error = errnoText(spec.target.c_str());
+                return false;
+            }
+            createdFifo = true;
+        } else if (!S_ISFIFO(st.st_mode)) {
+            error = spec.target + " exists and is not a named pipe";
+            return false;
+        }
+        fd = openFifo(spec.target, stop, error);
+        break;
+    }
+    case ConsumerSpec::Kind::Socket:
+        fd = connectSocket(spec.target, error);
+        break;
+    }
+    if (fd < 0) {
+        abort();
+        return false;
+    }
+    tuneStreamFd(fd); ///< a full chunk fits in the pipe
+    if (!setNonBlocking(fd)) {
+        error = errnoText("fcntl");
+        abort();
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Writes all `n` bytes, waiting in poll() while the consumer's buffer is full.
+ */
+bool PlaintextConsumer::writeSome(const unsigned char* data, size_t n, const std::function<bool()>& stop) {
+    while (n > 0) {
+        const ssize_t w = ::write(fd, data, n);
+        if (w > 0) {
+            data += w;
+            n -= static_cast<size_t>(w);
+            bytes += static_cast<uint64_t>(w);
+            continue;
+        }
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            lastError = errno == EPIPE || errno == ECONNRESET ? "consumer stopped reading" : errnoText("write");
+            return false;
+        }
+        if (stop && stop()) {
+            lastError = "cancelled";
+            return false;
+        }
+        pollfd pfd{ fd, POLLOUT, 0 };
+        ::poll(&pfd, 1, kWaitSliceMs);
+    }
+    return true;
+}
+
+
+ByteWriter PlaintextConsumer::writer(std::function<bool()> stop) {
+    return [this, stop](const unsigned char* data, size_t n) {
+        return fd >= 0 && writeSome(data, n, stop);
+    };
+}
+
+
+void PlaintextConsumer::release() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    if (createdFifo) {
+        ::unlink(spec.target.c_str());
+        createdFifo = false;
+    }
+}
+
+
+/**
+ * @brief Signals end of data and collects the command's exit status.
+ *
+ * @param error Receives the reason if the command failed.
+ * @return true if the stream was closed cleanly (and the command exited 0).
+ */
+bool PlaintextConsumer::finish(std::string& error) {
+    if (fd >= 0 && spec.kind == ConsumerSpec::Kind::Socket) ::shutdown(fd, SHUT_WR);
+    release();
+    if (child < 0) return true;
+    int status = 0;
+    pid_t r;
+    while ((r = ::waitpid(child, &status, 0)) < 0 && errno == EINTR) {}
+    child = -1;
+    if (r < 0) {
+        error = errnoText("waitpid");
+        return false;
+    }
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) return true;
+    error = WIFEXITED(status) ? "command exited with status " + std::to_string(WEXITSTATUS(status))
+                              : "command killed by signal " + std::to_string(WTERMSIG(status));
+    return false;
+}
+
+
+/**
+ * @brief Cancels the transfer: stops the command, resets a socket and reaps the child.
+ *
+ * The command's process group gets SIGTERM and kAbortGraceMs to exit; one
+ * that ignores it is killed with SIGKILL, so a cancel never hangs.
+ */
+void PlaintextConsumer::abort() {
+    if (child > 0) ::kill(-child, SIGTERM); ///< whole pipeline, before closing stdin: EOF must not look like success
+    if (fd >= 0 && spec.kind == ConsumerSpec::Kind::Socket) {
+        linger hard{ 1, 0 };
+        ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &hard, sizeof(hard)); ///< close() sends RST
+    }
+    release();
+    if (child > 0) {
+        bool reaped = false; ///< exited, or cannot be waited for (ECHILD)
+        for (int waited = 0; !reaped && waited < kAbortGraceMs; waited += kReapPollMs) {
+            const pid_t r = ::waitpid(child, nullptr, WNOHANG);
+            reaped = r > 0 || (r < 0 && errno != EINTR);
+            if (!reaped) ::poll(nullptr, 0, kReapPollMs);
+        }
+        if (!reaped) { ///< still running after the grace period
+            ::kill(-child, SIGKILL);
+            while (::waitpid(child, nullptr, 0) < 0 && errno == EINTR) {}
+        }
+        child = -1;
+    }
+}
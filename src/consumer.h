@@ -0,0 +1,68 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include "fdio.h"      // ByteWriter
+
+#include <cstdint>     // byte counts
+#include <functional>  // stop predicate
+#include <string>
+
+#include <sys/types.h> // pid_t
+
+// Destination for decrypted data that is not a file, so a restore can feed
+// another program without plaintext ever touching the disk:
+//
+//   exec:CMD    CMD is run with /bin/sh -c and reads the plaintext on stdin
+//   fifo:PATH   named pipe; created (and removed afterwards) if missing
+//   unix:PATH   Unix-domain stream socket to connect to
+//
+// Writes block while the consumer is not reading (pipe / socket buffers are
+// the only queue), so decryption runs at the consumer's pace. Once a
+// consumer is opened SIGPIPE is ignored process-wide; a consumer that exits
+// early then shows up as a write error instead of killing the process.
+
+struct ConsumerSpec {
+    enum class Kind { Command, Fifo, Socket };
+    Kind kind = Kind::Command;
+    std::string target;        // command line or path
+};
+
+bool parseConsumerSpec(const std::string& text, ConsumerSpec& spec, std::string& error);
+std::string describeConsumer(const ConsumerSpec& spec); // "exec: CMD", "fifo: PATH", ...
+
+class PlaintextConsumer {
+public:
+    PlaintextConsumer() = default;
+    ~PlaintextConsumer();      // abort() unless finish() or abort() ran
+    PlaintextConsumer(const PlaintextConsumer&) = delete;
+    PlaintextConsumer& operator=(const PlaintextConsumer&) = delete;
+
+    // Starts the command, or connects. A named pipe waits for a reader;
+    // `stop` (polled every 100 ms) gives up waiting.
+    bool open(const ConsumerSpec& target, std::string& error, std::function<bool()> stop = nullptr);
+
+    // Writer that blocks while the consumer's buffer is full, waking every
+    // 200 ms to ask `stop` whether to give up (cancelled jobs).
+    ByteWriter writer(std::function<bool()> stop = nullptr);
+    uint64_t written() const { return bytes; }
+    const std::string& writeError() const { return lastError; }
+
+    // End of data: closes the stream and, for a command, waits for it and
+    // fails unless it exits with status 0.
+    bool finish(std::string& error);
+    // Failed or cancelled stream: a command (its whole process group, so
+    // every stage of a pipeline) gets SIGTERM before its stdin is
+    // closed and a socket is reset, so neither mistakes the partial data for
+    // a complete stream. A named pipe reader just sees end of file.
+    void abort();
+
+private:
+    bool writeSome(const unsigned char* data, size_t n, const std::function<bool()>& stop);
+    void release();            // closes the descriptor, removes a fifo we created
+
+    ConsumerSpec spec;
+    int fd = -1;
+    pid_t child = -1;
+    bool createdFifo = false;
+    uint64_t bytes = 0;
+    std::string lastError;
+};
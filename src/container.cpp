@@ -0,0 +1,662 @@
+#include "container.h"
+#include "streamhash.h" // fused plaintext / container digests
+#include "numa.h"       // node-local record buffers
+
+#include <algorithm> // min
+#include <cstring>  // memcpy, memcmp
+#include <vector>   // zero filler
+
+// Crypto++ includes
+#include <cryptopp/aes.h>    // AES block cipher
+#include <cryptopp/gcm.h>    // GCM authenticated mode
+#include <cryptopp/hmac.h>   // per-file key derivation
+#include <cryptopp/sha.h>    // SHA-256
+#include <cryptopp/osrng.h>  // salt generation
+
+using namespace CryptoPP;
+
+static const byte kMagic[4] = { 'C', 'Q', 'A', 'C' };
+static const char kFileKeyLabel[] = "CQAC/v1 file key";
+static const size_t kNonceBytes = 12;
+
+// ---------------- Helper functions ------------------
+
+static void putBe32(byte* p, uint32_t v) {
+    p[0] = static_cast<byte>(v >> 24);
+    p[1] = static_cast<byte>(v >> 16);
+    p[2] = static_cast<byte>(v >> 8);
+    p[3] = static_cast<byte>(v);
+}
+
+static uint32_t getBe32(const byte* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+static void putBe64(byte* p, uint64_t v) {
+    putBe32(p, static_cast<uint32_t>(v >> 32));
+    putBe32(p + 4, static_cast<uint32_t>(v));
+}
+
+static uint64_t getBe64(const byte* p) {
+    return (uint64_t(getBe32(p)) << 32) | getBe32(p + 4);
+}
+
+/**
+ * @brief Builds the 12-byte GCM nonce for a record: 0^8 || index (BE).
+ */
+static void recordNonce(uint32_t index, byte nonce[kNonceBytes]) {
+    std::memset(nonce, 0, kNonceBytes);
+    putBe32(nonce + 8, index);
+}
+
+
+// ---------------- ContainerHeader ------------------
+
+/**
+ * @brief Writes the 32-byte on-disk header.
+ */
+void ContainerHeader::serialize(byte out[kContainerHeaderBytes]) const {
+    std::memset(out, 0, kContainerHeaderBytes);
+    std::memcpy(out, kMagic, sizeof(kMagic));
+    out[4] = version;
+    out[5] = flags;
+    putBe32(out + 8, chunkSize);
+    std::memcpy(out + 12, salt, kContainerSaltBytes);
+}
+
+
+/**
+ * @brief Parses and validates the 32-byte on-disk header.
+ *
+ * @return false if the magic, version or chunk size is not supported.
+ */
+bool ContainerHeader::parse(const byte in[kContainerHeaderBytes]) {
+    if (std::memcmp(in, kMagic, sizeof(kMagic)) != 0) return false;
+    version = in[4];
+    flags = in[5];
+    chunkSize = getBe32(in + 8);
+    std::memcpy(salt, in + 12, kContainerSaltBytes);
+    return (version == kContainerVersion || version == kContainerVersionSparse)
+        && chunkSize > 0 && chunkSize <= kMaxChunkBytes;
+}
+
+
+// ---------------- ContainerCodec ------------------
+
+/**
+ * @brief Derives the per-file key from the master key and the header salt.
+ *
+ * @param masterKey The user's symmetric key (16, 24 or 32 bytes).
+ * @param header Container header (its serialized form is bound into every record).
+ */
+ContainerCodec::ContainerCodec(const SecByteBlock& masterKey, const ContainerHeader& header)
+    : hdr(header), fileKey(masterKey.size() < 32 ? masterKey.size() : 32) {
+    hdr.serialize(hdrBytes);
+
+    HMAC<SHA256> kdf(masterKey, masterKey.size());
+    kdf.Update(reinterpret_cast<const byte*>(kFileKeyLabel), sizeof(kFileKeyLabel) - 1);
+    kdf.Update(hdr.salt, kContainerSaltBytes);
+    SecByteBlock prk(kdf.DigestSize());
+    kdf.Final(prk);
+    std::memcpy(fileKey, prk, fileKey.size()); ///< AES-128/192 keys use a prefix of the 32-byte output
+}
+
+
+/**
+ * @brief Encrypts and authenticates one record.
+ *
+ * @param index Record position in the container (part of the nonce).
+ * @param type Record type, with kRecordFinal for the last record.
+ * @param plain Payload.
+ * @param n Payload length (at most the header's chunk size).
+ * @param out Receives record header || ciphertext || tag.
+ */
+void ContainerCodec::seal(uint32_t index, uint8_t type, const byte* plain, size_t n, byte* out) const {
+    byte aad[kContainerHeaderBytes + kRecordHeaderBytes];
+    std::memcpy(aad, hdrBytes, kContainerHeaderBytes);
+    byte* rh = aad + kContainerHeaderBytes;
+    std::memset(rh, 0, kRecordHeaderBytes);
+    rh[0] = type;
+    putBe32(rh + 4, static_cast<uint32_t>(n));
+
+    byte nonce[kNonceBytes];
+    recordNonce(index, nonce);
+
+    GCM<AES>::Encryption enc;
+    enc.SetKeyWithIV(fileKey, fileKey.size(), nonce, kNonceBytes);
+    std::memcpy(out, rh, kRecordHeaderBytes);
+    enc.EncryptAndAuthenticate(out + kRecordHeaderBytes, out + kRecordHeaderBytes + n, kRecordTagBytes,
+                               nonce, kNonceBytes, aad, sizeof(aad), plain, n);
+}
+
+
+/**
+ * @brief Authenticates and decrypts one record.
+ *
+ * @param index Expected record position (a moved record fails authentication).
+ * @param record Record header || ciphertext || tag.
+ * @param recordLen Total record length.
+ * @param plain Receives the payload (length taken from the record header).
+ * @return false if the record is malformed or fails authentication.
+ */
+bool ContainerCodec::open(uint32_t index, const byte* record, size_t recordLen, byte* plain) const {
+    if (recordLen < kRecordHeaderBytes + kRecordTagBytes) return false;
+    size_t n = getBe32(record + 4);
+    if (recordLen != containerRecordBytes(n)) return false;
+
+    byte aad[kContainerHeaderBytes + kRecordHeaderBytes];
+    std::memcpy(aad, hdrBytes, kContainerHeaderBytes);
+    std::memcpy(aad + kContainerHeaderBytes, record, kRecordHeaderBytes);
+
+    byte nonce[kNonceBytes];
+    recordNonce(index, nonce);
+
+    GCM<AES>::Decryption dec;
+    dec.SetKeyWithIV(fileKey, fileKey.size(), nonce, kNonceBytes);
+    return dec.DecryptAndVerify(plain, record + kRecordHeaderBytes + n, kRecordTagBytes,
+                                nonce, kNonceBytes, aad, sizeof(aad),
+                                record + kRecordHeaderBytes, n);
+}
+
+
+// ---------------- Streaming ------------------
+
+/**
+ * @brief Human-readable text for a container status.
+ */
+const char* describeContainerStatus(ContainerReport::Status status) {
+    switch (status) {
+    case ContainerReport::Status::Ok:           return "ok";
+    case ContainerReport::Status::IoError:      return "I/O error";
+    case ContainerReport::Status::BadHeader:    return "not a CQAC container (or unsupported version)";
+    case ContainerReport::Status::Corrupt:      return "authentication failed (corrupt or wrong key)";
+    case ContainerReport::Status::Truncated:    return "truncated (final record missing)";
+    case ContainerReport::Status::TrailingData: return "unexpected data after final record";
+    }
+    return "unknown";
+}
+
+
+namespace {
+
+// One record's worth of input: file data, or a run of zeros.
+struct Piece {
+    uint8_t type = kRecordData;
+    byte* data = nullptr; // chunkSize bytes of scratch, owned by sealRecords
+    size_t len = 0;       // kRecordData: bytes in data
+    uint64_t zeros = 0; // kRecordZero: length of the run
+    bool end = false;   // input exhausted, nothing in this piece
+};
+
+// Cuts the input into record payloads. Without sparse options every piece
+// is a full chunk of data (the last one may be short).
+class PieceSource {
+public:
+    PieceSource(const ByteReader& in, uint32_t chunkSize, const SparseInput* sparse)
+        : in(in), chunkSize(chunkSize), sparse(sparse) {}
+
+    bool next(Piece& p);
+
+private:
+    const ByteReader& in;
+    const uint32_t chunkSize;
+    const SparseInput* sparse;
+    uint64_t offset = 0;
+    uint64_t dataLeft = 0; ///< data bytes left in the current extent (hole probing only)
+    bool eof = false;
+};
+
+
+/**
+ * @brief Produces the next piece of input.
+ *
+ * @return false on a read error.
+ */
+bool PieceSource::next(Piece& p) {
+    p.type = kRecordData;
+    p.len = 0;
+    p.zeros = 0;
+    p.end = eof;
+    if (eof) return true;
+
+    size_t want = chunkSize;
+    if (sparse && sparse->holes) {
+        if (dataLeft == 0) {
+            FileExtent ext = sparse->holes(offset);
+            dataLeft = ext.dataBytes;
+            if (ext.holeBytes > 0) {
+                p.type = kRecordZero;
+                p.zeros = ext.holeBytes;
+                offset += ext.holeBytes;
+                eof = (dataLeft == 0);
+                return true;
+            }
+            if (dataLeft == 0) {
+                eof = p.end = true;
+                return true;
+            }
+        }
+        if (dataLeft < want) want = static_cast<size_t>(dataLeft);
+    }
+
+    ssize_t n = in(p.data, want);
+    if (n < 0) return false;
+    const size_t got = static_cast<size_t>(n);
+    offset += got;
+    if (sparse && sparse->holes) dataLeft -= got;
+    if (got < want) eof = true; ///< readers only return short at EOF
+    if (got == 0) {
+        p.end = true;
+        return true;
+    }
+    p.len = got;
+    if (sparse && sparse->zeroChunks
+        && p.data[0] == 0 && std::memcmp(p.data, p.data + 1, got - 1) == 0) {
+        p.type = kRecordZero;
+        p.zeros = got;
+    }
+    return true;
+}
+
+} // namespace
+
+
+/**
+ * @brief Seals the input into records firstIndex, firstIndex+1, ... until EOF.
+ *
+ * Reads one piece ahead so the last record can be flagged final without
+ * knowing the input size up front (works for pipes). Adjacent zero runs
+ * are merged into one extent. The two pieces and the record live in
+ * node-local thread scratch buffers.
+ */
+static bool sealRecords(const ByteReader& in, const ByteWriter& out, const ContainerCodec& codec,
+                        uint32_t firstIndex, std::string& error, const RecordHook& hook,
+                        const SparseInput* sparse = nullptr, HashTransformation* plainHash = nullptr) {
+    const uint32_t chunkSize = codec.header().chunkSize;
+    PieceSource source(in, chunkSize, sparse);
+    ScratchBuffer curBuf(chunkSize), nextBuf(chunkSize);
+    ScratchBuffer record(containerRecordBytes(chunkSize > kZeroExtentBytes ? chunkSize : kZeroExtentBytes));
+    Piece cur, next;
+    cur.data = curBuf.data();
+    next.data = nextBuf.data();
+    if (!source.next(cur)) {
+        error = "read failed";
+        return false;
+    }
+
+    for (uint32_t index = firstIndex;; ++index) {
+        next.end = true;
+        while (!cur.end) {
+            if (!source.next(next)) {
+                error = "read failed";
+                return false;
+            }
+            if (next.end || cur.type != kRecordZero || next.type != kRecordZero) break;
+            cur.zeros += next.zeros;
+        }
+        const bool last = next.end;
+        if (index == UINT32_MAX && !last) {
+            error = "input too large for this chunk size";
+            return false;
+        }
+
+        const byte* payload = cur.data;
+        size_t n = cur.len;
+        byte run[kZeroExtentBytes];
+        if (cur.type == kRecordZero) {
+            putBe64(run, cur.zeros);
+            payload = run;
+            n = sizeof(run);
+            if (plainHash) hashZeros(*plainHash, cur.zeros);
+        } else if (plainHash) {
+            plainHash->Update(payload, n);
+        }
+        codec.seal(index, static_cast<uint8_t>(cur.type | (last ? kRecordFinal : 0)), payload, n, record.data());
+        size_t recLen = containerRecordBytes(n);
+        if (!out(record.data(), recLen)) {
+            error = "write failed";
+            return false;
+        }
+        if (hook) hook(recLen);
+        if (last) return true;
+
+        std::swap(cur, next);
+    }
+}
+
+
+/**
+ * @brief Encrypts a stream into a container.
+ *
+ * @param in Plaintext source.
+ * @param out Container destination.
+ * @param key Master key.
+ * @param chunkSize Plaintext bytes per record (1 .. kMaxChunkBytes).
+ * @param error Receives a description on failure.
+ * @param hook Optional callback after each written record.
+ * @param sparse Optional hole map / zero detection; selects container version 2.
+ * @param digests Optional plaintext / container hashes, updated in the same pass.
+ * @return true on success.
+ */
+bool encryptContainer(const ByteReader& in, const ByteWriter& out, const SecByteBlock& key,
+                      uint32_t chunkSize, std::string& error, const RecordHook& hook,
+                      const SparseInput* sparse, const StreamDigests* digests) {
+    if (chunkSize == 0 || chunkSize > kMaxChunkBytes) {
+        error = "invalid chunk size";
+        return false;
+    }
+    ContainerHeader hdr;
+    hdr.version = sparse ? kContainerVersionSparse : kContainerVersion;
+    hdr.chunkSize = chunkSize;
+    AutoSeededRandomPool rng;
+    rng.GenerateBlock(hdr.salt, kContainerSaltBytes);
+    ContainerCodec codec(key, hdr);
+
+    const ByteWriter sink = hashingWriter(out, digests ? digests->cipher : nullptr);
+    if (!sink(codec.headerBytes(), kContainerHeaderBytes)) {
+        error = "write failed";
+        return false;
+    }
+    return sealRecords(in, sink, codec, 0, error, hook, sparse, digests ? digests->plain : nullptr);
+}
+
+
+/**
+ * @brief Appends the remaining records of a partially written container.
+ *
+ * @param in Plaintext source, positioned at the first unsealed chunk.
+ * @param out Destination, positioned after the last complete record.
+ * @param key Master key.
+ * @param header Header already written at the start of the container.
+ * @param firstIndex Index of the first record to write.
+ * @param error Receives a description on failure.
+ * @param hook Optional callback after each written record.
+ * @return true on success.
+ */
+bool resumeContainer(const ByteReader& in, const ByteWriter& out, const SecByteBlock& key,
+                     const ContainerHeader& header, uint32_t firstIndex, std::string& error,
+                     const RecordHook& hook) {
+    if (header.chunkSize == 0 || header.chunkSize > kMaxChunkBytes) {
+        error = "invalid chunk size";
+        return false;
+    }
+    if (header.version != kContainerVersion) { ///< extents break the records * chunkSize arithmetic
+        error = "only version 1 containers can be resumed";
+        return false;
+    }
+    ContainerCodec codec(key, header);
+    return sealRecords(in, out, codec, firstIndex, error, hook);
+}
+
+
+/**
+ * @brief Authenticates (and optionally decrypts) a container stream.
+ *
+ * Plaintext of a record is only written after that record authenticates;
+ * on failure, earlier records may already have been written. Record and
+ * plaintext live in node-local thread scratch buffers.
+ *
+ * @param in Container source.
+ * @param out Plaintext destination, or empty to verify only.
+ * @param key Master key.
+ * @param hook Optional callback after each authenticated record.
+ * @param holes Optional sink for zero extents; without it they are written to out.
+ * @return Report with the status and how far reading got.
+ */
+ContainerReport readContainer(const ByteReader& in, const ByteWriter& out, const SecByteBlock& key,
+                              const RecordHook& hook, const HoleWriter& holes) {
+    ContainerReport rep;
+
+    byte hb[kContainerHeaderBytes];
+    ssize_t n = in(hb, sizeof(hb));
+    if (n < 0) { rep.status = ContainerReport::Status::IoError; return rep; }
+    ContainerHeader hdr;
+    if (static_cast<size_t>(n) != sizeof(hb) || !hdr.parse(hb)) {
+        rep.status = ContainerReport::Status::BadHeader;
+        return rep;
+    }
+    ContainerCodec codec(key, hdr);
+
+    const size_t maxPayload = hdr.chunkSize > kZeroExtentBytes ? hdr.chunkSize : kZeroExtentBytes;
+    ScratchBuffer record(containerRecordBytes(maxPayload));
+    ScratchBuffer plain(maxPayload);
+    std::vector<byte> zeros; ///< filler for extents when holes cannot be skipped
+    for (uint32_t index = 0;; ++index) {
+        rep.badRecord = index;
+        n = in(record.data(), kRecordHeaderBytes);
+        if (n < 0) { rep.status = ContainerReport::Status::IoError; return rep; }
+        if (static_cast<size_t>(n) != kRecordHeaderBytes) {
+            rep.status = ContainerReport::Status::Truncated;
+            return rep;
+        }
+
+        const uint8_t type = record.data()[0];
+        const size_t len = getBe32(record.data() + 4);
+        const uint8_t base = type & ~kRecordFinal;
+        const bool isZero = base == kRecordZero && hdr.version == kContainerVersionSparse;
+        if (isZero ? len != kZeroExtentBytes : (base != kRecordData || len > hdr.chunkSize)) {
+            rep.status = ContainerReport::Status::Corrupt;
+            return rep;
+        }
+        const size_t body = len + kRecordTagBytes;
+        n = in(record.data() + kRecordHeaderBytes, body);
+        if (n < 0) { rep.status = ContainerReport::Status::IoError; return rep; }
+        if (static_cast<size_t>(n) != body) {
+            rep.status = ContainerReport::Status::Truncated;
+            return rep;
+        }
+
+        if (!codec.open(index, record.data(), containerRecordBytes(len), plain.data())) {
+            rep.status = ContainerReport::Status::Corrupt;
+            return rep;
+        }
+        uint64_t produced = len;
+        bool written = true;
+        if (isZero) {
+            produced = getBe64(plain.data());
+            if (holes && out) {
+                written = holes(produced);
+            } else if (out) {
+                if (zeros.empty()) zeros.resize(hdr.chunkSize);
+                for (uint64_t left = produced; left > 0 && written;) {
+                    size_t step = static_cast<size_t>(left < zeros.size() ? left : zeros.size());
+                    written = out(zeros.data(), step);
+                    left -= step;
+                }
+            }
+        } else if (out) {
+            written = out(plain.data(), len);
+        }
+        if (!written) {
+            rep.status = ContainerReport::Status::IoError;
+            return rep;
+        }
+        ++rep.records;
+        rep.plainBytes += produced;
+        if (hook) hook(containerRecordBytes(len));
+
+        if (type & kRecordFinal) {
+            byte extra;
+            n = in(&extra, 1);
+            if (n < 0) rep.status = ContainerReport::Status::IoError;
+            else if (n > 0) rep.status = ContainerReport::Status::TrailingData;
+            return rep;
+        }
+        if (index == UINT32_MAX) {
+            rep.status = ContainerReport::Status::Corrupt;
+            return rep;
+        }
+    }
+}
+
+
+// ---------------- Push-style ------------------
+
+/**
+ * @brief Starts a container with a fresh salt; nothing is written until the first update().
+ */
+ContainerSealer::ContainerSealer(const SecByteBlock& key, uint32_t chunkSize)
+    : codec(key, [chunkSize] {
+          ContainerHeader hdr;
+          hdr.chunkSize = chunkSize;
+          AutoSeededRandomPool rng;
+          rng.GenerateBlock(hdr.salt, kContainerSaltBytes);
+          return hdr;
+      }()),
+      record(containerRecordBytes(chunkSize)) {
+    pending.reserve(chunkSize);
+}
+
+
+bool ContainerSealer::seal(const byte* data, size_t n, bool last, const ByteWriter& out, std::string& error) {
+    if (!headerWritten) {
+        if (!out(codec.headerBytes(), kContainerHeaderBytes)) {
+            error = "write failed";
+            return false;
+        }
+        headerWritten = true;
+    }
+    if (index == UINT32_MAX && !last) {
+        error = "input too large for this chunk size";
+        return false;
+    }
+    codec.seal(index++, static_cast<uint8_t>(kRecordData | (last ? kRecordFinal : 0)), data, n, record.data());
+    if (!out(record.data(), containerRecordBytes(n))) {
+        error = "write failed";
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Adds plaintext; every full chunk followed by more data is sealed right away.
+ *
+ * A full chunk is held back until more data (or final()) shows whether it is the last one.
+ */
+bool ContainerSealer::update(const byte* data, size_t n, const ByteWriter& out, std::string& error) {
+    if (finished) {
+        error = "update after final";
+        return false;
+    }
+    const size_t chunkSize = codec.header().chunkSize;
+    while (n > 0) {
+        if (pending.size() == chunkSize) {
+            if (!seal(pending.data(), pending.size(), false, out, error)) return false;
+            pending.clear();
+        }
+        if (pending.empty() && n > chunkSize) { ///< whole chunks straight from the caller's buffer
+            if (!seal(data, chunkSize, false, out, error)) return false;
+            data += chunkSize;
+            n -= chunkSize;
+            continue;
+        }
+        const size_t take = std::min(n, chunkSize - pending.size());
+        pending.insert(pending.end(), data, data + take);
+        data += take;
+        n -= take;
+    }
+    return true;
+}
+
+
+bool ContainerSealer::final(const ByteWriter& out, std::string& error) {
+    if (finished) {
+        error = "final called twice";
+        return false;
+    }
+    finished = true;
+    return seal(pending.data(), pending.size(), true, out, error);
+}
+
+
+ContainerOpener::ContainerOpener(const SecByteBlock& key) : key(key) {}
+
+
+/**
+ * @brief Feeds container bytes; completes and authenticates records as they fill up.
+ */
+ContainerReport::Status ContainerOpener::update(const byte* data, size_t n, const ByteWriter& out) {
+    using Status = ContainerReport::Status;
+    if (rep.status != Status::Ok) return rep.status;
+
+    while (n > 0) {
+        if (done) {
+            rep.status = Status::TrailingData;
+            return rep.status;
+        }
+        // bytes needed for the current unit: header, record header, then the record body
+        size_t need = kContainerHeaderBytes;
+        if (codec) {
+            need = kRecordHeaderBytes;
+            if (buf.size() >= kRecordHeaderBytes) need = containerRecordBytes(getBe32(buf.data() + 4));
+        }
+        const size_t take = std::min(n, need - buf.size());
+        buf.insert(buf.end(), data, data + take);
+        data += take;
+        n -= take;
+        if (buf.size() < need) continue;
+
+        if (!codec) {
+            ContainerHeader hdr;
+            if (!hdr.parse(buf.data())) {
+                rep.status = Status::BadHeader;
+                return rep.status;
+            }
+            codec.reset(new ContainerCodec(key, hdr));
+            buf.clear();
+            continue;
+        }
+        if (need == kRecordHeaderBytes) {
+            const size_t len = getBe32(buf.data() + 4);
+            const uint8_t base = buf[0] & ~kRecordFinal;
+            const bool isZero = base == kRecordZero && codec->header().version == kContainerVersionSparse;
+            if (isZero ? len != kZeroExtentBytes : (base != kRecordData || len > codec->header().chunkSize)) {
+                rep.badRecord = rep.records;
+                rep.status = Status::Corrupt;
+                return rep.status;
+            }
+            continue; ///< now wait for the body
+        }
+
+        const size_t len = getBe32(buf.data() + 4);
+        plain.resize(std::max<size_t>(len, kZeroExtentBytes));
+        rep.badRecord = rep.records;
+        if (rep.records > UINT32_MAX
+            || !codec->open(static_cast<uint32_t>(rep.records), buf.data(), buf.size(), plain.data())) {
+            rep.status = Status::Corrupt;
+            return rep.status;
+        }
+        uint64_t produced = len;
+        bool written = true;
+        if ((buf[0] & ~kRecordFinal) == kRecordZero) { ///< no hole sink here: extents come out as zeros
+            produced = getBe64(plain.data());
+            plain.assign(codec->header().chunkSize, 0);
+            for (uint64_t left = produced; out && left > 0 && written;) {
+                size_t step = static_cast<size_t>(std::min<uint64_t>(left, plain.size()));
+                written = out(plain.data(), step);
+                left -= step;
+            }
+        } else if (out) {
+            written = out(plain.data(), len);
+        }
+        if (!written) {
+            rep.status = Status::IoError;
+            return rep.status;
+        }
+        ++rep.records;
+        rep.plainBytes += produced;
+        done = (buf[0] & kRecordFinal) != 0;
+        buf.clear();
+    }
+    return rep.status;
+}
+
+
+ContainerReport::Status ContainerOpener::final() {
+    if (rep.status == ContainerReport::Status::Ok && !done) {
+        rep.badRecord = rep.records;
+        rep.status = ContainerReport::Status::Truncated;
+    }
+    return rep.status;
+}
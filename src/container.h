@@ -0,0 +1,169 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include "fdio.h"     // ByteReader / ByteWriter
+
+#include <cstdint>    // fixed-width header fields
+#include <functional> // per-record hook
+#include <memory>     // ContainerOpener codec
+#include <string>     // error text
+#include <vector>     // push-style buffers
+
+#include <cryptopp/secblock.h> // SecByteBlock keys
+
+// Chunked authenticated container (.cqac).
+//
+//   file header  32 bytes: "CQAC" | version u8 | flags u8 | reserved u16 |
+//                          chunk size u32 BE | salt[16] | reserved[4]
+//   record        8 bytes: type u8 | reserved[3] | plaintext length u32 BE
+//                 then ciphertext (length bytes) and a 16-byte GCM tag
+//
+// Every record is sealed on its own with AES-GCM under a per-file key
+// HMAC-SHA256(master key, "CQAC/v1 file key" || salt); the nonce is
+// 0^8 || record index (u32 BE) and the AAD is file header || record header.
+// The last record carries kRecordFinal, so truncation, reordering and
+// appended data are all detected, and any record can be checked (or
+// processed in parallel) without touching the others.
+//
+// Version 2 containers may also hold zero extents (kRecordZero): the sealed
+// payload is a u64 BE byte count standing for that many zero bytes, written
+// for holes in sparse inputs (SEEK_DATA / SEEK_HOLE) and, optionally, for
+// all-zero chunks. Extents are sealed and indexed like data records, so they
+// are authenticated the same way; only the data itself is ever encrypted.
+
+constexpr size_t kContainerHeaderBytes = 32;
+constexpr size_t kRecordHeaderBytes = 8;
+constexpr size_t kRecordTagBytes = 16;
+constexpr size_t kContainerSaltBytes = 16;
+constexpr uint32_t kDefaultChunkBytes = 1u << 20;
+constexpr uint32_t kMaxChunkBytes = 64u << 20;
+constexpr size_t kZeroExtentBytes = 8; // payload of a kRecordZero record
+
+constexpr uint8_t kContainerVersion = 1;       // data records only
+constexpr uint8_t kContainerVersionSparse = 2; // may also contain zero extents
+
+enum RecordType : uint8_t {
+    kRecordData  = 0x01, // payload is file data
+    kRecordZero  = 0x02, // payload is a u64 BE count of zero bytes (version 2)
+    kRecordFinal = 0x80  // flag: last record of the container
+};
+
+struct ContainerHeader {
+    uint8_t version = kContainerVersion;
+    uint8_t flags = 0;
+    uint32_t chunkSize = kDefaultChunkBytes;
+    CryptoPP::byte salt[kContainerSaltBytes] = {};
+
+    void serialize(CryptoPP::byte out[kContainerHeaderBytes]) const;
+    bool parse(const CryptoPP::byte in[kContainerHeaderBytes]); // false if not a supported container
+};
+
+inline size_t containerRecordBytes(size_t payloadLen) {
+    return kRecordHeaderBytes + payloadLen + kRecordTagBytes;
+}
+
+// Seals and opens individual records of one container. All methods are const
+// and keep no per-call state, so one codec can be shared by worker threads.
+class ContainerCodec {
+public:
+    ContainerCodec(const CryptoPP::SecByteBlock& masterKey, const ContainerHeader& header);
+
+    const ContainerHeader& header() const { return hdr; }
+    const CryptoPP::byte* headerBytes() const { return hdrBytes; }
+
+    // `out` must hold containerRecordBytes(n) bytes.
+    void seal(uint32_t index, uint8_t type, const CryptoPP::byte* plain, size_t n, CryptoPP::byte* out) const;
+    // `record` is header || ciphertext || tag; `plain` receives the payload. False if forged/corrupt.
+    bool open(uint32_t index, const CryptoPP::byte* record, size_t recordLen, CryptoPP::byte* plain) const;
+
+private:
+    ContainerHeader hdr;
+    CryptoPP::byte hdrBytes[kContainerHeaderBytes];
+    CryptoPP::SecByteBlock fileKey;
+};
+
+// Outcome of reading a container (decrypt or verify-only).
+struct ContainerReport {
+    enum class Status { Ok, IoError, BadHeader, Corrupt, Truncated, TrailingData };
+
+    Status status = Status::Ok;
+    uint64_t records = 0;    // records authenticated successfully
+    uint64_t plainBytes = 0; // plaintext bytes in those records
+    uint64_t badRecord = 0;  // index of the failing record (Corrupt / Truncated)
+};
+
+const char* describeContainerStatus(ContainerReport::Status status);
+
+// Called after each record with the number of container bytes it occupied
+// (used for progress and rate limiting).
+using RecordHook = std::function<void(size_t bytes)>;
+
+// Sparse encryption: holes reported by `holes` (see fdHoleProbe()) and,
+// with zeroChunks, data chunks that are entirely zero become zero extents.
+// Holes are skipped without being read, so only the data costs I/O and AES.
+struct SparseInput {
+    HoleProbe holes;          // may be empty (e.g. for pipes)
+    bool zeroChunks = false;  // also scan data chunks for zeros
+};
+
+struct StreamDigests; // streamhash.h
+
+// With `sparse`, a version 2 container is written (older readers reject it).
+// `digests` are updated with the plaintext and the container bytes as they pass.
+bool encryptContainer(const ByteReader& in, const ByteWriter& out, const CryptoPP::SecByteBlock& key,
+                      uint32_t chunkSize, std::string& error, const RecordHook& hook = nullptr,
+                      const SparseInput* sparse = nullptr, const StreamDigests* digests = nullptr);
+
+// Continues a version 1 container whose records 0 .. firstIndex-1 are already
+// written (e.g. after an interrupted batch run): `in` must be positioned at
+// firstIndex * header.chunkSize and `out` appends after those records. The
+// header (salt) must be the one already at the start of the output.
+bool resumeContainer(const ByteReader& in, const ByteWriter& out, const CryptoPP::SecByteBlock& key,
+                     const ContainerHeader& header, uint32_t firstIndex, std::string& error,
+                     const RecordHook& hook = nullptr);
+
+// Decrypts when `out` is set; with an empty `out` only authenticates every
+// record, so no plaintext is ever produced (scrubbing). Zero extents are
+// passed to `holes` when set (see fdHoleWriter()), otherwise written to `out`
+// as zeros.
+ContainerReport readContainer(const ByteReader& in, const ByteWriter& out, const CryptoPP::SecByteBlock& key,
+                              const RecordHook& hook = nullptr, const HoleWriter& holes = nullptr);
+
+// Push-style counterparts of encryptContainer() / readContainer(), for
+// callers that receive data in pieces (C API, network handlers). Output is
+// produced through `out` as soon as a record is complete.
+class ContainerSealer {
+public:
+    ContainerSealer(const CryptoPP::SecByteBlock& key, uint32_t chunkSize); // chunkSize 1 .. kMaxChunkBytes
+
+    bool update(const CryptoPP::byte* data, size_t n, const ByteWriter& out, std::string& error);
+    bool final(const ByteWriter& out, std::string& error); // seals the last record
+
+private:
+    bool seal(const CryptoPP::byte* data, size_t n, bool last, const ByteWriter& out, std::string& error);
+
+    ContainerCodec codec;
+    std::vector<CryptoPP::byte> pending; ///< at most one chunk held back (may be the last)
+    std::vector<CryptoPP::byte> record;
+    uint32_t index = 0;
+    bool headerWritten = false;
+    bool finished = false;
+};
+
+class ContainerOpener {
+public:
+    explicit ContainerOpener(const CryptoPP::SecByteBlock& key);
+
+    // Plaintext of each record goes to `out` once it authenticates. Returns
+    // Ok while the stream is consistent so far.
+    ContainerReport::Status update(const CryptoPP::byte* data, size_t n, const ByteWriter& out);
+    ContainerReport::Status final(); // Truncated unless the final record was seen
+    const ContainerReport& report() const { return rep; }
+
+private:
+    CryptoPP::SecByteBlock key;
+    std::unique_ptr<ContainerCodec> codec; ///< created once the header is in
+    std::vector<CryptoPP::byte> buf;        ///< header or the record being assembled
+    std::vector<CryptoPP::byte> plain;
+    ContainerReport rep;
+    bool done = false;                      ///< final record seen
+};
@@ -0,0 +1,75 @@
+#include "ctrcipher.h"
+#include "workerpool.h"  // slices run on the pool
+
+#include <algorithm> // min
+#include <cstring>   // memcpy
+
+// Crypto++ includes
+#include <cryptopp/aes.h>    // AES block cipher
+#include <cryptopp/modes.h>  // CTR_Mode
+
+using namespace CryptoPP;
+
+/**
+ * @brief Stores the key and initial counter block.
+ *
+ * @param key AES key.
+ * @param keyLen 16, 24 or 32.
+ * @param iv Initial counter block (16 bytes).
+ * @return false for any other key length or a null iv.
+ */
+bool CtrCipher::setKey(const byte* key, size_t keyLen, const byte* iv) {
+    if (!key || !iv || (keyLen != 16 && keyLen != 24 && keyLen != 32)) return false;
+    aesKey.Assign(key, keyLen);
+    std::memcpy(initialCounter, iv, sizeof(initialCounter));
+    keyed = true;
+    return true;
+}
+
+
+/**
+ * @brief Runs one counter range through its own CTR_Mode object.
+ *
+ * The mode is keyed per range (a key schedule costs well under a
+ * microsecond, a range tens of microseconds), so no cipher state is shared
+ * between threads. Seek() places the counter at offset / 16 and skips
+ * offset % 16 keystream bytes.
+ */
+void CtrCipher::processRange(uint64_t offset, const byte* in, byte* out, size_t n) const {
+    CTR_Mode<AES>::Encryption ctr;
+    ctr.SetKeyWithIV(aesKey, aesKey.size(), initialCounter, sizeof(initialCounter));
+    if (offset) ctr.Seek(offset);
+    ctr.ProcessData(out, in, n);
+}
+
+
+void CtrCipher::process(uint64_t offset, const byte* in, byte* out, size_t n) const {
+    process(offset, in, out, n, &WorkerPool::shared());
+}
+
+
+/**
+ * @brief XORs `n` bytes of keystream, starting at stream position `offset`, into `out`.
+ *
+ * Buffers of kCtrParallelBytes or more are split into kCtrSliceBytes ranges
+ * that pool workers and the calling thread claim until none are left.
+ *
+ * @param offset Byte position of `in[0]` in the stream.
+ * @param in Input (plaintext or ciphertext).
+ * @param out Output; may equal `in`.
+ * @param n Length.
+ * @param pool Pool to spread over, or nullptr for the calling thread only.
+ */
+void CtrCipher::process(uint64_t offset, const byte* in, byte* out, size_t n, WorkerPool* pool) const {
+    if (n == 0) return;
+    if (!pool || pool->size() == 0 || n < kCtrParallelBytes) {
+        processRange(offset, in, out, n);
+        return;
+    }
+    const size_t slices = (n + kCtrSliceBytes - 1) / kCtrSliceBytes;
+    pool->parallelFor(slices, [&](size_t i) {
+        const size_t start = i * kCtrSliceBytes;
+        const size_t len = std::min(kCtrSliceBytes, n - start);
+        processRange(offset + start, in + start, out + start, len);
+    });
+}
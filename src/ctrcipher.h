@@ -0,0 +1,44 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <cstddef>  // size_t
+#include <cstdint>  // stream offsets
+
+#include <cryptopp/secblock.h> // SecByteBlock key
+
+class WorkerPool; // workerpool.h
+
+// AES-CTR over whole buffers for bulk encryption. Keystream blocks do not
+// depend on each other, so a large buffer is cut into counter ranges of
+// kCtrSliceBytes that pool workers claim one at a time; a worker that
+// finishes early takes the next range, so a slow or descheduled core holds
+// up at most one slice. Each range runs through Crypto++'s CTR mode, which
+// keeps several AES-NI (or ARMv8 AES) blocks in flight per iteration.
+//
+// Counter block i is iv + i (big-endian, carrying through all 16 bytes), as
+// in CTR_Mode<AES>; output is identical to one CTR_Mode pass over the
+// stream. `offset` is the byte position of `in` within that stream, so a
+// large file can be processed chunk by chunk. Encryption and decryption are
+// the same operation.
+//
+// process() is const and may be called from several threads at once.
+
+constexpr size_t kCtrSliceBytes = 256 * 1024;    // counter range claimed per task
+constexpr size_t kCtrParallelBytes = 1024 * 1024; // below this, the calling thread works alone
+
+class CtrCipher {
+public:
+    bool setKey(const CryptoPP::byte* key, size_t keyLen, const CryptoPP::byte* iv); // 16/24/32-byte key, 16-byte iv
+    bool hasKey() const { return keyed; }
+
+    // out may equal in. The first overload uses WorkerPool::shared(); pass
+    // a pool of your own, or nullptr for the calling thread only.
+    void process(uint64_t offset, const CryptoPP::byte* in, CryptoPP::byte* out, size_t n) const;
+    void process(uint64_t offset, const CryptoPP::byte* in, CryptoPP::byte* out, size_t n, WorkerPool* pool) const;
+
+private:
+    void processRange(uint64_t offset, const CryptoPP::byte* in, CryptoPP::byte* out, size_t n) const;
+
+    CryptoPP::SecByteBlock aesKey;
+    CryptoPP::byte initialCounter[16] = {};
+    bool keyed = false;
+};
@@ -0,0 +1,259 @@
+#include "dirwalk.h"
+
+#include <condition_variable> // idle walkers
+#include <deque>              // pending directories
+#include <memory>             // parent descriptors shared by queued children
+#include <mutex>              // queue state
+#include <thread>             // walker threads
+
+#include <dirent.h>     // DT_* types, readdir fallback
+#include <fcntl.h>      // openat
+#include <fnmatch.h>    // glob matching
+#include <sys/stat.h>   // fstatat
+#include <unistd.h>     // close, syscall
+#ifdef __linux__
+#include <sys/syscall.h> // SYS_getdents64
+#endif
+
+static const unsigned kDefaultWalkThreads = 4; ///< metadata-bound: more rarely helps, even on NFS
+static const size_t kDirentBufferBytes = 64 * 1024;
+
+// ---------------- Helper functions ------------------
+
+/**
+ * @brief Checks an entry against a glob list (see dirwalk.h for the rules).
+ *
+ * @param patterns Globs.
+ * @param rel Path relative to the walk root.
+ * @param name Last path component.
+ */
+bool matchesAnyGlob(const std::vector<std::string>& patterns, const std::string& rel, const std::string& name) {
+    for (const std::string& p : patterns) {
+        const bool byPath = p.find('/') != std::string::npos;
+        if (::fnmatch(p.c_str(), byPath ? rel.c_str() : name.c_str(), 0) == 0) return true;
+    }
+    return false;
+}
+
+
+namespace {
+
+// Open directory descriptor, kept alive while children queued from it wait
+// to be opened relative to it.
+struct DirFd {
+    int fd;
+    explicit DirFd(int f) : fd(f) {}
+    ~DirFd() { ::close(fd); }
+    DirFd(const DirFd&) = delete;
+    DirFd& operator=(const DirFd&) = delete;
+};
+
+// A directory waiting to be read.
+struct PendingDir {
+    std::shared_ptr<DirFd> parent; ///< null for the root
+    std::string rel;               ///< path relative to the root ("" = root)
+    std::string name;              ///< last component, opened relative to `parent`
+};
+
+// Shared state of one walk.
+struct Walk {
+    const WalkOptions& opt;
+    const WalkSink& sink;
+    WalkStats& stats;
+    int rootFd;
+    dev_t rootDev;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<PendingDir> pending;
+    unsigned active = 0;             ///< walkers currently reading a directory
+    std::atomic<bool> stopped{false};
+
+    Walk(const WalkOptions& o, const WalkSink& s, WalkStats& st, int fd, dev_t dev)
+        : opt(o), sink(s), stats(st), rootFd(fd), rootDev(dev) {}
+
+    void run();
+    void readDirectory(PendingDir dir);
+    // returns false to stop the walk
+    bool visit(int dirFd, const std::string& rel, const char* name, unsigned char type,
+               std::vector<PendingDir>& subdirs);
+};
+
+
+/**
+ * @brief Walker thread body: takes directories until none are pending and none are being read.
+ */
+void Walk::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        cv.wait(lock, [this] { return stopped || !pending.empty() || active == 0; });
+        if (stopped || pending.empty()) { ///< pending empty here means active == 0: done
+            cv.notify_all();
+            return;
+        }
+        PendingDir dir = std::move(pending.back()); ///< LIFO keeps the queue (and open parents) short
+        pending.pop_back();
+        ++active;
+        lock.unlock();
+
+        readDirectory(std::move(dir));
+
+        lock.lock();
+        --active;
+        if (!pending.empty() || active == 0) cv.notify_all();
+    }
+}
+
+
+/**
+ * @brief Handles one directory entry: queues subdirectories, passes matching files to the sink.
+ */
+bool Walk::visit(int dirFd, const std::string& rel, const char* name, unsigned char type,
+                 std::vector<PendingDir>& subdirs) {
+    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) return true;
+    const std::string child = rel.empty() ? std::string(name) : rel + '/' + name;
+
+    struct stat st;
+    bool haveStat = false;
+    const bool needStat = type == DT_UNKNOWN || (type == DT_DIR && !opt.crossDevices)
+                          || (type == DT_REG && opt.statFiles);
+    if (needStat) {
+        if (::fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) return true; ///< vanished meanwhile
+        haveStat = true;
+        type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_LNK;
+    }
+
+    if (type == DT_DIR) {
+        if (matchesAnyGlob(opt.exclude, child, name)) {
+            ++stats.filtered;
+        } else if (opt.crossDevices || (haveStat && st.st_dev == rootDev)) {
+            subdirs.push_back(PendingDir{nullptr, child, name}); ///< parent filled in by readDirectory
+        }
+        return true;
+    }
+    if (type != DT_REG) return true; ///< symlinks, devices, sockets are not batch inputs
+
+    if ((!opt.include.empty() && !matchesAnyGlob(opt.include, child, name))
+        || matchesAnyGlob(opt.exclude, child, name)) {
+        ++stats.filtered;
+        return true;
+    }
+    WalkedFile f;
+    f.path = child;
+    f.size = haveStat ? static_cast<uint64_t>(st.st_size) : 0;
+    f.mtimeNs = haveStat ? int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec : 0;
+    ++stats.files;
+    return sink(f);
+}
+
+
+/**
+ * @brief Reads one directory and queues its subdirectories.
+ *
+ * The directory is opened by name relative to its parent's descriptor, so
+ * each open resolves one component (O(1) in the depth) and O_NOFOLLOW
+ * covers every level of the path: a directory swapped for a symlink after
+ * it was listed is not followed.
+ */
+void Walk::readDirectory(PendingDir dir) {
+    const int fd = dir.parent ? ::openat(dir.parent->fd, dir.name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC)
+                              : ::openat(rootFd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    dir.parent.reset(); ///< the last queued child closes the parent
+    if (fd < 0) {
+        ++stats.errors;
+        return;
+    }
+    ++stats.dirs;
+    const auto self = std::make_shared<DirFd>(fd);
+    const std::string& rel = dir.rel;
+
+    std::vector<PendingDir> subdirs;
+    bool keepGoing = true;
+#if defined(__linux__) && defined(SYS_getdents64)
+    // struct linux_dirent64 (not exported by glibc headers)
+    struct Dirent64 {
+        uint64_t d_ino;
+        int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+    static thread_local std::vector<char> buf(kDirentBufferBytes);
+    while (keepGoing) {
+        long n = ::syscall(SYS_getdents64, fd, buf.data(), buf.size());
+        if (n < 0) {
+            ++stats.errors;
+            break;
+        }
+        if (n == 0) break;
+        for (long off = 0; off < n && keepGoing;) {
+            const Dirent64* d = reinterpret_cast<const Dirent64*>(buf.data() + off);
+            keepGoing = visit(fd, rel, d->d_name, d->d_type, subdirs);
+            off += d->d_reclen;
+        }
+        if (stopped) break;
+    }
+#else
+    DIR* stream = ::fdopendir(::dup(fd)); ///< closedir must not close the descriptor children use
+    if (!stream) {
+        ++stats.errors;
+        return;
+    }
+    while (keepGoing && !stopped) {
+        dirent* d = ::readdir(stream);
+        if (!d) break;
+        keepGoing = visit(fd, rel, d->d_name, d->d_type, subdirs);
+    }
+    ::closedir(stream);
+#endif
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!keepGoing) stopped = true;
+    for (PendingDir& s : subdirs) {
+        s.parent = self;
+        pending.push_back(std::move(s));
+    }
+}
+
+} // namespace
+
+
+// ---------------- Walk ------------------
+
+/**
+ * @brief Enumerates `root` with parallel walker threads, streaming files to `sink`.
+ *
+ * @param root Directory to walk.
+ * @param opt Globs, thread count and stat / mount settings.
+ * @param sink Receives each matching regular file; called concurrently.
+ * @param stats Counters (readable by other threads while the walk runs).
+ * @param error Receives a description if the root cannot be opened.
+ * @return true if the walk ran (it may have been stopped by the sink).
+ */
+bool walkTree(const std::string& root, const WalkOptions& opt, const WalkSink& sink,
+              WalkStats& stats, std::string& error) {
+    int rootFd = ::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (rootFd < 0) {
+        error = "cannot open directory " + root;
+        return false;
+    }
+    struct stat st;
+    if (::fstat(rootFd, &st) != 0) {
+        ::close(rootFd);
+        error = "cannot stat " + root;
+        return false;
+    }
+
+    Walk walk(opt, sink, stats, rootFd, st.st_dev);
+    walk.pending.push_back(PendingDir());
+
+    const unsigned n = opt.threads ? opt.threads : kDefaultWalkThreads;
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < n; ++i)
+        threads.emplace_back([&walk] { walk.run(); });
+    walk.run(); ///< calling thread walks as well
+    for (std::thread& t : threads) t.join();
+
+    ::close(rootFd);
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <atomic>     // stats shared by walker threads
+#include <cstdint>    // sizes / counters
+#include <functional> // per-file sink
+#include <string>     // paths, globs
+#include <vector>     // pattern lists
+
+// Parallel directory enumeration for batch jobs.
+//
+// Several walker threads share a queue of pending directories. Each one is
+// opened by name relative to its parent's descriptor (openat, O_NOFOLLOW)
+// and read with getdents64 in large batches, with d_type avoiding a stat per
+// entry. Files are passed to the sink as soon as they are found, so
+// processing overlaps the walk instead of waiting for a full scan of a deep
+// or network-mounted tree.
+//
+// Glob rules (fnmatch): a pattern without '/' matches the entry name, one
+// with '/' matches the path relative to the root ('*' then also spans '/').
+// A leading '.' is not special, so '*' matches dot files too; exclude '.*'
+// to skip them.
+// Excluded directories are not descended into. Include patterns only filter
+// files; an empty include list accepts every regular file.
+
+struct WalkOptions {
+    std::vector<std::string> include;
+    std::vector<std::string> exclude;
+    unsigned threads = 0;          // walker threads, 0 = default (4)
+    bool statFiles = true;         // fill WalkedFile::size / mtimeNs (one fstatat per file)
+    bool crossDevices = false;     // descend into other mounted filesystems
+};
+
+struct WalkedFile {
+    std::string path;   // relative to the root, '/'-separated
+    uint64_t size = 0;  // 0 unless WalkOptions::statFiles
+    int64_t mtimeNs = 0; // modification time in ns, 0 unless WalkOptions::statFiles
+};
+
+struct WalkStats {
+    std::atomic<uint64_t> dirs{0};
+    std::atomic<uint64_t> files{0};    // files passed to the sink
+    std::atomic<uint64_t> filtered{0}; // entries rejected by the globs
+    std::atomic<uint64_t> errors{0};   // directories that could not be read
+};
+
+// Called from walker threads (concurrently); return false to stop the walk.
+using WalkSink = std::function<bool(const WalkedFile& file)>;
+
+// True if `rel` / `name` matches any pattern of the list.
+bool matchesAnyGlob(const std::vector<std::string>& patterns, const std::string& rel, const std::string& name);
+
+// Walks `root` and blocks until every directory has been read. Unreadable
+// subdirectories are counted, not fatal. Returns false (with `error`) only if
+// the root itself cannot be opened.
+bool walkTree(const std::string& root, const WalkOptions& opt, const WalkSink& sink,
+              WalkStats& stats, std::string& error);
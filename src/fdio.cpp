@@ -0,0 +1,222 @@
+#include "fdio.h"
+#include "throttle.h"  // throttleIo (background job rate limit)
+
+#include <fcntl.h>     // fcntl, posix_fadvise, AT_FDCWD
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // read, write, lseek, ftruncate, link, unlink
+#ifdef __linux__
+#include <sys/syscall.h> // SYS_renameat2
+#endif
+#include <cerrno>      // EINTR, ENXIO
+#include <cstring>     // memcpy
+#include <memory>      // shared read position for memoryReader
+
+
+/**
+ * @brief Reads up to n bytes, looping over short reads (pipes return partial data).
+ *
+ * @param fd Descriptor to read from.
+ * @param buf Destination buffer of at least n bytes.
+ * @param n Number of bytes wanted.
+ * @return Bytes read (less than n only at EOF), or -1 on error.
+ */
+ssize_t readFull(int fd, void* buf, size_t n) {
+    char* p = static_cast<char*>(buf);
+    size_t got = 0;
+    while (got < n) {
+        ssize_t r = ::read(fd, p + got, n - got);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (r == 0) break; ///< EOF
+        got += static_cast<size_t>(r);
+    }
+    throttleIo(got); ///< paces background jobs; no-op unless a ThrottleScope is active
+    return static_cast<ssize_t>(got);
+}
+
+
+/**
+ * @brief Writes the whole buffer, looping over short writes.
+ *
+ * @param fd Descriptor to write to.
+ * @param buf Data to write.
+ * @param n Number of bytes.
+ * @return true if every byte was written.
+ */
+bool writeAll(int fd, const void* buf, size_t n) {
+    const char* p = static_cast<const char*>(buf);
+    while (n > 0) {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+
+/**
+ * @brief Publishes a finished temp file without ever replacing an existing output.
+ *
+ * renameat2() is called through syscall() (glibc only wraps it from 2.28).
+ * Filesystems or kernels without RENAME_NOREPLACE fall back to link() +
+ * unlink(), which also fails with EEXIST if `dst` exists.
+ *
+ * @param tmp Finished temp file.
+ * @param dst Final name.
+ * @return false with errno set (EEXIST if dst exists).
+ */
+bool renameNoReplace(const std::string& tmp, const std::string& dst) {
+#if defined(__linux__) && defined(SYS_renameat2)
+    static const unsigned kRenameNoReplace = 1; ///< RENAME_NOREPLACE (linux/fs.h)
+    if (::syscall(SYS_renameat2, AT_FDCWD, tmp.c_str(), AT_FDCWD, dst.c_str(), kRenameNoReplace) == 0) return true;
+    if (errno != EINVAL && errno != ENOSYS) return false;
+#endif
+    if (::link(tmp.c_str(), dst.c_str()) != 0) return false;
+    ::unlink(tmp.c_str());
+    return true;
+}
+
+
+/**
+ * @brief Tunes a descriptor for large sequential transfers. Failures are ignored.
+ *
+ * @param fd Descriptor (stdin/stdout or an opened file).
+ */
+void tuneStreamFd(int fd) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0) return;
+#ifdef F_SETPIPE_SZ
+    if (S_ISFIFO(st.st_mode)) {
+        ::fcntl(fd, F_SETPIPE_SZ, static_cast<int>(kStreamChunkBytes)); ///< may be capped by pipe-max-size
+        return;
+    }
+#endif
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (S_ISREG(st.st_mode))
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+
+/**
+ * @brief Wraps a descriptor as a ByteReader (see readFull()).
+ */
+ByteReader fdReader(int fd) {
+    return [fd](unsigned char* buf, size_t n) { return readFull(fd, buf, n); };
+}
+
+
+/**
+ * @brief Wraps a descriptor as a ByteWriter (see writeAll()).
+ */
+ByteWriter fdWriter(int fd) {
+    return [fd](const unsigned char* data, size_t n) { return writeAll(fd, data, n); };
+}
+
+
+/**
+ * @brief Reads from a memory buffer (e.g. a file already loaded by the GUI).
+ *
+ * @param data Buffer start; must stay valid while the reader is used.
+ * @param size Buffer length.
+ */
+ByteReader memoryReader(const char* data, size_t size) {
+    auto pos = std::make_shared<size_t>(0);
+    return [data, size, pos](unsigned char* buf, size_t n) -> ssize_t {
+        size_t take = size - *pos < n ? size - *pos : n;
+        if (take) std::memcpy(buf, data + *pos, take);
+        *pos += take;
+        return static_cast<ssize_t>(take);
+    };
+}
+
+
+/**
+ * @brief Appends everything written to a string.
+ *
+ * @param out Destination; must stay valid while the writer is used.
+ */
+ByteWriter stringWriter(std::string& out) {
+    return [&out](const unsigned char* data, size_t n) {
+        out.append(reinterpret_cast<const char*>(data), n);
+        return true;
+    };
+}
+
+
+/**
+ * @brief Maps the holes of a regular file with SEEK_DATA / SEEK_HOLE.
+ *
+ * @param fd Input descriptor; the probe moves its file offset.
+ * @return Probe function, or an empty one if fd is not a regular file.
+ */
+HoleProbe fdHoleProbe(int fd) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return HoleProbe();
+    return [fd](uint64_t offset) {
+        FileExtent ext;
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ext.dataBytes = UINT64_MAX; ///< let the reads find the end
+            return ext;
+        }
+        const uint64_t size = static_cast<uint64_t>(st.st_size);
+        if (offset >= size) return ext;
+#ifdef SEEK_DATA
+        off_t data = ::lseek(fd, static_cast<off_t>(offset), SEEK_DATA);
+        if (data < 0 && errno == ENXIO) { ///< only a hole up to EOF
+            ext.holeBytes = size - offset;
+            ::lseek(fd, static_cast<off_t>(size), SEEK_SET);
+            return ext;
+        }
+        if (data >= 0) {
+            off_t hole = ::lseek(fd, data, SEEK_HOLE);
+            if (hole < data) hole = static_cast<off_t>(size);
+            ext.holeBytes = static_cast<uint64_t>(data) - offset;
+            ext.dataBytes = static_cast<uint64_t>(hole - data);
+            ::lseek(fd, data, SEEK_SET);
+            return ext;
+        }
+#endif
+        ext.dataBytes = size - offset; ///< no hole support: everything is data
+        ::lseek(fd, static_cast<off_t>(offset), SEEK_SET);
+        return ext;
+    };
+}
+
+
+/**
+ * @brief Turns zero runs into holes by seeking forward in the output.
+ *
+ * @param fd Output descriptor; writes and seeks share its file offset.
+ * @return Writer function, or an empty one if the output cannot hold holes.
+ */
+HoleWriter fdHoleWriter(int fd) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return HoleWriter();
+    int flags = ::fcntl(fd, F_GETFL);
+    if (flags < 0 || (flags & O_APPEND)) return HoleWriter(); ///< appends would ignore the seek
+    return [fd](uint64_t n) {
+        return ::lseek(fd, static_cast<off_t>(n), SEEK_CUR) >= 0;
+    };
+}
+
+
+/**
+ * @brief Sets the file size to the current offset if that lies past the end.
+ *
+ * @param fd Output descriptor used with fdHoleWriter().
+ * @return false if the size could not be set.
+ */
+bool finishHoles(int fd) {
+    off_t pos = ::lseek(fd, 0, SEEK_CUR);
+    struct stat st;
+    if (pos < 0 || ::fstat(fd, &st) != 0) return false;
+    return pos <= st.st_size || ::ftruncate(fd, pos) == 0;
+}
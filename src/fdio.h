@@ -0,0 +1,57 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <cstddef>      // size_t
+#include <cstdint>      // extent sizes
+#include <functional>   // ByteReader / ByteWriter
+#include <string>       // in-memory sources/sinks
+#include <sys/types.h>  // ssize_t
+
+// Buffer size for streaming stages (pipes, files). One chunk per syscall keeps
+// per-byte overhead low; memory use stays constant regardless of input size.
+constexpr size_t kStreamChunkBytes = 1 << 20;
+
+// Reads until `n` bytes are read or EOF. Returns the byte count (0 = EOF) or -1 on error.
+// Bytes read are charged to the calling thread's throttle, if any (throttle.h).
+ssize_t readFull(int fd, void* buf, size_t n);
+
+// Writes all `n` bytes, retrying short writes. Returns false on error.
+bool writeAll(int fd, const void* buf, size_t n);
+
+// Renames `tmp` to `dst` unless `dst` already exists (renameat2 with
+// RENAME_NOREPLACE, or link + unlink where that is unsupported). Returns
+// false with errno set, EEXIST if `dst` exists; `tmp` is then left in place.
+bool renameNoReplace(const std::string& tmp, const std::string& dst);
+
+// Prepares a descriptor for bulk streaming: pipes are grown to hold a full
+// chunk (F_SETPIPE_SZ), regular files get a sequential-access hint.
+void tuneStreamFd(int fd);
+
+// Pluggable byte streams for the engine. Readers behave like readFull()
+// (short count only at EOF, -1 on error); writers like writeAll().
+using ByteReader = std::function<ssize_t(unsigned char* buf, size_t n)>;
+using ByteWriter = std::function<bool(const unsigned char* data, size_t n)>;
+
+ByteReader fdReader(int fd);
+ByteWriter fdWriter(int fd);
+ByteReader memoryReader(const char* data, size_t size); // data must outlive the reader
+ByteWriter stringWriter(std::string& out);               // appends to out
+
+// Data / hole layout of a file at some offset, for sparse copies.
+struct FileExtent {
+    uint64_t holeBytes = 0; // unallocated (zero) bytes starting at the offset
+    uint64_t dataBytes = 0; // data after the hole; both 0 = end of file
+};
+
+// Describes the input at `offset` and positions it at the start of the data.
+using HoleProbe = std::function<FileExtent(uint64_t offset)>;
+// Skips `n` zero bytes of output without writing them.
+using HoleWriter = std::function<bool(uint64_t n)>;
+
+// SEEK_DATA / SEEK_HOLE probe. Empty unless fd is a regular file; on
+// filesystems without hole support the whole file is reported as data.
+HoleProbe fdHoleProbe(int fd);
+// Seeks over zero runs so they become holes. Empty unless fd is a regular
+// file opened without O_APPEND; call finishHoles() after the last write.
+HoleWriter fdHoleWriter(int fd);
+// Extends the file to the current offset, so a trailing hole is kept.
+bool finishHoles(int fd);
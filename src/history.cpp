@@ -0,0 +1,359 @@
+#include "history.h"
+#include "fdio.h"     // writeAll
+
+#include <algorithm>   // min
+#include <chrono>      // wall clock
+#include <cstdio>      // snprintf
+#include <cstdlib>     // getenv
+#include <cstring>     // memcmp
+#include <ctime>       // gmtime_r
+#include <filesystem>  // create_directories
+
+#include <fcntl.h>     // open
+#include <sys/file.h>  // flock: appends vs. tail repair
+#include <unistd.h>    // read, close, ftruncate, gethostname
+
+// Crypto++ includes
+#include <cryptopp/crc.h> // record checksums
+
+#ifndef CRYPTOQTAPP_VERSION
+#define CRYPTOQTAPP_VERSION "dev"  ///< set by CMake from the project version
+#endif
+
+using namespace CryptoPP;
+
+static const char kMagic[8] = { 'C', 'Q', 'A', 'H', 'I', 'S', 'T', '1' };
+static const uint8_t kRecordVersion = 1;
+static const uint32_t kMaxRecordBytes = 1 << 20; ///< anything larger is corruption
+
+// ---------------- Helper functions ------------------
+
+static void putU16(std::string& out, uint16_t v) {
+    out += static_cast<char>(v & 0xff);
+    out += static_cast<char>(v >> 8);
+}
+
+static void putU32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out += static_cast<char>((v >> (8 * i)) & 0xff);
+}
+
+static void putU64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out += static_cast<char>((v >> (8 * i)) & 0xff);
+}
+
+static void putString(std::string& out, const std::string& s) {
+    const size_t n = std::min<size_t>(s.size(), 0xffff);
+    putU16(out, static_cast<uint16_t>(n));
+    out.append(s.data(), n);
+}
+
+// Bounds-checked little-endian reader over one payload.
+struct PayloadReader {
+    const unsigned char* p;
+    size_t left;
+
+    bool u64(uint64_t& v) {
+        if (left < 8) return false;
+        v = 0;
+        for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+        p += 8;
+        left -= 8;
+        return true;
+    }
+    bool u8(uint8_t& v) {
+        if (left < 1) return false;
+        v = *p++;
+        --left;
+        return true;
+    }
+    bool str(std::string& s) {
+        if (left < 2) return false;
+        const size_t n = p[0] | (p[1] << 8);
+        if (left < 2 + n) return false;
+        s.assign(reinterpret_cast<const char*>(p + 2), n);
+        p += 2 + n;
+        left -= 2 + n;
+        return true;
+    }
+};
+
+static uint32_t payloadCrc(const std::string& payload) {
+    CRC32 crc;
+    byte d[CRC32::DIGESTSIZE];
+    crc.CalculateDigest(d, reinterpret_cast<const byte*>(payload.data()), payload.size());
+    return d[0] | (d[1] << 8) | (d[2] << 16) | (static_cast<uint32_t>(d[3]) << 24);
+}
+
+static std::string encodeRecord(const HistoryRecord& r) {
+    std::string payload;
+    payload += static_cast<char>(kRecordVersion);
+    payload += static_cast<char>(r.ok ? 1 : 0);
+    putU64(payload, static_cast<uint64_t>(r.startMs));
+    putU64(payload, r.durationUs);
+    putU64(payload, r.inputBytes);
+    putU64(payload, r.outputBytes);
+    for (const std::string* s : { &r.operation, &r.algorithm, &r.input, &r.host, &r.version, &r.error })
+        putString(payload, *s);
+
+    std::string record;
+    putU32(record, static_cast<uint32_t>(payload.size()));
+    putU32(record, payloadCrc(payload));
+    return record + payload;
+}
+
+/**
+ * @brief Decodes one payload; false if it is malformed or of a newer record version.
+ */
+static bool decodeRecord(const std::string& payload, HistoryRecord& r) {
+    PayloadReader in{ reinterpret_cast<const unsigned char*>(payload.data()), payload.size() };
+    uint8_t version, ok;
+    uint64_t start;
+    if (!in.u8(version) || version != kRecordVersion || !in.u8(ok)) return false;
+    if (!in.u64(start) || !in.u64(r.durationUs) || !in.u64(r.inputBytes) || !in.u64(r.outputBytes)) return false;
+    r.startMs = static_cast<int64_t>(start);
+    r.ok = ok != 0;
+    return in.str(r.operation) && in.str(r.algorithm) && in.str(r.input) && in.str(r.host) && in.str(r.version)
+           && in.str(r.error);
+}
+
+// How a scan of the store ended.
+enum class ScanEnd { Clean, TornTail, Damaged };
+
+/**
+ * @brief Walks the records after the magic.
+ *
+ * A record whose checksum fails is skipped; its length still says where the
+ * next one starts. The walk stops at a record that runs past the end of the
+ * file (torn by a crash) or at an impossible length, after which the
+ * record boundaries are lost.
+ *
+ * @param data Whole store file.
+ * @param records Receives the decoded records (nullptr to only validate).
+ * @param end Receives why the walk stopped.
+ * @return Offset where the walk stopped.
+ */
+static size_t scanRecords(const std::string& data, std::vector<HistoryRecord>* records, ScanEnd& end) {
+    size_t pos = sizeof(kMagic);
+    end = ScanEnd::Clean;
+    while (pos < data.size()) {
+        if (data.size() - pos < 8) {
+            end = ScanEnd::TornTail;
+            break;
+        }
+        const unsigned char* h = reinterpret_cast<const unsigned char*>(data.data() + pos);
+        const uint32_t len = h[0] | (h[1] << 8) | (h[2] << 16) | (static_cast<uint32_t>(h[3]) << 24);
+        const uint32_t crc = h[4] | (h[5] << 8) | (h[6] << 16) | (static_cast<uint32_t>(h[7]) << 24);
+        if (len > kMaxRecordBytes) {
+            end = ScanEnd::Damaged;
+            break;
+        }
+        if (data.size() - pos - 8 < len) {
+            end = ScanEnd::TornTail;
+            break;
+        }
+        const std::string payload = data.substr(pos + 8, len);
+        HistoryRecord r;
+        if (records && payloadCrc(payload) == crc && decodeRecord(payload, r))
+            records->push_back(std::move(r)); ///< corrupt records and newer versions are skipped
+        pos += 8 + len;
+    }
+    return pos;
+}
+
+static bool readWhole(int fd, std::string& data) {
+    std::vector<char> buf(1 << 16);
+    ssize_t n;
+    while ((n = ::pread(fd, buf.data(), buf.size(), static_cast<off_t>(data.size()))) > 0)
+        data.append(buf.data(), static_cast<size_t>(n));
+    return n == 0;
+}
+
+static std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (unsigned char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                char esc[8];
+                std::snprintf(esc, sizeof(esc), "\\u%04x", c);
+                out += esc;
+            } else {
+                out += static_cast<char>(c);
+            }
+        }
+    }
+    return out;
+}
+
+static std::string hostName() {
+    char name[256] = {};
+    if (::gethostname(name, sizeof(name) - 1) != 0) return "unknown";
+    return name;
+}
+
+
+// ---------------- HistoryStore ------------------
+
+HistoryStore::~HistoryStore() {
+    close();
+}
+
+
+/**
+ * @brief Opens the store for appending; a new or empty file gets the magic first.
+ *
+ * A tail torn by a crash is cut off here, so records appended afterwards
+ * stay reachable. Nothing else is ever truncated: a corrupt record in the
+ * middle is left in place (and skipped on load), and a store whose record
+ * boundaries are lost is refused rather than cut short.
+ *
+ * @param path Store file.
+ * @param error Receives a description on failure.
+ * @return true if records can be appended.
+ */
+bool HistoryStore::open(const std::string& path, std::string& error) {
+    close();
+    std::lock_guard<std::mutex> lock(mutex);
+    std::error_code ec;
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        error = "cannot open history " + path;
+        return false;
+    }
+    ::flock(fd, LOCK_EX); ///< another process may be appending
+    std::string data;
+    bool ok = readWhole(fd, data);
+    if (ok && data.empty()) {
+        ok = writeAll(fd, kMagic, sizeof(kMagic));
+        if (!ok) error = "cannot write history " + path;
+    } else if (!ok || data.size() < sizeof(kMagic) || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        error = path + " is not a history store";
+        ok = false;
+    } else {
+        ScanEnd end;
+        const size_t intact = scanRecords(data, nullptr, end);
+        if (end == ScanEnd::TornTail) {
+            ::ftruncate(fd, static_cast<off_t>(intact)); ///< best effort
+        } else if (end == ScanEnd::Damaged) {
+            error = path + ": damaged record at offset " + std::to_string(intact);
+            ok = false;
+        }
+    }
+    ::flock(fd, LOCK_UN);
+    if (!ok) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    storePath = path;
+    return true;
+}
+
+
+void HistoryStore::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+
+/**
+ * @brief Appends one record (host and version filled in if empty).
+ *
+ * Not synced: losing the last records in a crash is acceptable for
+ * statistics, and the checksum keeps a torn record from being read.
+ * The flock keeps a concurrent open() from cutting a record in flight.
+ */
+bool HistoryStore::append(HistoryRecord record) {
+    if (record.host.empty()) record.host = hostName();
+    if (record.version.empty()) record.version = CRYPTOQTAPP_VERSION;
+    const std::string bytes = encodeRecord(record);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd < 0) return false;
+    ::flock(fd, LOCK_EX);
+    const bool ok = writeAll(fd, bytes.data(), bytes.size());
+    ::flock(fd, LOCK_UN);
+    return ok;
+}
+
+
+std::vector<HistoryRecord> HistoryStore::load(size_t limit) const {
+    std::vector<HistoryRecord> records;
+    std::string error;
+    loadHistory(storePath, records, error);
+    if (limit && records.size() > limit)
+        records.erase(records.begin(), records.end() - static_cast<std::ptrdiff_t>(limit));
+    return records;
+}
+
+
+std::string HistoryStore::defaultPath() {
+    std::string base;
+    if (const char* xdg = std::getenv("XDG_DATA_HOME"); xdg && *xdg) base = xdg;
+    else if (const char* home = std::getenv("HOME"); home && *home) base = std::string(home) + "/.local/share";
+    else base = ".";
+    return base + "/CryptoQtApp/history.cqah";
+}
+
+
+// ---------------- Reading / export ------------------
+
+/**
+ * @brief Reads every valid record of a store, skipping corrupt ones.
+ *
+ * Reading stops at a torn tail or where the record boundaries are lost.
+ *
+ * @return false if the file cannot be read or is not a store.
+ */
+bool loadHistory(const std::string& path, std::vector<HistoryRecord>& records, std::string& error) {
+    records.clear();
+    int in = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        error = "cannot open history " + path;
+        return false;
+    }
+    std::string data;
+    const bool read = readWhole(in, data);
+    ::close(in);
+    if (!read || data.size() < sizeof(kMagic) || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        error = path + " is not a history store";
+        return false;
+    }
+    ScanEnd end;
+    scanRecords(data, &records, end);
+    return true;
+}
+
+std::string historyJsonLine(const HistoryRecord& r) {
+    const time_t secs = static_cast<time_t>(r.startMs / 1000);
+    struct tm tm;
+    gmtime_r(&secs, &tm);
+    char when[80];
+    std::snprintf(when, sizeof(when), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", tm.tm_year + 1900, tm.tm_mon + 1,
+                  tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(r.startMs % 1000));
+    char numbers[160];
+    std::snprintf(numbers, sizeof(numbers),
+                  "\"input_bytes\":%llu,\"output_bytes\":%llu,\"seconds\":%.6f,\"mb_per_s\":%.2f",
+                  static_cast<unsigned long long>(r.inputBytes), static_cast<unsigned long long>(r.outputBytes),
+                  r.seconds(), r.mbPerSecond());
+    return std::string("{\"start\":\"") + when + "\",\"operation\":\"" + jsonEscape(r.operation)
+           + "\",\"algorithm\":\"" + jsonEscape(r.algorithm) + "\",\"input\":\"" + jsonEscape(r.input) + "\","
+           + numbers + ",\"ok\":" + (r.ok ? "true" : "false") + ",\"error\":\"" + jsonEscape(r.error)
+           + "\",\"host\":\"" + jsonEscape(r.host) + "\",\"version\":\"" + jsonEscape(r.version) + "\"}\n";
+}
+
+
+int64_t historyNowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
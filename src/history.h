@@ -0,0 +1,71 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <cstdint>  // sizes, timestamps
+#include <mutex>    // appends from worker threads
+#include <string>   // paths, fields
+#include <vector>   // loaded records
+
+// Local history of finished operations with their performance figures, so
+// throughput drift across releases and hosts can be spotted later.
+//
+// The store is an append-only binary file: an 8-byte magic, then records of
+//   u32 payload length | u32 CRC32 of payload | payload
+// (little-endian; the payload holds the numeric fields followed by
+// u16-length-prefixed strings). Each record is appended with a single
+// write() on an O_APPEND descriptor under flock, so the GUI and CLI can
+// share a store. A tail torn by a crash is skipped on load and cut off by
+// the next open(). A record whose checksum fails is skipped but left in
+// place; intact records are never rewritten or cut off. A damaged length
+// field (the next record can no longer be found) makes open() fail.
+
+struct HistoryRecord {
+    int64_t startMs = 0;       // wall clock at start, ms since the epoch (UTC)
+    uint64_t durationUs = 0;
+    std::string operation;     // "AES-GCM Encrypt", "SHA-256", ...
+    std::string algorithm;     // "AES-256-GCM", "SHA-256", ...
+    std::string input;         // input path
+    uint64_t inputBytes = 0;
+    uint64_t outputBytes = 0;
+    bool ok = true;
+    std::string error;         // failure reason (empty if ok)
+    std::string host;          // filled by append() if empty
+    std::string version;       // filled by append() if empty
+
+    double seconds() const { return durationUs / 1e6; }
+    double mbPerSecond() const { return durationUs ? inputBytes / static_cast<double>(durationUs) : 0; }
+};
+
+class HistoryStore {
+public:
+    HistoryStore() = default;
+    ~HistoryStore();
+    HistoryStore(const HistoryStore&) = delete;
+    HistoryStore& operator=(const HistoryStore&) = delete;
+
+    // Opens (creating it and its directory if missing) the store at `path`.
+    bool open(const std::string& path, std::string& error);
+    void close();
+    const std::string& path() const { return storePath; }
+
+    bool append(HistoryRecord record);  // thread-safe
+
+    // The last `limit` valid records (0 = all), oldest first.
+    std::vector<HistoryRecord> load(size_t limit = 0) const;
+
+    // "$XDG_DATA_HOME/CryptoQtApp/history.cqah" (~/.local/share/... without XDG_DATA_HOME).
+    static std::string defaultPath();
+
+private:
+    int fd = -1;
+    std::string storePath;
+    mutable std::mutex mutex;
+};
+
+// Reads a store file without opening it for appending (CLI export).
+bool loadHistory(const std::string& path, std::vector<HistoryRecord>& records, std::string& error);
+
+// One JSON object per record, keys in snake_case, ending in '\n'.
+std::string historyJsonLine(const HistoryRecord& record);
+
+// Current wall clock in ms since the epoch, for HistoryRecord::startMs.
+int64_t historyNowMs();
@@ -0,0 +1,139 @@
+#include "jobmodel.h"
+#include "jobs.h"       // Job counters and state
+
+#include <QFileInfo>    // file name column
+
+// ---------------- Helper functions ------------------
+
+static QString formatDuration(double seconds) {
+    const qint64 s = static_cast<qint64>(seconds + 0.5);
+    if (s >= 3600) return QString("%1h %2m").arg(s / 3600).arg(s / 60 % 60);
+    if (s >= 60) return QString("%1m %2s").arg(s / 60).arg(s % 60);
+    return QString("%1s").arg(s);
+}
+
+
+// ---------------- JobTableModel ------------------
+
+JobTableModel::JobTableModel(QObject* parent) : QAbstractTableModel(parent) {}
+
+
+int JobTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(rows.size());
+}
+
+
+int JobTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+
+QVariant JobTableModel::data(const QModelIndex& index, int role) const {
+    if (role != Qt::DisplayRole || !index.isValid() || index.row() < 0
+        || static_cast<size_t>(index.row()) >= rows.size() || index.column() < 0 || index.column() >= ColumnCount)
+        return QVariant();
+    return rows[static_cast<size_t>(index.row())].cells[index.column()];
+}
+
+
+QVariant JobTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    static const char* const names[ColumnCount] = { "Operation", "File", "Progress", "Throughput", "ETA", "State" };
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section < 0 || section >= ColumnCount)
+        return QAbstractTableModel::headerData(section, orientation, role);
+    return QString(names[section]);
+}
+
+
+std::shared_ptr<Job> JobTableModel::jobAt(int row) const {
+    if (row < 0 || static_cast<size_t>(row) >= rows.size()) return nullptr;
+    return rows[static_cast<size_t>(row)].job;
+}
+
+
+/**
+ * @brief Recomputes one row's cells from its job's counters.
+ *
+ * Throughput is averaged over the job's active time (pauses excluded), and
+ * the ETA extrapolates it over the bytes left.
+ *
+ * @return true if any cell changed.
+ */
+bool JobTableModel::sample(Row& row) {
+    const Job& job = *row.job;
+    const JobState state = job.state();
+    const uint64_t done = job.doneBytes(), total = job.spec().totalBytes;
+    const double seconds = job.activeSeconds();
+    const double mbps = seconds > 0 ? done / seconds / 1e6 : 0;
+
+    QString eta = "-";
+    if (state == JobState::Running && mbps > 0 && total > done) eta = formatDuration((total - done) / 1e6 / mbps);
+    QString stateText = jobStateName(state);
+    if (state == JobState::Failed) stateText += ": " + QString::fromStdString(job.error());
+
+    QString cells[ColumnCount];
+    cells[Operation] = QString::fromStdString(job.spec().operation);
+    cells[File] = QFileInfo(QString::fromStdString(job.spec().input)).fileName();
+    cells[Progress] = total ? QString("%1%").arg(done >= total ? 100 : done * 100 / total)
+                            : QString("%1 MB").arg(done / 1e6, 0, 'f', 1);
+    cells[Throughput] = seconds > 0 ? QString("%1 MB/s").arg(mbps, 0, 'f', 1) : QString("-");
+    cells[Eta] = eta;
+    cells[State] = stateText;
+
+    row.finished = jobFinished(state);
+    bool changed = false;
+    for (int c = 0; c < ColumnCount; ++c) {
+        if (row.cells[c] == cells[c]) continue;
+        row.cells[c] = cells[c];
+        changed = true;
+    }
+    return changed;
+}
+
+
+/**
+ * @brief Brings the rows up to date with the queue's job list.
+ *
+ * @param jobs JobQueue::jobs() (submission order).
+ * @return true while any job is unfinished.
+ */
+bool JobTableModel::refresh(const std::vector<std::shared_ptr<Job>>& jobs) {
+    bool prefix = jobs.size() >= rows.size();
+    for (size_t i = 0; prefix && i < rows.size(); ++i) prefix = rows[i].job == jobs[i];
+    if (!prefix) { ///< jobs were removed: rebuild once
+        beginResetModel();
+        rows.clear();
+        for (const std::shared_ptr<Job>& job : jobs) {
+            rows.push_back(Row());
+            rows.back().job = job;
+            sample(rows.back());
+        }
+        endResetModel();
+    } else if (jobs.size() > rows.size()) {
+        const int first = static_cast<int>(rows.size());
+        beginInsertRows(QModelIndex(), first, static_cast<int>(jobs.size()) - 1);
+        for (size_t i = rows.size(); i < jobs.size(); ++i) {
+            rows.push_back(Row());
+            rows.back().job = jobs[i];
+            sample(rows.back());
+        }
+        endInsertRows();
+    }
+
+    bool active = false;
+    int dirtyFirst = -1; ///< start of the current run of changed rows
+    for (size_t i = 0; i <= rows.size(); ++i) {
+        bool dirty = false;
+        if (i < rows.size()) {
+            Row& row = rows[i];
+            if (!row.finished) dirty = sample(row);
+            if (!row.finished) active = true;
+        }
+        const int r = static_cast<int>(i);
+        if (dirty && dirtyFirst < 0) dirtyFirst = r;
+        if (!dirty && dirtyFirst >= 0) {
+            emit dataChanged(index(dirtyFirst, 0), index(r - 1, ColumnCount - 1), { Qt::DisplayRole });
+            dirtyFirst = -1;
+        }
+    }
+    return active;
+}
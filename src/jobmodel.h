@@ -0,0 +1,44 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <QAbstractTableModel> // job list model
+#include <QString>
+
+#include <memory>              // shared job handles
+#include <vector>              // rows
+
+class Job;  // jobs.h
+
+// Table model of the GUI job list. refresh() samples the jobs' counters and
+// emits dataChanged only for rows whose text changed, merged into runs of
+// adjacent rows, so a tick over a long list of finished jobs costs one
+// comparison per row and no repaint. New jobs are appended with one
+// beginInsertRows; a shorter or reordered list (Clear Finished) resets the
+// model.
+
+class JobTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { Operation, File, Progress, Throughput, Eta, State, ColumnCount };
+
+    explicit JobTableModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool refresh(const std::vector<std::shared_ptr<Job>>& jobs); // true while any job is unfinished
+    std::shared_ptr<Job> jobAt(int row) const;                  // null for an invalid row
+
+private:
+    struct Row {
+        std::shared_ptr<Job> job;
+        QString cells[ColumnCount];
+        bool finished = false; ///< cells hold the final state and are not sampled again
+    };
+
+    bool sample(Row& row);     // recomputes the cells; true if any changed
+
+    std::vector<Row> rows;
+};
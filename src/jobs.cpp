@@ -0,0 +1,516 @@
+#include "jobs.h"
+#include "consumer.h"      // decrypt into a command, fifo or socket
+#include "container.h"     // encryptContainer / readContainer
+#include "streamcipher.h"  // encryptStream / decryptStream (.aescbc)
+#include "streamhash.h"    // makeHash, digest sidecars
+#include "throttle.h"      // background throttle for GUI jobs
+#include "workerpool.h"    // shared pool
+
+#include <cerrno>      // EEXIST
+#include <vector>      // hash buffer
+
+#include <fcntl.h>     // open
+#include <sys/stat.h>  // stat
+#include <unistd.h>    // close, fdatasync, unlink
+
+// Crypto++ includes
+#include <cryptopp/cryptlib.h> // CryptoPP::Exception
+
+using namespace CryptoPP;
+using Clock = std::chrono::steady_clock;
+
+const char* jobStateName(JobState state) {
+    switch (state) {
+    case JobState::Queued: return "queued";
+    case JobState::Running: return "running";
+    case JobState::Paused: return "paused";
+    case JobState::Done: return "done";
+    case JobState::Failed: return "failed";
+    case JobState::Cancelled: return "cancelled";
+    }
+    return "?";
+}
+
+
+// ---------------- Job ------------------
+
+Job::Job(uint64_t id, JobSpec spec) : jobId(id), jobSpec(std::move(spec)) {}
+
+
+JobState Job::state() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return current;
+}
+
+
+double Job::activeSeconds() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current != JobState::Running) return activeBefore;
+    return activeBefore + std::chrono::duration<double>(Clock::now() - activeSince).count();
+}
+
+
+std::string Job::error() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failure;
+}
+
+
+void Job::pause() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current != JobState::Running) return;
+    activeBefore += std::chrono::duration<double>(Clock::now() - activeSince).count();
+    current = JobState::Paused;
+    pauseFlag = true;
+}
+
+
+void Job::resume() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current != JobState::Paused) return;
+    activeSince = Clock::now();
+    current = JobState::Running;
+    pauseFlag = false;
+    resumed.notify_all();
+}
+
+
+void Job::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (jobFinished(current)) return;
+    cancelFlag = true;
+    if (current == JobState::Queued) current = JobState::Cancelled; ///< JobQueue skips it
+    resumed.notify_all();
+}
+
+
+/**
+ * @brief Progress and control point of a running job, called between chunks.
+ *
+ * @param bytes Input bytes processed since the last call.
+ * @return false if the job was cancelled; the body should stop and clean up.
+ */
+bool Job::checkpoint(uint64_t bytes) {
+    done.fetch_add(bytes, std::memory_order_relaxed);
+    if (pauseFlag.load(std::memory_order_relaxed)) {
+        std::unique_lock<std::mutex> lock(mutex);
+        resumed.wait(lock, [this] { return current != JobState::Paused || cancelFlag.load(); });
+    }
+    return !cancelFlag.load(std::memory_order_relaxed);
+}
+
+
+ByteReader Job::track(ByteReader in) {
+    return [this, in = std::move(in)](unsigned char* buf, size_t n) -> ssize_t {
+        const ssize_t got = in(buf, n);
+        if (got < 0) return got;
+        return checkpoint(static_cast<uint64_t>(got)) ? got : -1;
+    };
+}
+
+
+bool Job::begin() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current != JobState::Queued) return false;
+    current = JobState::Running;
+    activeSince = Clock::now();
+    return true;
+}
+
+
+/**
+ * @brief Records the outcome of the job body.
+ *
+ * A cancel that arrives after the body got past its last checkpoint does
+ * not stop it; the body then returns "" with its output published, and the
+ * job counts as Done rather than Cancelled.
+ */
+void Job::finish(const std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current == JobState::Running)
+        activeBefore += std::chrono::duration<double>(Clock::now() - activeSince).count();
+    pauseFlag = false;
+    if (cancelFlag && !error.empty()) {
+        current = JobState::Cancelled;
+    } else {
+        current = error.empty() ? JobState::Done : JobState::Failed;
+        failure = error;
+    }
+}
+
+
+// ---------------- JobQueue ------------------
+
+/**
+ * @brief Running-job limit for a requested value (0 = default).
+ *
+ * A paused job blocks its pool thread, so jobs never take every thread of
+ * the shared pool: at least one stays free for batch runs and parallel
+ * ciphers even when all jobs are paused.
+ */
+static unsigned runningLimit(unsigned requested) {
+    const unsigned poolThreads = WorkerPool::shared().size();
+    const unsigned cap = poolThreads > 1 ? poolThreads - 1 : 1;
+    return requested && requested < cap ? requested : cap;
+}
+
+
+JobQueue::JobQueue(unsigned maxRunning) : maxRunning(runningLimit(maxRunning)) {}
+
+
+JobQueue::~JobQueue() {
+    stopping = true;
+    for (Expander& e : expanders) e.thread.join(); ///< sinks call add(), so not under the mutex
+    std::unique_lock<std::mutex> lock(mutex);
+    for (const std::shared_ptr<Job>& job : list) job->cancel();
+    idle.wait(lock, [this] { return running == 0; });
+}
+
+
+std::shared_ptr<Job> JobQueue::add(JobSpec spec) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<Job> job(new Job(nextId++, std::move(spec)));
+    list.push_back(job);
+    startQueued();
+    return job;
+}
+
+
+/**
+ * @brief Expands a directory tree into jobs on a background thread.
+ *
+ * @param root Directory to walk.
+ * @param walk Walker options (globs, threads).
+ * @param makeJob Builds the job for an absolute file path; called from walker threads.
+ */
+void JobQueue::addTree(const std::string& root, const WalkOptions& walk,
+                       std::function<JobSpec(const std::string& path)> makeJob) {
+    for (size_t i = 0; i < expanders.size();) { ///< reap walks that are done
+        if (expanders[i].finished->load()) {
+            expanders[i].thread.join();
+            expanders.erase(expanders.begin() + static_cast<std::ptrdiff_t>(i));
+        } else {
+            ++i;
+        }
+    }
+    ++expanding;
+    auto finished = std::make_shared<std::atomic<bool>>(false);
+    std::thread thread([this, root, walk, makeJob = std::move(makeJob), finished] {
+        WalkStats stats;
+        std::string error;
+        const std::string prefix = root.empty() || root.back() == '/' ? root : root + "/";
+        const bool ok = walkTree(root, walk, [&](const WalkedFile& f) {
+            if (stopping.load(std::memory_order_relaxed)) return false;
+            add(makeJob(prefix + f.path));
+            return true;
+        }, stats, error);
+        if (!ok && !stopping) {
+            JobSpec failed;
+            failed.operation = "Expand folder";
+            failed.input = root;
+            failed.run = [error](Job&) { return error; };
+            add(std::move(failed));
+        }
+        --expanding;
+        *finished = true;
+    });
+    expanders.push_back({ std::move(thread), finished });
+}
+
+
+std::vector<std::shared_ptr<Job>> JobQueue::jobs() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return list;
+}
+
+
+void JobQueue::removeFinished() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::shared_ptr<Job>> kept;
+    size_t keptBeforeNext = 0;
+    for (size_t i = 0; i < list.size(); ++i) {
+        if (jobFinished(list[i]->state())) continue;
+        if (i < nextToStart) ++keptBeforeNext;
+        kept.push_back(list[i]);
+    }
+    list.swap(kept);
+    nextToStart = keptBeforeNext;
+}
+
+
+void JobQueue::setMaxRunning(unsigned n) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxRunning = runningLimit(n);
+    startQueued();
+}
+
+
+void JobQueue::setFinishedHook(std::function<void(const Job&)> hook) {
+    std::lock_guard<std::mutex> lock(mutex);
+    finishedHook = std::move(hook);
+}
+
+
+/**
+ * @brief Starts queued jobs in order while running slots are free.
+ *
+ * Each job runs as one pool task under the background throttle; when it
+ * ends, its task starts the next queued job.
+ */
+void JobQueue::startQueued() {
+    while (running < maxRunning && nextToStart < list.size()) {
+        std::shared_ptr<Job> job = list[nextToStart++];
+        if (job->state() != JobState::Queued) continue; ///< cancelled before it started
+        ++running;
+        WorkerPool::shared().submit([this, job] {
+            if (job->begin()) {
+                ThrottleScope scope(&Throttle::background());
+                std::string error;
+                try {
+                    error = job->spec().run(*job);
+                } catch (const std::exception& e) { ///< Crypto++ exceptions included
+                    error = e.what();
+                }
+                job->finish(error);
+                std::function<void(const Job&)> hook;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    hook = finishedHook;
+                }
+                if (hook) hook(*job);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            --running;
+            startQueued();
+            idle.notify_all();
+        });
+    }
+}
+
+
+// ---------------- File jobs ------------------
+
+static bool endsWith(const std::string& s, const char* suffix) {
+    const std::string x(suffix);
+    return s.size() > x.size() && s.compare(s.size() - x.size(), x.size(), x) == 0;
+}
+
+static std::string baseName(const std::string& path) {
+    const size_t slash = path.rfind('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+
+/**
+ * @brief Hashes the job's input into "<src>.sha256" (sha256sum format).
+ */
+static std::string hashJob(Job& job, int in) {
+    std::unique_ptr<HashTransformation> hash = makeHash("SHA-256");
+    const ByteReader read = job.track(fdReader(in));
+    std::vector<unsigned char> buf(kStreamChunkBytes);
+    for (;;) {
+        const ssize_t n = read(buf.data(), buf.size());
+        if (n < 0) return job.cancelled() ? "cancelled" : "read failed";
+        hash->Update(buf.data(), static_cast<size_t>(n));
+        if (static_cast<size_t>(n) < buf.size()) break;
+    }
+    return writeDigestSidecar(job.spec().output, { { finalHex(*hash), baseName(job.spec().input) } }, false);
+}
+
+
+/**
+ * @brief Runs one file operation: input through the cipher into "<dst>.part", then rename.
+ *
+ * The stat() below only gives an early, friendly error. What guarantees
+ * that an output is never replaced is the exclusive create of the .part
+ * (two jobs for the same input never share it) and renameNoReplace() at
+ * the end (an output that appeared meanwhile is kept).
+ */
+static std::string runFileJob(Job& job, FileJobKind kind, const SecByteBlock& key, size_t ivBytes,
+                              uint32_t chunkSize) {
+    const std::string& src = job.spec().input;
+    const std::string& dst = job.spec().output;
+    struct stat st;
+    if (::stat(dst.c_str(), &st) == 0) return "output already exists: " + dst;
+    int in = ::open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return "cannot open input";
+    tuneStreamFd(in);
+    if (kind == FileJobKind::Sha256) {
+        std::string error = hashJob(job, in);
+        ::close(in);
+        return error;
+    }
+
+    const std::string tmp = dst + ".part";
+    int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (out < 0) {
+        const bool exists = errno == EEXIST;
+        ::close(in);
+        return exists ? "output in progress: " + tmp : "cannot create output";
+    }
+    const ByteReader read = job.track(fdReader(in));
+    const ByteWriter write = fdWriter(out);
+    std::string error;
+    bool ok;
+    try {
+        switch (kind) {
+        case FileJobKind::EncryptCbc:
+            ok = encryptStream(read, write, key, ivBytes, error);
+            break;
+        case FileJobKind::DecryptCbc:
+            ok = decryptStream(read, write, key, ivBytes, error);
+            break;
+        case FileJobKind::EncryptContainer:
+            ok = encryptContainer(read, write, key, chunkSize, error);
+            break;
+        default: {
+            ContainerReport rep = readContainer(read, write, key);
+            ok = rep.status == ContainerReport::Status::Ok;
+            if (!ok) error = describeContainerStatus(rep.status);
+            break;
+        }
+        }
+    } catch (const Exception& e) {
+        ok = false;
+        error = e.what();
+    }
+    ::close(in);
+    if (!ok && job.cancelled()) error = "cancelled";
+    if (ok && ::fdatasync(out) != 0) {
+        ok = false;
+        error = "sync failed";
+    }
+    if (::close(out) != 0 && ok) {
+        ok = false;
+        error = "close failed";
+    }
+    if (ok && !renameNoReplace(tmp, dst)) {
+        ok = false;
+        error = errno == EEXIST ? "output already exists: " + dst : "rename failed";
+    }
+    if (!ok) ::unlink(tmp.c_str());
+    return error;
+}
+
+
+void fileJobWalkFilters(FileJobKind kind, WalkOptions& walk) {
+    switch (kind) {
+    case FileJobKind::DecryptCbc: walk.include.push_back("*.aescbc"); break;
+    case FileJobKind::DecryptContainer: walk.include.push_back("*.cqac"); break;
+    default:
+        for (const char* own : { "*.aescbc", "*.cqac", "*.sha256", "*.part" }) walk.exclude.push_back(own);
+        break;
+    }
+}
+
+
+/**
+ * @brief Body of a decrypt job that streams into a consumer instead of a file.
+ *
+ * Nothing is written to disk. The job runs at the consumer's pace; pause
+ * and cancel still take effect between chunks, and a cancel also ends a
+ * wait on a consumer that is not reading.
+ */
+static std::string runConsumerJob(Job& job, FileJobKind kind, const SecByteBlock& key, size_t ivBytes,
+                                  const ConsumerSpec& to) {
+    int in = ::open(job.spec().input.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return "cannot open input";
+    tuneStreamFd(in);
+    const std::function<bool()> stop = [&job] { return job.cancelled(); };
+    PlaintextConsumer consumer;
+    std::string error;
+    if (!consumer.open(to, error, stop)) {
+        ::close(in);
+        return job.cancelled() ? "cancelled" : error;
+    }
+    const ByteReader read = job.track(fdReader(in));
+    const ByteWriter write = consumer.writer(stop);
+    bool ok;
+    try {
+        if (kind == FileJobKind::DecryptCbc) {
+            ok = decryptStream(read, write, key, ivBytes, error);
+        } else {
+            ContainerReport rep = readContainer(read, write, key);
+            ok = rep.status == ContainerReport::Status::Ok;
+            if (!ok) error = describeContainerStatus(rep.status);
+        }
+    } catch (const Exception& e) {
+        ok = false;
+        error = e.what();
+    }
+    ::close(in);
+    if (ok) ok = consumer.finish(error);
+    else if (!consumer.writeError().empty()) error = consumer.writeError();
+    consumer.abort(); ///< no-op after finish(); kills a command before its stdin sees EOF
+    if (!ok && job.cancelled()) error = "cancelled";
+    return error;
+}
+
+
+/**
+ * @brief Fills in the fields shared by file and consumer jobs.
+ */
+static JobSpec baseFileJob(FileJobKind kind, const std::string& src, const SecByteBlock& key) {
+    static const char* const names[] = { "AES Encrypt", "AES Decrypt", "AES-GCM Encrypt", "AES-GCM Decrypt",
+                                         "SHA-256" };
+    JobSpec spec;
+    spec.operation = names[static_cast<int>(kind)];
+    spec.input = src;
+    const std::string aes = "AES-" + std::to_string(key.size() * 8);
+    switch (kind) {
+    case FileJobKind::EncryptCbc:
+    case FileJobKind::DecryptCbc: spec.algorithm = aes + "-CBC"; break;
+    case FileJobKind::EncryptContainer:
+    case FileJobKind::DecryptContainer: spec.algorithm = aes + "-GCM"; break;
+    case FileJobKind::Sha256: spec.algorithm = "SHA-256"; break;
+    }
+    struct stat st;
+    if (::stat(src.c_str(), &st) == 0) spec.totalBytes = static_cast<uint64_t>(st.st_size);
+    return spec;
+}
+
+
+/**
+ * @brief Builds the job for one file operation; the output path follows from the input.
+ *
+ * @param kind Operation.
+ * @param src Input file.
+ * @param key AES key (unused for Sha256).
+ * @param ivBytes .aescbc IV size.
+ * @param chunkSize Container record size.
+ */
+JobSpec makeFileJob(FileJobKind kind, const std::string& src, const SecByteBlock& key, size_t ivBytes,
+                    uint32_t chunkSize) {
+    JobSpec spec = baseFileJob(kind, src, key);
+    switch (kind) {
+    case FileJobKind::EncryptCbc: spec.output = src + ".aescbc"; break;
+    case FileJobKind::EncryptContainer: spec.output = src + ".cqac"; break;
+    case FileJobKind::Sha256: spec.output = src + ".sha256"; break;
+    case FileJobKind::DecryptCbc:
+        spec.output = endsWith(src, ".aescbc") ? src.substr(0, src.size() - 7) : src + ".dec";
+        break;
+    case FileJobKind::DecryptContainer:
+        spec.output = endsWith(src, ".cqac") ? src.substr(0, src.size() - 5) : src + ".dec";
+        break;
+    }
+    spec.run = [kind, key, ivBytes, chunkSize](Job& job) { return runFileJob(job, kind, key, ivBytes, chunkSize); };
+    return spec;
+}
+
+
+/**
+ * @brief Builds a decrypt job whose plaintext goes to a consumer (consumer.h).
+ *
+ * @param kind DecryptCbc or DecryptContainer.
+ * @param src Encrypted file.
+ * @param key AES key.
+ * @param ivBytes .aescbc IV size.
+ * @param to Command, named pipe or socket receiving the plaintext.
+ */
+JobSpec makeConsumerJob(FileJobKind kind, const std::string& src, const SecByteBlock& key, size_t ivBytes,
+                        const ConsumerSpec& to) {
+    JobSpec spec = baseFileJob(kind, src, key);
+    spec.output = describeConsumer(to);
+    spec.run = [kind, key, ivBytes, to](Job& job) { return runConsumerJob(job, kind, key, ivBytes, to); };
+    return spec;
+}
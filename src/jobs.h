@@ -0,0 +1,148 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include "consumer.h" // ConsumerSpec
+#include "dirwalk.h"  // background tree expansion
+#include "fdio.h"     // ByteReader
+
+#include <atomic>             // progress / control flags
+#include <chrono>             // active time
+#include <condition_variable> // paused jobs, queue shutdown
+#include <cstddef>            // size_t
+#include <cstdint>            // byte counts
+#include <functional>         // job bodies
+#include <memory>             // shared job handles
+#include <mutex>
+#include <string>             // paths, error text
+#include <thread>             // tree expansion
+#include <vector>             // job list snapshots
+
+#include <cryptopp/secblock.h> // SecByteBlock keys
+
+// Queue of independent operations (one file each) for the GUI job list.
+// Jobs run concurrently on WorkerPool::shared() under the background
+// throttle, at most maxRunning at a time, in submission order. A job's body
+// reads its input through Job::track(), which counts progress and is where
+// pause and cancel take effect (between chunks). A paused job keeps its
+// running slot and pool thread until it is resumed or cancelled, so
+// maxRunning is capped one below the pool size: paused jobs never take the
+// whole pool. A job cancelled after its output was published ends as Done.
+//
+// Directories are expanded with the parallel walker on a background thread
+// per tree, adding a job for each file as it is found, so the caller (a
+// drop handler) returns at once even for huge trees.
+
+enum class JobState { Queued, Running, Paused, Done, Failed, Cancelled };
+
+const char* jobStateName(JobState state);
+inline bool jobFinished(JobState s) { return s == JobState::Done || s == JobState::Failed || s == JobState::Cancelled; }
+
+class Job;
+
+struct JobSpec {
+    std::string operation;                  // shown in the job list
+    std::string algorithm;                  // for the operation history ("" if not applicable)
+    std::string input;                      // input path
+    std::string output;                     // output path ("" if none)
+    uint64_t totalBytes = 0;                // input size for progress / ETA; 0 = unknown
+    std::function<std::string(Job&)> run;   // on a pool thread; returns "" or the failure reason
+};
+
+class Job {
+public:
+    uint64_t id() const { return jobId; }
+    const JobSpec& spec() const { return jobSpec; }
+
+    JobState state() const;
+    uint64_t doneBytes() const { return done.load(std::memory_order_relaxed); }
+    double activeSeconds() const;           // running time so far, pauses excluded
+    std::string error() const;              // failure reason once finished
+
+    void pause();                           // Running -> Paused (takes effect at the next chunk)
+    void resume();
+    void cancel();                          // queued jobs never start; running ones stop at the next chunk
+
+    // For job bodies: counts `bytes`, waits while paused; false once cancelled.
+    bool checkpoint(uint64_t bytes = 0);
+    bool cancelled() const { return cancelFlag.load(std::memory_order_relaxed); }
+    ByteReader track(ByteReader in);        // reader that calls checkpoint() per read (-1 when cancelled)
+
+private:
+    friend class JobQueue;
+    Job(uint64_t id, JobSpec spec);
+
+    bool begin();                           // Queued -> Running, false if cancelled meanwhile
+    void finish(const std::string& error);
+
+    const uint64_t jobId;
+    const JobSpec jobSpec;
+    std::atomic<uint64_t> done{0};
+    std::atomic<bool> cancelFlag{false};
+    std::atomic<bool> pauseFlag{false};     ///< fast path for checkpoint()
+    mutable std::mutex mutex;
+    std::condition_variable resumed;
+    JobState current = JobState::Queued;
+    std::string failure;
+    double activeBefore = 0;                ///< seconds accumulated before the current run stretch
+    std::chrono::steady_clock::time_point activeSince;
+};
+
+class JobQueue {
+public:
+    explicit JobQueue(unsigned maxRunning = 0); // 0 = shared pool size - 1 (also the cap)
+    ~JobQueue();                                // cancels everything and waits for running jobs
+
+    JobQueue(const JobQueue&) = delete;
+    JobQueue& operator=(const JobQueue&) = delete;
+
+    std::shared_ptr<Job> add(JobSpec spec);
+    // Walks `root` in the background and adds makeJob(path) for every file
+    // found. A root that cannot be opened shows up as a failed job.
+    void addTree(const std::string& root, const WalkOptions& walk,
+                 std::function<JobSpec(const std::string& path)> makeJob);
+    unsigned expandingTrees() const { return expanding.load(std::memory_order_relaxed); }
+    std::vector<std::shared_ptr<Job>> jobs() const; // submission order
+    void removeFinished();
+    void setMaxRunning(unsigned n);
+    // Called on the pool thread after each job that ran reaches a final state.
+    void setFinishedHook(std::function<void(const Job&)> hook);
+
+private:
+    void startQueued();                     // with mutex held
+
+    struct Expander {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> finished;
+    };
+    std::vector<Expander> expanders;        ///< touched by the owning thread only
+    std::atomic<unsigned> expanding{0};
+    std::atomic<bool> stopping{false};      ///< ends tree walks on destruction
+    mutable std::mutex mutex;
+    std::condition_variable idle;
+    std::vector<std::shared_ptr<Job>> list;
+    std::function<void(const Job&)> finishedHook;
+    size_t nextToStart = 0;                 ///< first list entry that may still be queued
+    unsigned maxRunning;
+    unsigned running = 0;
+    uint64_t nextId = 1;
+};
+
+// ---------------- File jobs ------------------
+
+enum class FileJobKind { EncryptCbc, DecryptCbc, EncryptContainer, DecryptContainer, Sha256 };
+
+// Walk filters for a file job kind: encrypt and hash jobs skip outputs of
+// this module (.aescbc, .cqac, .sha256, .part); decrypt jobs only take
+// their own format.
+void fileJobWalkFilters(FileJobKind kind, WalkOptions& walk);
+
+// Job for one file: encrypt to "<src>.aescbc" / "<src>.cqac", decrypt to
+// `src` without that extension, or write "<src>.sha256". Outputs go through
+// "<dst>.part", fdatasync and rename; an existing output is never replaced.
+JobSpec makeFileJob(FileJobKind kind, const std::string& src, const CryptoPP::SecByteBlock& key,
+                    size_t ivBytes, uint32_t chunkSize);
+
+// Decrypt job (DecryptCbc or DecryptContainer) that streams the plaintext to
+// a command, named pipe or socket; no output file is written. Its output
+// field names the consumer.
+JobSpec makeConsumerJob(FileJobKind kind, const std::string& src, const CryptoPP::SecByteBlock& key,
+                        size_t ivBytes, const ConsumerSpec& to);
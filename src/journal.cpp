@@ -0,0 +1,249 @@
+#include "journal.h"
+#include "fdio.h"     // writeAll
+
+#include <cstdio>     // rename, snprintf
+#include <cstdlib>    // strtoull, strtoll
+#include <sstream>    // field parsing
+#include <vector>     // file contents
+
+#include <fcntl.h>    // open
+#include <unistd.h>   // read, write, fdatasync, close
+
+// Crypto++ includes
+#include <cryptopp/crc.h> // line checksums
+
+using namespace CryptoPP;
+
+// ---------------- Helper functions ------------------
+
+/**
+ * @brief CRC32 of a line body as 8 hex digits.
+ */
+static std::string lineChecksum(const std::string& body) {
+    CRC32 crc;
+    byte d[CRC32::DIGESTSIZE];
+    crc.CalculateDigest(d, reinterpret_cast<const byte*>(body.data()), body.size());
+    char hex[9];
+    std::snprintf(hex, sizeof(hex), "%02x%02x%02x%02x", d[0], d[1], d[2], d[3]);
+    return hex;
+}
+
+
+static std::string escapePath(const std::string& path) {
+    std::string out;
+    for (char c : path) {
+        if (c == '%') out += "%25";
+        else if (c == '\n') out += "%0A";
+        else if (c == '\r') out += "%0D";
+        else out += c;
+    }
+    return out;
+}
+
+
+static std::string unescapePath(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '%' && i + 2 < text.size()) {
+            out += static_cast<char>(std::strtoul(text.substr(i + 1, 2).c_str(), nullptr, 16));
+            i += 2;
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+
+/**
+ * @brief Formats one checksummed journal line.
+ */
+static std::string formatLine(char type, const std::string& fields, const std::string& path) {
+    std::string body(1, type);
+    if (!fields.empty()) body += " " + fields;
+    body += " " + escapePath(path);
+    return body + " *" + lineChecksum(body) + "\n";
+}
+
+
+/**
+ * @brief Fields of a Q line: size, mtime, inode, ctime.
+ */
+static std::string identityFields(const JobJournal::Job& j) {
+    return std::to_string(j.size) + " " + std::to_string(j.mtimeNs) + " " + std::to_string(j.inode) + " "
+           + std::to_string(j.ctimeNs);
+}
+
+
+/**
+ * @brief Applies one verified line to the job map. Unknown types are ignored.
+ */
+static void applyLine(const std::string& body, std::unordered_map<std::string, JobJournal::Job>& jobs) {
+    std::istringstream in(body);
+    char type;
+    in >> type;
+    std::string a, b, c, d;
+    if (type == 'Q') in >> a >> b >> c >> d;
+    else if (type == 'P') in >> a >> b;
+    else if (type == 'D') in >> a;
+    else if (type != 'E') return;
+    in.get(); ///< the single space before the path
+    std::string rest;
+    std::getline(in, rest);
+    const std::string path = unescapePath(rest);
+    if (path.empty()) return;
+
+    JobJournal::Job& job = jobs[path];
+    switch (type) {
+    case 'Q':
+        job = JobJournal::Job();
+        job.size = std::strtoull(a.c_str(), nullptr, 10);
+        job.mtimeNs = std::strtoll(b.c_str(), nullptr, 10);
+        job.inode = std::strtoull(c.c_str(), nullptr, 10);
+        job.ctimeNs = std::strtoll(d.c_str(), nullptr, 10);
+        break;
+    case 'P':
+        job.state = JobJournal::State::InProgress;
+        job.records = std::strtoull(a.c_str(), nullptr, 10);
+        job.outputBytes = std::strtoull(b.c_str(), nullptr, 10);
+        break;
+    case 'D':
+        job.state = JobJournal::State::Done;
+        job.outputHash = a;
+        break;
+    default:
+        job.state = JobJournal::State::Failed;
+        break;
+    }
+}
+
+
+// ---------------- JobJournal ------------------
+
+JobJournal::~JobJournal() {
+    close();
+}
+
+
+/**
+ * @brief Loads the journal, rewrites it compacted (temp + rename) and opens it for appending.
+ *
+ * @param path Journal file.
+ * @param error Receives a description on failure.
+ * @return true if the journal is ready.
+ */
+bool JobJournal::open(const std::string& path, std::string& error) {
+    close();
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.clear();
+
+    int in = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in >= 0) {
+        std::string text;
+        std::vector<char> buf(1 << 16);
+        ssize_t n;
+        while ((n = ::read(in, buf.data(), buf.size())) > 0) text.append(buf.data(), static_cast<size_t>(n));
+        ::close(in);
+
+        size_t pos = 0, nl;
+        while ((nl = text.find('\n', pos)) != std::string::npos) { ///< a last line without '\n' is torn
+            std::string line = text.substr(pos, nl - pos);
+            pos = nl + 1;
+            size_t star = line.rfind(" *");
+            if (star == std::string::npos) continue;
+            std::string body = line.substr(0, star);
+            if (line.compare(star + 2, std::string::npos, lineChecksum(body)) != 0) continue;
+            applyLine(body, jobs);
+        }
+    }
+
+    // compact: identity + latest state per job
+    std::string compacted;
+    for (const auto& kv : jobs) {
+        const Job& j = kv.second;
+        compacted += formatLine('Q', identityFields(j), kv.first);
+        if (j.state == State::InProgress)
+            compacted += formatLine('P', std::to_string(j.records) + " " + std::to_string(j.outputBytes), kv.first);
+        else if (j.state == State::Done)
+            compacted += formatLine('D', j.outputHash, kv.first);
+        else if (j.state == State::Failed)
+            compacted += formatLine('E', std::string(), kv.first);
+    }
+    const std::string tmp = path + ".tmp";
+    int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    bool ok = out >= 0 && writeAll(out, compacted.data(), compacted.size()) && ::fdatasync(out) == 0;
+    if (out >= 0) ok = (::close(out) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        error = "cannot write journal " + path;
+        return false;
+    }
+
+    fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd < 0) {
+        error = "cannot open journal " + path;
+        return false;
+    }
+    return true;
+}
+
+
+void JobJournal::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0) {
+        ::fdatasync(fd);
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+
+bool JobJournal::lookup(const std::string& path, Job& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(path);
+    if (it == jobs.end()) return false;
+    out = it->second;
+    return true;
+}
+
+
+size_t JobJournal::jobCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size();
+}
+
+
+/**
+ * @brief Appends one line (single write with O_APPEND) and updates the in-memory state.
+ *
+ * Journal write errors are not fatal: the batch still runs, it just resumes
+ * less precisely after a crash.
+ */
+void JobJournal::append(char type, const std::string& fields, const std::string& path, bool sync) {
+    const std::string line = formatLine(type, fields, path);
+    std::lock_guard<std::mutex> lock(mutex);
+    applyLine(line.substr(0, line.rfind(" *")), jobs);
+    if (fd < 0) return;
+    writeAll(fd, line.data(), line.size());
+    if (sync) ::fdatasync(fd);
+}
+
+
+void JobJournal::queued(const std::string& path, const Job& identity) {
+    append('Q', identityFields(identity), path, false);
+}
+
+
+void JobJournal::progress(const std::string& path, uint64_t records, uint64_t outputBytes) {
+    append('P', std::to_string(records) + " " + std::to_string(outputBytes), path, true);
+}
+
+
+void JobJournal::done(const std::string& path, const std::string& outputHashHex) {
+    append('D', outputHashHex, path, false);
+}
+
+
+void JobJournal::failed(const std::string& path) {
+    append('E', std::string(), path, false);
+}
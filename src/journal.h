@@ -0,0 +1,64 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <cstdint>        // sizes, offsets
+#include <mutex>          // appends from worker threads
+#include <string>         // paths
+#include <unordered_map>  // latest state per job
+
+// Append-only journal of batch job states, so an interrupted batch run
+// resumes instead of starting over.
+//
+// One text line per state change, ending in " *<crc32 hex>":
+//   Q <size> <mtime ns> <inode> <ctime ns> <path>  queued (input identity)
+//   P <records> <output bytes> <path>   in progress: records durable in <output>.part
+//   D <sha256 hex> <path>               done: output published, digest of the output
+//   E <path>                            failed
+// Paths are relative to the batch source and %-escaped. A torn last line or
+// a line with a bad checksum is ignored, so a crash mid-append loses at most
+// that one update. A progress entry is only written after the partial output
+// it describes has been fdatasync'ed, so it never claims more than is on disk.
+// Q lines from older builds (without inode and ctime) are ignored, so their
+// jobs start over.
+// On open, the journal is compacted to the latest entry per job.
+
+class JobJournal {
+public:
+    enum class State { Queued, InProgress, Done, Failed };
+
+    struct Job {
+        State state = State::Queued;
+        uint64_t size = 0;        // input size when queued
+        int64_t mtimeNs = 0;      // input mtime when queued
+        uint64_t inode = 0;       // input inode when queued
+        int64_t ctimeNs = 0;      // input ctime when queued (any write or rename bumps it)
+        uint64_t records = 0;     // InProgress: complete records in the partial output
+        uint64_t outputBytes = 0; // InProgress: valid prefix of the partial output
+        std::string outputHash;   // Done: SHA-256 of the output (hex)
+    };
+
+    JobJournal() = default;
+    ~JobJournal();
+    JobJournal(const JobJournal&) = delete;
+    JobJournal& operator=(const JobJournal&) = delete;
+
+    // Loads (and compacts) the journal at `path`, creating it if missing.
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    // Latest state of a job; false if the journal has never seen it.
+    bool lookup(const std::string& path, Job& out) const;
+
+    void queued(const std::string& path, const Job& identity); // size, mtimeNs, inode, ctimeNs
+    void progress(const std::string& path, uint64_t records, uint64_t outputBytes); // syncs the journal
+    void done(const std::string& path, const std::string& outputHashHex);
+    void failed(const std::string& path);
+
+    size_t jobCount() const;
+
+private:
+    void append(char type, const std::string& fields, const std::string& path, bool sync);
+
+    int fd = -1;
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Job> jobs;
+};
@@ -0,0 +1,169 @@
+#include "logview.h"
+
+#include <QBrush>       // level colours
+#include <QColor>
+#include <QComboBox>    // level filter
+#include <QDateTime>    // entry timestamps
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QListView>    // virtualized rendering
+#include <QPushButton>
+#include <QScrollBar>   // follow the tail
+#include <QVBoxLayout>
+
+static const size_t kMaxLineBytes = 1024; ///< longer entries are cut, keeping the ring's memory bounded
+
+// ---------------- LogModel ------------------
+
+LogModel::LogModel(size_t capacity, QObject* parent)
+    : QAbstractListModel(parent), ring(capacity ? capacity : 1) {}
+
+
+int LogModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(rows.size());
+}
+
+
+/**
+ * @brief Formats one row on demand ("hh:mm:ss.zzz  LEVEL  text"), coloured by level.
+ */
+QVariant LogModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() < 0 || static_cast<size_t>(index.row()) >= rows.size()) return QVariant();
+    const LogLine& line = ring[rows[static_cast<size_t>(index.row())] % ring.size()];
+    if (role == Qt::DisplayRole) {
+        return QString("%1  %2  %3")
+            .arg(QDateTime::fromMSecsSinceEpoch(line.timeMs).toString("hh:mm:ss.zzz"))
+            .arg(logLevelName(line.level), -5)
+            .arg(QString::fromStdString(line.text));
+    }
+    if (role == Qt::ForegroundRole) {
+        if (line.level == LogLevel::Error) return QBrush(QColor(Qt::red));
+        if (line.level == LogLevel::Warning) return QBrush(QColor(Qt::darkYellow));
+        if (line.level == LogLevel::Debug) return QBrush(QColor(Qt::gray));
+    }
+    return QVariant();
+}
+
+
+/**
+ * @brief Appends a batch of entries, overwriting the oldest once the ring is full.
+ *
+ * Rows of overwritten entries are removed first (one beginRemoveRows), then
+ * the new shown entries are inserted (one beginInsertRows), so a batch costs
+ * two model notifications whatever its size. Of a batch larger than the ring
+ * only the newest `capacity` entries are kept.
+ *
+ * @param lines Entries, oldest first; moved from.
+ */
+void LogModel::append(std::vector<LogLine>& lines) {
+    if (lines.empty()) return;
+    const size_t capacity = ring.size();
+    const size_t skip = lines.size() > capacity ? lines.size() - capacity : 0;
+    nextSeq += skip;
+    const uint64_t end = nextSeq + (lines.size() - skip);
+    if (end - firstSeq > capacity) firstSeq = end - capacity;
+
+    size_t evicted = 0;
+    while (evicted < rows.size() && rows[evicted] < firstSeq) ++evicted;
+    if (evicted) {
+        beginRemoveRows(QModelIndex(), 0, static_cast<int>(evicted) - 1);
+        rows.erase(rows.begin(), rows.begin() + static_cast<std::ptrdiff_t>(evicted));
+        endRemoveRows();
+    }
+
+    std::vector<uint64_t> added;
+    for (size_t i = skip; i < lines.size(); ++i) {
+        const uint64_t seq = nextSeq++;
+        LogLine& slot = ring[seq % capacity]; ///< its previous entry's row, if any, was removed above
+        slot = std::move(lines[i]);
+        if (slot.text.size() > kMaxLineBytes) slot.text.resize(kMaxLineBytes);
+        if (shown(slot)) added.push_back(seq);
+    }
+    if (!added.empty()) {
+        const int first = static_cast<int>(rows.size());
+        beginInsertRows(QModelIndex(), first, first + static_cast<int>(added.size()) - 1);
+        rows.insert(rows.end(), added.begin(), added.end());
+        endInsertRows();
+    }
+}
+
+
+/**
+ * @brief Shows only entries at or above `level`; rebuilds the rows from the ring.
+ */
+void LogModel::setMinimumLevel(LogLevel level) {
+    beginResetModel();
+    minLevel = level;
+    rows.clear();
+    for (uint64_t seq = firstSeq; seq < nextSeq; ++seq)
+        if (shown(ring[seq % ring.size()])) rows.push_back(seq);
+    endResetModel();
+}
+
+
+void LogModel::clear() {
+    beginResetModel();
+    rows.clear();
+    firstSeq = nextSeq;
+    endResetModel();
+}
+
+
+// ---------------- LogView ------------------
+
+LogView::LogView(size_t capacity, QWidget* parent) : QWidget(parent) {
+    model = new LogModel(capacity, this);
+    list = new QListView;
+    list->setModel(model);
+    list->setUniformItemSizes(true); ///< row geometry without measuring every row
+    list->setLayoutMode(QListView::Batched);
+    list->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+    levelCombo = new QComboBox;
+    for (LogLevel level : { LogLevel::Debug, LogLevel::Info, LogLevel::Warning, LogLevel::Error })
+        levelCombo->addItem(QString("Log: %1 and above").arg(logLevelName(level)));
+    levelCombo->setCurrentIndex(static_cast<int>(LogLevel::Info));
+    countLabel = new QLabel;
+    QPushButton* clearBtn = new QPushButton("Clear Log");
+
+    QHBoxLayout* row = new QHBoxLayout;
+    row->addWidget(levelCombo);
+    row->addWidget(countLabel);
+    row->addWidget(clearBtn);
+    QVBoxLayout* layout = new QVBoxLayout;
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addLayout(row);
+    layout->addWidget(list);
+    setLayout(layout);
+
+    connect(levelCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        model->setMinimumLevel(static_cast<LogLevel>(index));
+        list->scrollToBottom();
+    });
+    connect(clearBtn, &QPushButton::clicked, this, [this] {
+        model->clear();
+        countLabel->clear();
+    });
+}
+
+
+/**
+ * @brief Adds a batch of entries (from the UI channel) and updates the counter.
+ */
+void LogView::append(std::vector<LogLine>& lines) {
+    if (lines.empty()) return;
+    QScrollBar* bar = list->verticalScrollBar();
+    const bool atEnd = bar->value() == bar->maximum(); ///< do not yank the view while the user reads older rows
+    model->append(lines);
+    if (atEnd) list->scrollToBottom();
+    countLabel->setText(QString("%1 events").arg(model->logged()));
+}
+
+
+void LogView::log(LogLevel level, const QString& text) {
+    std::vector<LogLine> lines(1);
+    lines[0].level = level;
+    lines[0].timeMs = QDateTime::currentMSecsSinceEpoch();
+    lines[0].text = text.toStdString();
+    append(lines);
+}
@@ -0,0 +1,60 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <QAbstractListModel> // ring-backed list model
+#include <QWidget>            // log panel
+
+#include "uichannel.h"        // LogLevel, LogLine
+
+#include <cstdint>
+#include <deque>              // visible rows
+#include <vector>             // ring storage
+
+class QComboBox;
+class QListView;
+class QLabel;
+
+// Status log of the main window. Entries live in a fixed-capacity ring: once
+// it is full each new entry overwrites the oldest, so memory stays constant
+// however many events are logged. Only entries at or above the selected level
+// are rows of the model; the list view asks for the visible rows only
+// (uniform item sizes), so scrolling cost does not depend on the log size.
+
+class LogModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit LogModel(size_t capacity, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    void append(std::vector<LogLine>& lines); // moves the lines in; one remove + one insert per call
+    void setMinimumLevel(LogLevel level);
+    void clear();
+    uint64_t logged() const { return nextSeq; } // entries ever appended
+
+private:
+    bool shown(const LogLine& line) const { return line.level >= minLevel; }
+
+    std::vector<LogLine> ring;    ///< entry seq lives in ring[seq % capacity]
+    uint64_t nextSeq = 0;
+    uint64_t firstSeq = 0;        ///< oldest entry still stored (after clear(): first new one)
+    std::deque<uint64_t> rows;    ///< seqs of the shown entries, ascending
+    LogLevel minLevel = LogLevel::Info;
+};
+
+class LogView : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit LogView(size_t capacity = 10000, QWidget* parent = nullptr);
+
+    void append(std::vector<LogLine>& lines); // stays scrolled to the end if it was there
+    void log(LogLevel level, const QString& text);
+
+private:
+    LogModel* model;
+    QListView* list;
+    QComboBox* levelCombo;
+    QLabel* countLabel;
+};
@@ -1,7 +1,11 @@
 #include <QApplication>
 #include "mainwindow.h"
+#include "cli.h"
 
 int main(int argc, char *argv[]) {
+    if (argc > 1 && isCliCommand(argv[1]))
+        return runCli(argc, argv); // headless filter mode, no display needed
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
@@ -1,16 +1,41 @@
 #include "mainwindow.h"      // header for MainWindow class
+#include "appconfig.h"       // config.json loading (shared with the CLI)
+#include "armor.h"           // ASCII-armored ciphertext
+#include "async.h"           // coroutine engine API on the Qt event loop
+#include "consumer.h"        // decrypt jobs feeding a command, fifo or socket
+#include "container.h"       // chunked authenticated container (.cqac)
+#include "fdio.h"            // memory / descriptor byte streams
+#include "history.h"         // operation history with timings
+#include "jobmodel.h"        // job list rows
+#include "jobs.h"            // job list: concurrent file operations
+#include "signing.h"         // Ed25519 signatures over SHA-512 file digests
+#include "streamhash.h"      // fused encrypt digests, digest sidecars
+#include "throttle.h"        // background job rate / concurrency limits
+#include "uichannel.h"       // coalesced worker -> GUI updates
+#include "workerpool.h"      // shared worker pool for batch operations
 
 // Qt GUI and utility includes
 #include <QFileDialog>       // file open/save dialog
 #include <QVBoxLayout>       // vertical layout manager
 #include <QHBoxLayout>       // horizontal layout manager
 #include <QFile>             // file I/O (read/write files)
-#include <QJsonDocument>     // handle JSON documents
-#include <QJsonObject>       // JSON objects
 #include <QMessageBox>       // popup message dialogs
 #include <QDir>              // directory handling
 #include <QFileInfo>         // file information (name, size, path, etc.)
 #include <QTextStream>       // read/write text to files
+#include <QHeaderView>       // job table column sizing
+#include <QTableWidget>      // history browser
+#include <QDragEnterEvent>   // drag-and-drop onto the window
+#include <QDropEvent>
+#include <QMimeData>         // dropped URLs
+#include <QUrl>
+#include <QDialog>           // history browser
+#include <QInputDialog>      // decrypt-to consumer
+#include <QElapsedTimer>     // operation timings for the history
+#include <QDateTime>
+
+#include <cstdio>            // rename
+#include <unistd.h>          // fdatasync
 
 // Crypto++ includes
 #include <cryptopp/sha.h>    // SHA hashing (SHA-1, SHA-256, etc.)
@@ -23,6 +48,15 @@
 
 using namespace CryptoPP;
 
+// Ed25519 batch running on the worker pool; the GUI polls it from batchTimer
+struct SignatureBatch {
+    bool verify = false;
+    std::vector<SignatureEntry> entries;
+    std::atomic<size_t> completed{0}; ///< entries finished so far
+    std::atomic<bool> finished{false};
+    size_t valid = 0;                 ///< verify only, written before finished is set
+};
+
 // ---------------- Helper functions ------------------
 
 /**
@@ -75,8 +109,16 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     opCombo->addItem("Generate Symmetric Key");
     opCombo->addItem("AES Encrypt (file)");
     opCombo->addItem("AES Decrypt (file)");
+    opCombo->addItem("AES-GCM Encrypt (container)");
+    opCombo->addItem("AES-GCM Decrypt (container)");
+    opCombo->addItem("Verify Container (file)");
     opCombo->addItem("SHA-256 Digest (file)");
     opCombo->addItem("HMAC-SHA256 (file)");
+    opCombo->addItem("Generate Ed25519 Key Pair");
+    opCombo->addItem("Ed25519 Sign (file)");
+    opCombo->addItem("Ed25519 Verify (file)");
+    opCombo->addItem("Ed25519 Sign Batch (file list)");
+    opCombo->addItem("Ed25519 Verify Batch (manifest)");
     // opCombo->addItem("Verify HMAC (file with appended MAC)");
 
     keyHexEdit = new QLineEdit;
@@ -85,6 +127,77 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     hmacKeyEdit = new QLineEdit;
     hmacKeyEdit->setPlaceholderText("HMAC key (hex) optional");
 
+    signKeyEdit = new QLineEdit;
+    signKeyEdit->setPlaceholderText("Ed25519 key (hex): secret||public to sign, public to verify");
+
+    // background job limits, applied immediately (also to a running batch)
+    rateLimitSpin = new QSpinBox;
+    rateLimitSpin->setRange(0, 100000);
+    rateLimitSpin->setSuffix(" MB/s");
+    rateLimitSpin->setSpecialValueText("Unlimited I/O");
+    workerLimitSpin = new QSpinBox;
+    workerLimitSpin->setRange(0, 1024);
+    workerLimitSpin->setPrefix("Workers: ");
+    workerLimitSpin->setSpecialValueText("Workers: all cores");
+    ioClassCombo = new QComboBox;
+    ioClassCombo->addItem("I/O class: default");
+    ioClassCombo->addItem("I/O class: best-effort");
+    ioClassCombo->addItem("I/O class: idle");
+
+    digestCheck = new QCheckBox("Encrypt: also record plaintext + ciphertext digests (saved as <file>.sha256)");
+    armorCheck = new QCheckBox("Encrypt: save ciphertext ASCII-armored (.asc, for text-only transports)");
+
+    batchTimer = new QTimer(this);
+    batchTimer->setInterval(100);
+
+    // job list: file operations queued and run side by side on the worker pool
+    jobQueue = std::make_shared<JobQueue>();
+    jobModel = new JobTableModel(this);
+    jobTable = new QTableView;
+    jobTable->setModel(jobModel);
+    jobTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    jobTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    jobTable->horizontalHeader()->setStretchLastSection(true);
+    queueJobBtn = new QPushButton("Queue Job");
+    consumerJobBtn = new QPushButton("Decrypt To...");
+    pauseJobBtn = new QPushButton("Pause / Resume");
+    cancelJobBtn = new QPushButton("Cancel Job");
+    clearJobsBtn = new QPushButton("Clear Finished");
+    jobTimer = new QTimer(this);
+    jobTimer->setInterval(250);
+    historyBtn = new QPushButton("History...");
+
+    // workers report through the channel; the GUI samples it at 30 Hz instead of per chunk
+    ui = std::make_shared<UiChannel>();
+    uiTimer = new QTimer(this);
+    uiTimer->setInterval(33);
+
+    // operation history: every finished operation and job, with its timing
+    history = std::make_shared<HistoryStore>();
+    jobQueue->setFinishedHook([store = history, channel = ui](const Job& job) {
+        HistoryRecord rec;
+        rec.durationUs = static_cast<uint64_t>(job.activeSeconds() * 1e6);
+        rec.startMs = historyNowMs() - static_cast<int64_t>(rec.durationUs / 1000); ///< pauses excluded
+        rec.operation = job.spec().operation;
+        rec.algorithm = job.spec().algorithm;
+        rec.input = job.spec().input;
+        rec.inputBytes = job.doneBytes();
+        rec.ok = job.state() == JobState::Done;
+        rec.error = job.state() == JobState::Cancelled ? "cancelled" : job.error();
+        if (rec.ok && !job.spec().output.empty())
+            rec.outputBytes = static_cast<uint64_t>(QFileInfo(QString::fromStdString(job.spec().output)).size());
+        QString line = QString("[job %1] %2 %3: %4, %5 MB/s")
+                           .arg(job.id())
+                           .arg(QString::fromStdString(rec.operation), QString::fromStdString(rec.input),
+                                jobStateName(job.state()))
+                           .arg(rec.mbPerSecond(), 0, 'f', 1);
+        if (!rec.error.empty()) line += " (" + QString::fromStdString(rec.error) + ")";
+        const LogLevel level = rec.ok ? LogLevel::Info
+                               : job.state() == JobState::Cancelled ? LogLevel::Warning : LogLevel::Error;
+        channel->log(level, line.toStdString()); ///< shown by onUiTick, never blocks the job
+        store->append(std::move(rec));
+    });
+
     progressBar = new QProgressBar;
     progressBar->setRange(0, 100);
     progressBar->setValue(0);
@@ -93,6 +206,8 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     outputText = new QTextEdit;
     outputText->setReadOnly(true);
     outputText->setFixedHeight(120);
+    logView = new LogView(10000);
+    logView->setMinimumHeight(140);
 
     QHBoxLayout* topRow = new QHBoxLayout;
     topRow->addWidget(uploadBtn);
@@ -100,14 +215,34 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     topRow->addWidget(downloadBtn);
     topRow->addWidget(genKeyBtn);
 
+    QHBoxLayout* limitRow = new QHBoxLayout;
+    limitRow->addWidget(rateLimitSpin);
+    limitRow->addWidget(workerLimitSpin);
+    limitRow->addWidget(ioClassCombo);
+
+    QHBoxLayout* jobRow = new QHBoxLayout;
+    jobRow->addWidget(queueJobBtn);
+    jobRow->addWidget(consumerJobBtn);
+    jobRow->addWidget(pauseJobBtn);
+    jobRow->addWidget(cancelJobBtn);
+    jobRow->addWidget(clearJobsBtn);
+    jobRow->addWidget(historyBtn);
+
     QVBoxLayout* layout = new QVBoxLayout;
     layout->addWidget(opCombo);
     layout->addWidget(keyHexEdit);
     layout->addWidget(hmacKeyEdit);
+    layout->addWidget(signKeyEdit);
+    layout->addWidget(digestCheck);
+    layout->addWidget(armorCheck);
     layout->addLayout(topRow);
+    layout->addLayout(limitRow);
     layout->addWidget(progressBar);
     layout->addWidget(statusLabel);
     layout->addWidget(outputText);
+    layout->addWidget(logView);
+    layout->addLayout(jobRow);
+    layout->addWidget(jobTable);
 
     central->setLayout(layout);
 
@@ -115,10 +250,27 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     connect(processBtn, &QPushButton::clicked, this, &MainWindow::onProcess);
     connect(downloadBtn, &QPushButton::clicked, this, &MainWindow::onDownload);
     connect(genKeyBtn, &QPushButton::clicked, this, &MainWindow::onGenerateKey);
+    connect(rateLimitSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onThrottleChanged);
+    connect(workerLimitSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onThrottleChanged);
+    connect(ioClassCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onThrottleChanged);
+    connect(batchTimer, &QTimer::timeout, this, &MainWindow::onBatchTick);
+    connect(queueJobBtn, &QPushButton::clicked, this, &MainWindow::onQueueJob);
+    connect(consumerJobBtn, &QPushButton::clicked, this, &MainWindow::onQueueConsumerJob);
+    connect(pauseJobBtn, &QPushButton::clicked, this, &MainWindow::onPauseJob);
+    connect(cancelJobBtn, &QPushButton::clicked, this, &MainWindow::onCancelJob);
+    connect(clearJobsBtn, &QPushButton::clicked, this, &MainWindow::onClearJobs);
+    connect(jobTimer, &QTimer::timeout, this, &MainWindow::onJobTick);
+    connect(historyBtn, &QPushButton::clicked, this, &MainWindow::onShowHistory);
+    connect(uiTimer, &QTimer::timeout, this, &MainWindow::onUiTick);
+
+    setAcceptDrops(true); ///< dropped files / folders become jobs (dropEvent)
 
     loadConfig();
+    std::string historyError;
+    if (!history->open(HistoryStore::defaultPath(), historyError)) ///< operations still work, just unrecorded
+        setStatus(QString("History disabled: %1").arg(QString::fromStdString(historyError)), LogLevel::Warning);
     setWindowTitle("Crypto S/W App1");
-    resize(720, 480);
+    resize(720, 820);
 }
 
 
@@ -127,8 +279,9 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
  *
  * @param s The status message to display.
  */
-void MainWindow::setStatus(const QString& s) {
+void MainWindow::setStatus(const QString& s, LogLevel level) {
     statusLabel->setText(s);
+    logView->log(level, s);
 }
 
 
@@ -138,24 +291,26 @@ void MainWindow::setStatus(const QString& s) {
  * If the file doesn't exist or is invalid, default values are used instead.
  */
 void MainWindow::loadConfig() {
-    QFile f("config.json");
-    if (!f.open(QFile::ReadOnly)) { ///< Try to open config file
+    CryptoConfig cfg;
+    switch (loadCryptoConfig("config.json", cfg)) {
+    case ConfigStatus::Missing:
         setStatus("Could not open config.json — using defaults");
         return; ///< Use defaults if file missing
-    }
-
-    QByteArray data = f.readAll(); ///< Read entire file
-    QJsonDocument doc = QJsonDocument::fromJson(data); ///< Parse JSON
-    if (!doc.isObject()) { ///< Check if valid JSON object
-        setStatus("config.json invalid — using defaults");
+    case ConfigStatus::Invalid:
+        setStatus("config.json invalid — using defaults", LogLevel::Warning);
         return; ///< Use defaults if invalid
+    case ConfigStatus::Loaded:
+        break;
     }
 
-    QJsonObject obj = doc.object();
-    ///< Read config values, provide defaults if missing
-    aesKeyBytes   = obj.value("aes_key_bytes").toInt(32);
-    aesIvBytes    = obj.value("aes_iv_bytes").toInt(16);
-    hmacKeyBytes  = obj.value("hmac_key_bytes").toInt(32);
+    aesKeyBytes   = cfg.aesKeyBytes;
+    aesIvBytes    = cfg.aesIvBytes;
+    hmacKeyBytes  = cfg.hmacKeyBytes;
+    if (makeHash(cfg.hashAlgorithm.toStdString())) {
+        hashAlgorithm = cfg.hashAlgorithm;
+        digestCheck->setText(QString("Encrypt: also record plaintext + ciphertext digests (saved as <file>.%1)")
+                             .arg(QString::fromStdString(hashShortName(hashAlgorithm.toStdString()))));
+    }
 }
 
 
@@ -190,6 +345,31 @@ bool MainWindow::writeByteArrayToFile(const QString& path, const QByteArray& dat
 }
 
 
+/**
+ * @brief Writes binary ciphertext to a file as ASCII armor, one chunk at a time.
+ *
+ * @param label Armor label (armor.h) naming the ciphertext format.
+ * @param hash Optional digest of the armored text as written (may be null).
+ * @return true if the whole armor block was written.
+ */
+static bool writeArmoredFile(const QString& path, const QByteArray& data, const char* label,
+                             HashTransformation* hash) {
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    ArmorWriter armor(hashingWriter([&f](const unsigned char* text, size_t n) {
+        return f.write(reinterpret_cast<const char*>(text), static_cast<qint64>(n)) == static_cast<qint64>(n);
+    }, hash), label);
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data.constData());
+    const size_t total = static_cast<size_t>(data.size());
+    bool ok = true;
+    for (size_t at = 0; ok && at < total; at += kStreamChunkBytes)
+        ok = armor.update(bytes + at, std::min(kStreamChunkBytes, total - at));
+    ok = ok && armor.final();
+    f.close();
+    return ok;
+}
+
+
 /**
  * @brief Opens a file dialog for the user to select a file.
  *
@@ -253,6 +433,29 @@ void MainWindow::onGenerateKey() {
 }
 
 
+/**
+ * @brief Generates a new Ed25519 signing key pair.
+ *
+ * Shows secret||public in hex in the signing key field; Download saves both
+ * halves, so the public key can be handed to verifiers separately.
+ */
+void MainWindow::generateSigningKey() {
+    Ed25519KeyPair kp;
+    generateEd25519KeyPair(kp);
+
+    lastGeneratedSigningKeyHex = QString::fromStdString(formatEd25519Key(kp));
+    signKeyEdit->setText(lastGeneratedSigningKeyHex);
+
+    lastAction = LastAction::GeneratedSigningKey;
+    processedData.clear();
+    lastOutputIsText = false;
+    lastTextOutput.clear();
+
+    setStatus("Generated Ed25519 key pair (shown in hex)");
+    outputText->setPlainText("Ed25519 key pair generated. Click Download to save it.");
+}
+
+
 /**
  * @brief Saves the last generated key pair or processed output to a file.
  *
@@ -282,7 +485,7 @@ void MainWindow::onDownload() {
         // Write keys to file
         QFile f(file);
         if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-            setStatus("Failed to save key pair");
+            setStatus("Failed to save key pair", LogLevel::Error);
             return;
         }
 
@@ -296,6 +499,39 @@ void MainWindow::onDownload() {
         return;
     }
 
+    // Case 1b: last action was signing key generation
+    if (lastAction == LastAction::GeneratedSigningKey) {
+        QString file = QFileDialog::getSaveFileName(
+            this,
+            "Save signing key pair",
+            "signing.ed25519.hex",
+            "Ed25519 key pair (*.ed25519.hex);;All Files (*)"
+        );
+        if (file.isEmpty()) return; ///< User canceled
+
+        Ed25519KeyPair kp;
+        if (!parseEd25519Key(lastGeneratedSigningKeyHex.toStdString(), kp)) {
+            setStatus("Generated signing key is no longer valid");
+            return;
+        }
+        Ed25519KeyPair pubOnly;
+        pubOnly.publicKey = kp.publicKey;
+
+        QFile f(file);
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            setStatus("Failed to save signing key pair", LogLevel::Error);
+            return;
+        }
+        QTextStream out(&f);
+        out << "ed25519_key_hex:" << lastGeneratedSigningKeyHex << "\n";
+        out << "ed25519_public_key_hex:" << QString::fromStdString(formatEd25519Key(pubOnly)) << "\n";
+        f.close();
+
+        setStatus(QString("Saved signing key pair %1").arg(file));
+        QMessageBox::information(this, "Saved", "Signing key pair saved.");
+        return;
+    }
+
     // Case 2: No processed data to save
     if (processedData.isEmpty() && outputText->toPlainText().isEmpty()) {
         QMessageBox::information(this, "Nothing to save", "No processed data to save. Run Process first.");
@@ -310,6 +546,9 @@ void MainWindow::onDownload() {
     QString op = opCombo->currentText();
     QString suggestedExt;
 
+    const bool armored = armorCheck->isChecked() && !lastOutputIsText
+                         && (op == "AES Encrypt (file)" || op == "AES-GCM Encrypt (container)");
+
     if (op.contains("AES Encrypt", Qt::CaseInsensitive)) {
         suggestedExt = ".aescbc";
     } else if (op.contains("AES Decrypt", Qt::CaseInsensitive)) {
@@ -318,10 +557,20 @@ void MainWindow::onDownload() {
         suggestedExt = ".sha256";
     } else if (op.contains("HMAC-SHA256", Qt::CaseInsensitive)) {
         suggestedExt = ".hmac";
+    } else if (op == "AES-GCM Encrypt (container)") {
+        suggestedExt = ".cqac";
+    } else if (op == "Ed25519 Sign (file)") {
+        suggestedExt = ".ed25519sig";
+    } else if (op == "Ed25519 Sign Batch (file list)") {
+        suggestedExt = ".ed25519sigs";
     } else {
         suggestedExt = (lastOutputIsText ? ".txt" : ".bin");
     }
 
+    if (armored) {
+        suggestedExt += ".asc";
+    }
+
     QString defaultName = baseName;
     if (!defaultName.endsWith(suggestedExt, Qt::CaseInsensitive)) {
         defaultName += suggestedExt;
@@ -345,7 +594,7 @@ void MainWindow::onDownload() {
         if (lastOutputIsText) { ///< Text output
             QFile f(file);
             if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-                setStatus("Failed to save text output");
+                setStatus("Failed to save text output", LogLevel::Error);
                 return;
             }
             QByteArray outBytes = lastTextOutput.toUtf8();
@@ -355,11 +604,32 @@ void MainWindow::onDownload() {
             QMessageBox::information(this, "Saved", "Text output saved.");
             return;
         }
-        // Binary output
-        if (!writeByteArrayToFile(file, processedData)) {
-            setStatus("Failed to save output file");
+        // Binary output, or its armored text (the sidecar then lists the text file's digest)
+        QString cipherDigestHex = lastCipherDigestHex;
+        if (armored) {
+            std::unique_ptr<HashTransformation> textHash;
+            if (!lastPlainDigestHex.isEmpty()) textHash = makeHash(hashAlgorithm.toStdString());
+            const char* label = op == "AES Encrypt (file)" ? kArmorLabelAescbc : kArmorLabelContainer;
+            if (!writeArmoredFile(file, processedData, label, textHash.get())) {
+                setStatus("Failed to save armored output file", LogLevel::Error);
+                return;
+            }
+            if (textHash) cipherDigestHex = QString::fromStdString(finalHex(*textHash));
+        } else if (!writeByteArrayToFile(file, processedData)) {
+            setStatus("Failed to save output file", LogLevel::Error);
             return;
         }
+        if (!lastPlainDigestHex.isEmpty()) { ///< digests computed during encryption
+            const QString sidecar = file + "." + QString::fromStdString(hashShortName(hashAlgorithm.toStdString()));
+            std::string err = writeDigestSidecar(sidecar.toStdString(), {
+                { lastPlainDigestHex.toStdString(), QFileInfo(inputFilePath).fileName().toStdString() },
+                { cipherDigestHex.toStdString(), QFileInfo(file).fileName().toStdString() } });
+            if (!err.empty()) {
+                setStatus(QString("Saved %1, but the digest sidecar failed: %2").arg(file, QString::fromStdString(err)),
+                          LogLevel::Warning);
+                return;
+            }
+        }
         setStatus(QString("Saved %1").arg(file));
         QMessageBox::information(
             this, 
@@ -369,7 +639,7 @@ void MainWindow::onDownload() {
     } else { ///< Fallback: save from outputText
         QFile f(file);
         if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-            setStatus("Failed to save text output");
+            setStatus("Failed to save text output", LogLevel::Error);
             return;
         }
         f.write(outputText->toPlainText().toUtf8());
@@ -388,10 +658,16 @@ void MainWindow::onDownload() {
 // Supports AES encryption/decryption, SHA-256 hashing, and HMAC-SHA256.
 // Updates the progress bar, output text, and internal state with the processed data.
 void MainWindow::onProcess() {
+    lastPlainDigestHex.clear();
+    lastCipherDigestHex.clear();
     if (opCombo->currentText() == "Generate Symmetric Key") {
         onGenerateKey();
         return;
     }
+    if (opCombo->currentText() == "Generate Ed25519 Key Pair") {
+        generateSigningKey();
+        return;
+    }
 
     // For other operations, read input file first
     if (inputFilePath.isEmpty()) {
@@ -399,9 +675,30 @@ void MainWindow::onProcess() {
         return;
     }
 
+    // Signature operations stream their files through SHA-512 themselves
+    if (opCombo->currentText().startsWith("Ed25519")) {
+        processSignatureOp(opCombo->currentText());
+        return;
+    }
+
+    // Container verification streams the file record by record
+    if (opCombo->currentText() == "Verify Container (file)") {
+        verifyContainerFile();
+        return;
+    }
+
+    // Container encryption streams the file on the pool without blocking the UI
+    if (opCombo->currentText() == "AES-GCM Encrypt (container)") {
+        encryptContainerFileAsync();
+        return;
+    }
+
+    const int64_t startMs = historyNowMs();
+    QElapsedTimer elapsed; ///< includes reading the file: the history compares end-to-end throughput
+    elapsed.start();
     QByteArray inputData;
     if (!readFileToByteArray(inputFilePath, inputData)) {
-        setStatus("Failed to read input file");
+        setStatus("Failed to read input file", LogLevel::Error);
         return;
     }
     progressBar->setValue(10);
@@ -409,6 +706,24 @@ void MainWindow::onProcess() {
     try {
         QString op = opCombo->currentText();
 
+        // Armored ciphertext (saved with the armor option, or received as text) is recognized by its BEGIN line
+        if (op.contains("Decrypt") && looksArmored(inputData.constData(), static_cast<size_t>(inputData.size()))) {
+            ArmorReader armor(memoryReader(inputData.constData(), static_cast<size_t>(inputData.size())));
+            std::vector<unsigned char> buf(kStreamChunkBytes);
+            std::string binary;
+            ssize_t n;
+            while ((n = armor.read(buf.data(), buf.size())) > 0) {
+                binary.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+                if (static_cast<size_t>(n) < buf.size()) break;
+            }
+            if (n < 0) {
+                setStatus(QString("Armored input rejected: %1").arg(QString::fromStdString(armor.error())),
+                          LogLevel::Error);
+                return;
+            }
+            inputData = QByteArray(binary.data(), static_cast<int>(binary.size()));
+        }
+
         if (op == "AES Encrypt (file)") {
             // ensure symmetric key present; if not, generate one and show it
             if (keyHexEdit->text().isEmpty()) {
@@ -446,6 +761,17 @@ void MainWindow::onProcess() {
             processedData.append(ciphertext.data(), (int)ciphertext.size());
 
             outputText->setPlainText(QString("Encryption successful. Ciphertext size (IV + ciphertext): %1 bytes").arg(processedData.size()));
+            if (digestCheck->isChecked()) {
+                // both buffers are already in memory: no second read of the input file
+                std::unique_ptr<HashTransformation> plainHash = makeHash(hashAlgorithm.toStdString());
+                std::unique_ptr<HashTransformation> cipherHash = makeHash(hashAlgorithm.toStdString());
+                plainHash->Update(reinterpret_cast<const byte*>(inputData.constData()), inputData.size());
+                cipherHash->Update(reinterpret_cast<const byte*>(processedData.constData()), processedData.size());
+                lastPlainDigestHex = QString::fromStdString(finalHex(*plainHash));
+                lastCipherDigestHex = QString::fromStdString(finalHex(*cipherHash));
+                outputText->append(QString("%1 plaintext:  %2\n%1 ciphertext: %3")
+                                   .arg(hashAlgorithm, lastPlainDigestHex, lastCipherDigestHex));
+            }
             setStatus("Encryption done (no HMAC)");
             progressBar->setValue(100);
             lastAction = LastAction::ProcessedData;
@@ -453,7 +779,7 @@ void MainWindow::onProcess() {
         } else if (op == "AES Decrypt (file)") {
             // Expect input: IV || ciphertext  (no HMAC)
             if (inputData.size() < aesIvBytes) {
-                setStatus("Input too small to contain IV");
+                setStatus("Input too small to contain IV", LogLevel::Error);
                 return;
             }
 
@@ -520,6 +846,34 @@ void MainWindow::onProcess() {
             setStatus("Decryption done");
             progressBar->setValue(100);
             lastAction = LastAction::ProcessedData;
+        } else if (op == "AES-GCM Decrypt (container)") {
+            if (keyHexEdit->text().isEmpty()) {
+                QMessageBox::warning(this, "Key required", "Please provide symmetric key (hex) or click Generate Key.");
+                return;
+            }
+            std::string keyHex = keyHexEdit->text().toStdString();
+            SecByteBlock key(aesKeyBytes);
+            StringSource ssKey(keyHex, true, new HexDecoder(new ArraySink(key, key.size())));
+
+            std::string recovered;
+            ContainerReport rep = readContainer(memoryReader(inputData.constData(), inputData.size()),
+                                                stringWriter(recovered), key);
+            if (rep.status != ContainerReport::Status::Ok) {
+                processedData.clear(); ///< never hand out plaintext of a container that failed to authenticate
+                setStatus(QString("Container decryption failed: %1").arg(describeContainerStatus(rep.status)),
+                          LogLevel::Error);
+                recordOperation(op, startMs, elapsed.nsecsElapsed() / 1000, inputData.size(), 0,
+                                describeContainerStatus(rep.status));
+                return;
+            }
+            processedData = QByteArray(recovered.data(), static_cast<int>(recovered.size()));
+
+            outputText->setPlainText(QString("Decryption successful. %1 records authenticated, plaintext size: %2 bytes")
+                                     .arg(rep.records).arg(processedData.size()));
+            setStatus("Container decryption done");
+            progressBar->setValue(100);
+            lastAction = LastAction::ProcessedData;
+            lastOutputIsText = false;
         } else if (op == "SHA-256 Digest (file)") {
             SHA256 hash;
             std::string digest;
@@ -586,11 +940,736 @@ void MainWindow::onProcess() {
             setStatus("Operation not implemented yet");
             return;
         }
+        const qint64 outputBytes = processedData.isEmpty() ? lastTextOutput.toUtf8().size() : processedData.size();
+        recordOperation(op, startMs, elapsed.nsecsElapsed() / 1000, inputData.size(), outputBytes, QString());
     } catch (const Exception& e) {
-        setStatus(QString("Crypto++ error: %1").arg(QString::fromStdString(e.what())));
+        setStatus(QString("Crypto++ error: %1").arg(QString::fromStdString(e.what())), LogLevel::Error);
+        recordOperation(opCombo->currentText(), startMs, elapsed.nsecsElapsed() / 1000, inputData.size(), 0,
+                        QString::fromStdString(e.what()));
     } catch (const std::exception& e) {
-        setStatus(QString("Error: %1").arg(e.what()));
+        setStatus(QString("Error: %1").arg(e.what()), LogLevel::Error);
+        recordOperation(opCombo->currentText(), startMs, elapsed.nsecsElapsed() / 1000, inputData.size(), 0,
+                        QString(e.what()));
     } catch (...) {
-        setStatus("Unknown error during processing");
+        setStatus("Unknown error during processing", LogLevel::Error);
+    }
+}
+
+
+/**
+ * @brief Runs one of the Ed25519 operations on the uploaded file.
+ *
+ * - Sign (file): signs SHA-512(file); the hex signature is the output (.ed25519sig).
+ * - Verify (file): checks the file against its "<file>.ed25519sig" sidecar.
+ * - Sign Batch (file list): the uploaded file lists one path per line; the
+ *   output is a signature manifest ("<sig hex>  <path>" per line).
+ * - Verify Batch (manifest): verifies every line of an uploaded manifest.
+ *
+ * Relative paths in lists/manifests are resolved against the list's directory.
+ * Batch work runs on the shared worker pool.
+ *
+ * @param op The selected operation name from the combo box.
+ */
+void MainWindow::processSignatureOp(const QString& op) {
+    Ed25519KeyPair key;
+    if (!parseEd25519Key(signKeyEdit->text().toStdString(), key)) {
+        QMessageBox::warning(this, "Key required",
+            "Please provide an Ed25519 key (hex) or run Generate Ed25519 Key Pair.");
+        return;
+    }
+    const bool needsSecret = op.startsWith("Ed25519 Sign");
+    if (needsSecret && key.secretKey.empty()) {
+        QMessageBox::warning(this, "Secret key required",
+            "Signing needs the secret||public key (128 hex characters), not only the public key.");
+        return;
+    }
+
+    if (runningBatch) {
+        QMessageBox::information(this, "Busy", "A signature batch is still running.");
+        return;
+    }
+
+    const std::string path = QFile::encodeName(inputFilePath).toStdString();
+    const std::string baseDir = QFile::encodeName(QFileInfo(inputFilePath).absolutePath()).toStdString();
+    std::shared_ptr<SignatureBatch> batch; ///< set by the batch operations
+    progressBar->setValue(10);
+
+    try {
+        if (op == "Ed25519 Sign (file)") {
+            std::string sig;
+            if (!signFileDigest(path, key, sig)) {
+                setStatus("Failed to read input file", LogLevel::Error);
+                return;
+            }
+            QString sigHex = QString::fromStdString(formatEd25519Signature(sig));
+            outputText->setPlainText(sigHex);
+            lastTextOutput = sigHex + "\n";
+            processedData = lastTextOutput.toUtf8();
+            setStatus("Ed25519 signature generated (SHA-512 digest)");
+            lastAction = LastAction::ShaOrHmacText;
+            lastOutputIsText = true;
+        } else if (op == "Ed25519 Verify (file)") {
+            QByteArray sigText;
+            if (!readFileToByteArray(inputFilePath + ".ed25519sig", sigText)) {
+                setStatus("Signature sidecar not found: " + inputFilePath + ".ed25519sig", LogLevel::Error);
+                return;
+            }
+            std::string sig;
+            if (!parseEd25519Signature(sigText.toStdString(), sig)) {
+                setStatus("Signature sidecar is malformed", LogLevel::Error);
+                return;
+            }
+            bool valid = false;
+            if (!verifyFileDigest(path, key, sig, valid)) {
+                setStatus("Failed to read input file", LogLevel::Error);
+                return;
+            }
+            outputText->setPlainText(valid ? "Signature VALID" : "Signature INVALID");
+            setStatus(valid ? "Ed25519 signature valid" : "Ed25519 signature INVALID",
+                      valid ? LogLevel::Info : LogLevel::Error);
+            processedData.clear();
+            lastAction = LastAction::None;
+            lastOutputIsText = false;
+        } else if (op == "Ed25519 Sign Batch (file list)") {
+            QByteArray listText;
+            if (!readFileToByteArray(inputFilePath, listText)) {
+                setStatus("Failed to read input file", LogLevel::Error);
+                return;
+            }
+            batch = std::make_shared<SignatureBatch>();
+            std::vector<SignatureEntry> entries;
+            for (const QByteArray& line : listText.split('\n')) {
+                QByteArray p = line.trimmed();
+                if (p.isEmpty() || p.startsWith('#')) continue;
+                SignatureEntry e;
+                e.path = p.toStdString();
+                entries.push_back(std::move(e));
+            }
+
+            batch->entries = std::move(entries);
+        } else if (op == "Ed25519 Verify Batch (manifest)") {
+            QByteArray manifest;
+            if (!readFileToByteArray(inputFilePath, manifest)) {
+                setStatus("Failed to read input file", LogLevel::Error);
+                return;
+            }
+            std::vector<SignatureEntry> entries;
+            size_t badLine = 0;
+            if (!parseSignatureManifest(manifest.toStdString(), entries, badLine)) {
+                setStatus(QString("Manifest line %1 is malformed").arg(badLine), LogLevel::Error);
+                return;
+            }
+            batch = std::make_shared<SignatureBatch>();
+
+            batch->verify = true;
+            batch->entries = std::move(entries);
+        } else {
+            setStatus("Operation not implemented yet");
+            return;
+        }
+        progressBar->setValue(100);
+        if (!batch) return;
+
+        // Batches run on the pool under the background throttle; the GUI stays
+        // responsive and the limits above can be changed while they run.
+        runningBatch = batch;
+        processBtn->setEnabled(false);
+        progressBar->setValue(0);
+        setStatus(QString("Ed25519 batch running (%1 files)...").arg(batch->entries.size()));
+        WorkerPool::shared().submit([batch, key, baseDir] {
+            ThrottleScope scope(&Throttle::background());
+            if (batch->verify)
+                batch->valid = verifyFilesBatch(batch->entries, key, baseDir, WorkerPool::shared(), &batch->completed);
+            else
+                signFilesBatch(batch->entries, key, baseDir, WorkerPool::shared(), &batch->completed);
+            batch->finished.store(true, std::memory_order_release);
+        });
+        batchTimer->start();
+    } catch (const Exception& e) {
+        setStatus(QString("Crypto++ error: %1").arg(QString::fromStdString(e.what())), LogLevel::Error);
+    } catch (const std::exception& e) {
+        setStatus(QString("Error: %1").arg(e.what()), LogLevel::Error);
     }
-}
\ No newline at end of file
+}
+
+
+/**
+ * @brief Authenticates every record of the uploaded container without producing plaintext.
+ *
+ * The file is streamed, so containers of any size can be checked.
+ */
+void MainWindow::verifyContainerFile() {
+    if (keyHexEdit->text().isEmpty()) {
+        QMessageBox::warning(this, "Key required", "Please provide symmetric key (hex) or click Generate Key.");
+        return;
+    }
+
+    QFile f(inputFilePath);
+    if (!f.open(QFile::ReadOnly)) {
+        setStatus("Failed to read input file", LogLevel::Error);
+        return;
+    }
+    progressBar->setValue(10);
+
+    try {
+        std::string keyHex = keyHexEdit->text().toStdString();
+        SecByteBlock key(aesKeyBytes);
+        StringSource ssKey(keyHex, true, new HexDecoder(new ArraySink(key, key.size())));
+
+        ContainerReport rep = readContainer(fdReader(f.handle()), ByteWriter(), key);
+        if (rep.status == ContainerReport::Status::Ok) {
+            outputText->setPlainText(QString("Container OK: %1 records, %2 plaintext bytes authenticated.")
+                                     .arg(rep.records).arg(rep.plainBytes));
+            setStatus("Container verified");
+        } else {
+            outputText->setPlainText(QString("Container DAMAGED: %1 (record %2).")
+                                     .arg(describeContainerStatus(rep.status)).arg(rep.badRecord));
+            setStatus("Container verification FAILED", LogLevel::Error);
+        }
+        progressBar->setValue(100);
+        processedData.clear();
+        lastAction = LastAction::None;
+        lastOutputIsText = false;
+    } catch (const Exception& e) {
+        setStatus(QString("Crypto++ error: %1").arg(QString::fromStdString(e.what())), LogLevel::Error);
+    }
+}
+
+
+/**
+ * @brief AES-GCM container encryption of the input file without blocking the UI.
+ *
+ * The destination is chosen first; the file is then streamed through
+ * encryptAsync() into "<dst>.part": records are sealed and written on the
+ * worker pool and the coroutine continues on the GUI thread between them,
+ * so the progress bar moves and the window stays responsive. Neither the
+ * input nor the container is ever held in memory as a whole. The part file
+ * is synced and renamed over the destination once the last record is
+ * written, and removed if encryption fails.
+ */
+void MainWindow::encryptContainerFileAsync() {
+    // ensure symmetric key present; if not, generate one and show it
+    if (keyHexEdit->text().isEmpty()) {
+        onGenerateKey();
+    }
+
+    auto file = std::make_shared<QFile>(inputFilePath);
+    if (!file->open(QFile::ReadOnly)) {
+        setStatus("Failed to read input file", LogLevel::Error);
+        return;
+    }
+
+    const bool armored = armorCheck->isChecked();
+    QString base = QFileInfo(inputFilePath).completeBaseName();
+    if (base.isEmpty()) base = "output";
+    const QString dst = QFileDialog::getSaveFileName(this, "Save container", base + (armored ? ".cqac.asc" : ".cqac"),
+                                                     "All Files (*)");
+    if (dst.isEmpty()) return; ///< User canceled
+    auto part = std::make_shared<QFile>(dst + ".part");
+    if (!part->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        setStatus(QString("Cannot create %1").arg(part->fileName()), LogLevel::Error);
+        return;
+    }
+
+    try {
+        std::string keyHex = keyHexEdit->text().toStdString();
+        SecByteBlock key(aesKeyBytes);
+        StringSource ssKey(keyHex, true, new HexDecoder(new ArraySink(key, key.size())));
+
+        auto executor = std::make_shared<QtExecutor>(this);
+        const qint64 total = file->size();
+        AsyncOptions opt;
+        opt.executor = executor.get();
+        opt.chunkSize = kDefaultChunkBytes;
+        opt.progress = [channel = ui, total](uint64_t done) { ///< per record; shown at the next UI tick
+            channel->setProgress(done, static_cast<uint64_t>(total));
+        };
+        // Output side: bytes on disk (armored text if requested) and their digest
+        struct Output {
+            std::unique_ptr<HashTransformation> plain, cipher;
+            StreamDigests streams;
+            std::unique_ptr<ArmorWriter> armor;
+            std::atomic<uint64_t> bytes{0};
+        };
+        auto output = std::make_shared<Output>();
+        if (digestCheck->isChecked()) { ///< hashed on the pool as records pass, no second read
+            output->plain = makeHash(hashAlgorithm.toStdString());
+            output->cipher = makeHash(hashAlgorithm.toStdString());
+            output->streams.plain = output->plain.get();
+            opt.digests = &output->streams;
+        }
+        const ByteWriter disk = fdWriter(part->handle());
+        ByteWriter sink = hashingWriter([disk, output](const unsigned char* p, size_t n) {
+            output->bytes += n;
+            return disk(p, n);
+        }, output->cipher.get()); ///< digest of the file as written, armor included
+        if (armored) {
+            output->armor.reset(new ArmorWriter(sink, kArmorLabelContainer));
+            sink = output->armor->writer();
+        }
+
+        processBtn->setEnabled(false);
+        progressBar->setValue(0);
+        setStatus("Encrypting container...");
+        const int64_t startMs = historyNowMs();
+        auto elapsed = std::make_shared<QElapsedTimer>();
+        elapsed->start();
+        ui->begin();
+        uiTimer->start();
+        spawn(encryptAsync(fdReader(file->handle()), sink, key, opt),
+              [this, file, part, dst, output, executor, total, startMs, elapsed](AsyncResult result) {
+            ui->end();
+            onUiTick(); ///< flush the last progress before the result replaces it
+            file->close();
+            processBtn->setEnabled(true);
+            if (result.ok && output->armor && !output->armor->final()) {
+                result.ok = false;
+                result.error = "write failed";
+            }
+            if (result.ok && ::fdatasync(part->handle()) != 0) { ///< data must be on disk before the name appears
+                result.ok = false;
+                result.error = "cannot sync " + part->fileName().toStdString();
+            }
+            part->close();
+            if (result.ok && std::rename(QFile::encodeName(part->fileName()).constData(),
+                                         QFile::encodeName(dst).constData()) != 0) {
+                result.ok = false;
+                result.error = "cannot rename to " + dst.toStdString();
+            }
+            const uint64_t micros = static_cast<uint64_t>(elapsed->nsecsElapsed() / 1000);
+            if (!result.ok) {
+                part->remove();
+                setStatus(QString("Container encryption failed: %1").arg(QString::fromStdString(result.error)),
+                          LogLevel::Error);
+                recordOperation("AES-GCM Encrypt (container)", startMs, micros, total, 0,
+                                QString::fromStdString(result.error));
+                return;
+            }
+            const uint64_t written = output->bytes.load();
+            recordOperation("AES-GCM Encrypt (container)", startMs, micros, total, written, QString());
+
+            processedData.clear(); ///< already on disk; nothing left for Save
+            outputText->setPlainText(QString("Encryption successful. Container written to %1 (%2 bytes)")
+                                     .arg(dst).arg(written));
+            if (output->plain) {
+                lastPlainDigestHex = QString::fromStdString(finalHex(*output->plain));
+                lastCipherDigestHex = QString::fromStdString(finalHex(*output->cipher));
+                outputText->append(QString("%1 plaintext:  %2\n%1 container:  %3")
+                                   .arg(hashAlgorithm, lastPlainDigestHex, lastCipherDigestHex));
+                const QString sidecar = dst + "." + QString::fromStdString(hashShortName(hashAlgorithm.toStdString()));
+                std::string err = writeDigestSidecar(sidecar.toStdString(), {
+                    { lastPlainDigestHex.toStdString(), QFileInfo(inputFilePath).fileName().toStdString() },
+                    { lastCipherDigestHex.toStdString(), QFileInfo(dst).fileName().toStdString() } });
+                if (!err.empty())
+                    setStatus(QString("Digest sidecar failed: %1").arg(QString::fromStdString(err)), LogLevel::Warning);
+            }
+            setStatus(QString("Container encryption done (AES-GCM, authenticated): %1").arg(dst));
+            progressBar->setValue(100);
+            lastAction = LastAction::None;
+            lastOutputIsText = false;
+        });
+    } catch (const Exception& e) {
+        part->close();
+        part->remove();
+        processBtn->setEnabled(true);
+        setStatus(QString("Crypto++ error: %1").arg(QString::fromStdString(e.what())), LogLevel::Error);
+    }
+}
+
+
+/**
+ * @brief Pushes the limit widgets into the shared background throttle.
+ *
+ * Takes effect at the next chunk / file, including for a batch already running.
+ */
+void MainWindow::onThrottleChanged() {
+    Throttle& t = Throttle::background();
+    t.bandwidth.setRate(static_cast<uint64_t>(rateLimitSpin->value()) << 20);
+    t.workers.setLimit(static_cast<unsigned>(workerLimitSpin->value()));
+    static const IoClass classes[] = { IoClass::Default, IoClass::BestEffort, IoClass::Idle };
+    t.ioClass.store(classes[qBound(0, ioClassCombo->currentIndex(), 2)]);
+}
+
+
+/**
+ * @brief Timer slot: shows batch progress and finishes the batch when done.
+ */
+void MainWindow::onBatchTick() {
+    if (!runningBatch) {
+        batchTimer->stop();
+        return;
+    }
+    size_t total = runningBatch->entries.size();
+    size_t done = runningBatch->completed.load(std::memory_order_relaxed);
+    progressBar->setValue(total ? static_cast<int>(done * 100 / total) : 100);
+    if (runningBatch->finished.load(std::memory_order_acquire))
+        finishSignatureBatch();
+}
+
+
+/**
+ * @brief Publishes the results of a finished Ed25519 batch (manifest or report).
+ */
+void MainWindow::finishSignatureBatch() {
+    batchTimer->stop();
+    std::shared_ptr<SignatureBatch> batch = std::move(runningBatch);
+    processBtn->setEnabled(true);
+    progressBar->setValue(100);
+
+    QString report;
+    if (!batch->verify) {
+        size_t signedCount = 0;
+        for (const SignatureEntry& e : batch->entries) {
+            if (e.status == SignatureEntry::Status::Valid) ++signedCount;
+            else report += QString("UNREADABLE  %1\n").arg(QString::fromStdString(e.path));
+        }
+        lastTextOutput = QString::fromStdString(formatSignatureManifest(batch->entries));
+        processedData = lastTextOutput.toUtf8();
+        outputText->setPlainText(QString("Signed %1 of %2 files.\n").arg(signedCount).arg(batch->entries.size())
+                                 + report + lastTextOutput.left(10000));
+        setStatus(QString("Ed25519 batch signing done (%1 files)").arg(signedCount));
+    } else {
+        for (const SignatureEntry& e : batch->entries) {
+            if (e.status == SignatureEntry::Status::Invalid)
+                report += QString("INVALID     %1\n").arg(QString::fromStdString(e.path));
+            else if (e.status == SignatureEntry::Status::Unreadable)
+                report += QString("UNREADABLE  %1\n").arg(QString::fromStdString(e.path));
+        }
+        outputText->setPlainText(QString("%1 of %2 signatures valid.\n").arg(batch->valid).arg(batch->entries.size())
+                                 + report.left(10000));
+        setStatus(batch->valid == batch->entries.size() ? "All Ed25519 signatures valid"
+                                                        : "Ed25519 batch verification found failures");
+        lastTextOutput = outputText->toPlainText();
+        processedData = lastTextOutput.toUtf8();
+    }
+    lastAction = LastAction::ShaOrHmacText;
+    lastOutputIsText = true;
+}
+
+// ---------------- Job list ------------------
+
+/**
+ * @brief Maps a combo box operation to a file job; false for operations that need the single-result flow.
+ */
+static bool jobKindForOperation(const QString& op, FileJobKind& kind) {
+    if (op == "AES Encrypt (file)") kind = FileJobKind::EncryptCbc;
+    else if (op == "AES Decrypt (file)") kind = FileJobKind::DecryptCbc;
+    else if (op == "AES-GCM Encrypt (container)") kind = FileJobKind::EncryptContainer;
+    else if (op == "AES-GCM Decrypt (container)") kind = FileJobKind::DecryptContainer;
+    else if (op == "SHA-256 Digest (file)") kind = FileJobKind::Sha256;
+    else return false;
+    return true;
+}
+
+
+/**
+ * @brief Decodes the symmetric key for a job; asks for one if it is missing.
+ *
+ * @return false if the key is missing or invalid (the user has been told).
+ */
+bool MainWindow::jobKey(SecByteBlock& key) {
+    key.resize(aesKeyBytes);
+    if (keyHexEdit->text().isEmpty()) {
+        QMessageBox::warning(this, "Key required", "Please provide symmetric key (hex) or click Generate Key.");
+        return false;
+    }
+    try {
+        std::string keyHex = keyHexEdit->text().toStdString();
+        StringSource ssKey(keyHex, true, new HexDecoder(new ArraySink(key, key.size())));
+    } catch (const Exception& e) {
+        setStatus(QString("Crypto++ error: %1").arg(QString::fromStdString(e.what())), LogLevel::Error);
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Captures the selected operation and key as a job builder for file paths.
+ *
+ * Asks for a key if the operation needs one. Returns an empty function if
+ * the operation cannot run as a job or the key is missing or invalid.
+ */
+std::function<JobSpec(const std::string& path)> MainWindow::jobFactory() {
+    FileJobKind kind;
+    if (!jobKindForOperation(opCombo->currentText(), kind)) {
+        setStatus("This operation cannot run as a job; use Process", LogLevel::Warning);
+        return nullptr;
+    }
+    SecByteBlock key(aesKeyBytes);
+    if (kind != FileJobKind::Sha256 && !jobKey(key)) return nullptr;
+    const size_t ivBytes = static_cast<size_t>(aesIvBytes);
+    return [kind, key, ivBytes](const std::string& path) {
+        return makeFileJob(kind, path, key, ivBytes, kDefaultChunkBytes);
+    };
+}
+
+
+/**
+ * @brief Queues the selected operation for the uploaded file as a background job.
+ *
+ * The output is written next to the input (see makeFileJob()), so the job
+ * does not touch processedData and other operations can start meanwhile.
+ */
+void MainWindow::onQueueJob() {
+    if (inputFilePath.isEmpty()) {
+        QMessageBox::warning(this, "No file", "Please upload a file first.");
+        return;
+    }
+    std::function<JobSpec(const std::string&)> makeJob = jobFactory();
+    if (!makeJob) return;
+    std::shared_ptr<Job> job = jobQueue->add(makeJob(inputFilePath.toStdString()));
+    setStatus(QString("Queued job %1: %2").arg(job->id()).arg(QString::fromStdString(job->spec().output)));
+    onJobTick();
+    jobTimer->start();
+    uiTimer->start();
+}
+
+
+/**
+ * @brief Queues a decrypt of the uploaded file that streams into a program instead of a file.
+ *
+ * The consumer is an exec:, fifo: or unix: target (consumer.h). The
+ * plaintext never reaches processedData or the disk, and the job runs at
+ * the consumer's pace.
+ */
+void MainWindow::onQueueConsumerJob() {
+    if (inputFilePath.isEmpty()) {
+        QMessageBox::warning(this, "No file", "Please upload a file first.");
+        return;
+    }
+    FileJobKind kind;
+    if (!jobKindForOperation(opCombo->currentText(), kind)
+        || (kind != FileJobKind::DecryptCbc && kind != FileJobKind::DecryptContainer)) {
+        setStatus("Select AES Decrypt (file) or AES-GCM Decrypt (container) to decrypt into a program",
+                  LogLevel::Warning);
+        return;
+    }
+    bool accepted = false;
+    const QString text = QInputDialog::getText(this, "Decrypt To",
+                                               "exec:COMMAND (reads stdin), fifo:PATH or unix:PATH (socket)",
+                                               QLineEdit::Normal, lastConsumer, &accepted);
+    if (!accepted || text.isEmpty()) return;
+    ConsumerSpec to;
+    std::string error;
+    if (!parseConsumerSpec(text.toStdString(), to, error)) {
+        QMessageBox::warning(this, "Decrypt To", QString::fromStdString(error));
+        return;
+    }
+    SecByteBlock key;
+    if (!jobKey(key)) return;
+    lastConsumer = text;
+    std::shared_ptr<Job> job = jobQueue->add(
+        makeConsumerJob(kind, inputFilePath.toStdString(), key, static_cast<size_t>(aesIvBytes), to));
+    setStatus(QString("Queued job %1: %2").arg(job->id()).arg(QString::fromStdString(job->spec().output)));
+    onJobTick();
+    jobTimer->start();
+    uiTimer->start();
+}
+
+
+void MainWindow::dragEnterEvent(QDragEnterEvent* event) {
+    if (event->mimeData()->hasUrls()) event->acceptProposedAction();
+}
+
+
+/**
+ * @brief Queues the selected operation for every dropped file and every file below dropped folders.
+ *
+ * Folders are expanded by the job queue on a background thread, with the
+ * operation's walk filters, so the drop returns immediately; their jobs
+ * appear in the list as the walk finds them.
+ */
+void MainWindow::dropEvent(QDropEvent* event) {
+    std::function<JobSpec(const std::string&)> makeJob = jobFactory();
+    if (!makeJob) return;
+    FileJobKind kind;
+    jobKindForOperation(opCombo->currentText(), kind);
+    WalkOptions walk;
+    fileJobWalkFilters(kind, walk);
+    walk.statFiles = false; ///< makeFileJob() stats each file itself
+
+    int files = 0, folders = 0;
+    for (const QUrl& url : event->mimeData()->urls()) {
+        if (!url.isLocalFile()) continue;
+        const std::string path = url.toLocalFile().toStdString();
+        if (QFileInfo(url.toLocalFile()).isDir()) {
+            jobQueue->addTree(path, walk, makeJob);
+            ++folders;
+        } else {
+            jobQueue->add(makeJob(path));
+            ++files;
+        }
+    }
+    event->acceptProposedAction();
+    setStatus(QString("Queued %1 file(s); expanding %2 folder(s) in the background").arg(files).arg(folders));
+    onJobTick();
+    jobTimer->start();
+    uiTimer->start();
+}
+
+
+/**
+ * @brief Returns the job in the selected table row, or null.
+ */
+static std::shared_ptr<Job> selectedJob(QTableView* table, const JobTableModel& model) {
+    return model.jobAt(table->currentIndex().row());
+}
+
+
+void MainWindow::onPauseJob() {
+    std::shared_ptr<Job> job = selectedJob(jobTable, *jobModel);
+    if (!job) return;
+    if (job->state() == JobState::Paused) job->resume();
+    else job->pause();
+    onJobTick();
+}
+
+
+void MainWindow::onCancelJob() {
+    std::shared_ptr<Job> job = selectedJob(jobTable, *jobModel);
+    if (!job) return;
+    job->cancel();
+    onJobTick();
+}
+
+
+void MainWindow::onClearJobs() {
+    jobQueue->removeFinished();
+    onJobTick();
+}
+
+
+/**
+ * @brief Refreshes the job table from the jobs' counters; stops sampling once all are finished.
+ */
+void MainWindow::onJobTick() {
+    const bool active = jobModel->refresh(jobQueue->jobs());
+    if (!active && jobQueue->expandingTrees() == 0) jobTimer->stop();
+}
+
+
+// ---------------- Operation history ------------------
+
+/**
+ * @brief Sets one cell of the history table, creating the item on first use.
+ */
+static void setHistoryCell(QTableWidget* table, int row, int column, const QString& text) {
+    QTableWidgetItem* item = table->item(row, column);
+    if (!item) table->setItem(row, column, new QTableWidgetItem(text));
+    else if (item->text() != text) item->setText(text);
+}
+
+
+/**
+ * @brief Algorithm of a GUI operation as recorded in the history ("" if not applicable).
+ */
+static std::string historyAlgorithm(const QString& op, int aesKeyBytes) {
+    const std::string aes = "AES-" + std::to_string(aesKeyBytes * 8);
+    if (op.startsWith("AES-GCM")) return aes + "-GCM";
+    if (op.startsWith("AES")) return aes + "-CBC";
+    if (op.startsWith("SHA-256")) return "SHA-256";
+    if (op.startsWith("HMAC")) return "HMAC-SHA256";
+    return "";
+}
+
+
+/**
+ * @brief Appends one finished GUI operation to the history store.
+ *
+ * @param op Operation as shown in the combo box.
+ * @param startMs Wall clock at start (historyNowMs()).
+ * @param durationUs Elapsed time, including reading the input.
+ * @param inputBytes Bytes read.
+ * @param outputBytes Bytes produced (0 on failure).
+ * @param error Failure reason; empty for success.
+ */
+void MainWindow::recordOperation(const QString& op, int64_t startMs, uint64_t durationUs, uint64_t inputBytes,
+                                 uint64_t outputBytes, const QString& error) {
+    HistoryRecord rec;
+    rec.startMs = startMs;
+    rec.durationUs = durationUs;
+    rec.operation = op.toStdString();
+    rec.algorithm = historyAlgorithm(op, aesKeyBytes);
+    rec.input = inputFilePath.toStdString();
+    rec.inputBytes = inputBytes;
+    rec.outputBytes = outputBytes;
+    rec.ok = error.isEmpty();
+    rec.error = error.toStdString();
+    history->append(std::move(rec));
+}
+
+
+/**
+ * @brief Shows the most recent history records, newest first, with an export to JSON lines.
+ */
+void MainWindow::onShowHistory() {
+    static const size_t kShownRecords = 1000;
+    const std::vector<HistoryRecord> records = history->load(kShownRecords);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(QString("Operation History - %1").arg(QString::fromStdString(history->path())));
+    QTableWidget* table = new QTableWidget(static_cast<int>(records.size()), 8);
+    table->setHorizontalHeaderLabels({ "Started", "Operation", "Algorithm", "File", "Size", "Time", "Throughput",
+                                       "Result" });
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->horizontalHeader()->setStretchLastSection(true);
+    for (size_t i = 0; i < records.size(); ++i) {
+        const HistoryRecord& r = records[records.size() - 1 - i];
+        const int row = static_cast<int>(i);
+        setHistoryCell(table, row, 0, QDateTime::fromMSecsSinceEpoch(r.startMs).toString("yyyy-MM-dd hh:mm:ss"));
+        setHistoryCell(table, row, 1, QString::fromStdString(r.operation));
+        setHistoryCell(table, row, 2, QString::fromStdString(r.algorithm));
+        setHistoryCell(table, row, 3, QFileInfo(QString::fromStdString(r.input)).fileName());
+        setHistoryCell(table, row, 4, QString("%1 MB").arg(r.inputBytes / 1e6, 0, 'f', 1));
+        setHistoryCell(table, row, 5, QString("%1 s").arg(r.seconds(), 0, 'f', 3));
+        setHistoryCell(table, row, 6, QString("%1 MB/s").arg(r.mbPerSecond(), 0, 'f', 1));
+        setHistoryCell(table, row, 7, r.ok ? QString("OK") : "Failed: " + QString::fromStdString(r.error));
+    }
+
+    QPushButton* exportBtn = new QPushButton("Export JSON Lines...");
+    QPushButton* closeBtn = new QPushButton("Close");
+    connect(closeBtn, &QPushButton::clicked, &dialog, &QDialog::accept);
+    connect(exportBtn, &QPushButton::clicked, &dialog, [this, &dialog] {
+        QString path = QFileDialog::getSaveFileName(&dialog, "Export history", "history.jsonl",
+                                                    "JSON lines (*.jsonl);;All files (*)");
+        if (path.isEmpty()) return;
+        QByteArray text;
+        for (const HistoryRecord& r : history->load()) text += QByteArray::fromStdString(historyJsonLine(r));
+        if (writeByteArrayToFile(path, text)) setStatus(QString("History exported to %1").arg(path));
+        else QMessageBox::warning(&dialog, "Export failed", QString("Cannot write %1").arg(path));
+    });
+
+    QHBoxLayout* buttons = new QHBoxLayout;
+    buttons->addWidget(exportBtn);
+    buttons->addWidget(closeBtn);
+    QVBoxLayout* layout = new QVBoxLayout;
+    layout->addWidget(table);
+    layout->addLayout(buttons);
+    dialog.setLayout(layout);
+    dialog.resize(900, 480);
+    dialog.exec();
+}
+
+
+// ---------------- UI updates ------------------
+
+/**
+ * @brief Timer slot: applies what workers reported since the last tick.
+ *
+ * At most kLinesPerTick log lines are appended, in one model update, so a tick costs
+ * the same whether one job or thousands are reporting. Sampling stops once
+ * no work is in flight and nothing is pending.
+ */
+void MainWindow::onUiTick() {
+    static const size_t kLinesPerTick = 200;
+    UiChannel::Sample sample;
+    ui->sample(sample, kLinesPerTick);
+    if (sample.progressChanged) progressBar->setValue(sample.percent);
+    if (sample.statusChanged) setStatus(QString::fromStdString(sample.status));
+    logView->append(sample.lines);
+    if (sample.dropped)
+        logView->log(LogLevel::Warning, QString("%1 log lines dropped (log busy)").arg(sample.dropped));
+    if (sample.idle() && !ui->active() && !jobTimer->isActive()) uiTimer->stop();
+}
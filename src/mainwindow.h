@@ -7,6 +7,26 @@
 #include <QTextEdit>     // multi-line text editor (for logs/output)
 #include <QComboBox>     // drop-down selection box (choose operation)
 #include <QLineEdit>     // single-line text field (enter or show keys)
+#include <QSpinBox>      // numeric limits (rate, workers)
+#include <QCheckBox>     // encrypt options (digests, armor)
+#include <QTimer>        // polls background batch progress
+#include <QTableView>    // job list panel
+
+#include "logview.h"     // bounded status log (LogLevel)
+
+#include <cstdint>       // history timings
+#include <functional>    // job factories
+#include <memory>        // shared batch state
+#include <string>
+
+#include <cryptopp/secblock.h> // job keys
+
+struct SignatureBatch;   // background Ed25519 batch (mainwindow.cpp)
+class JobQueue;          // concurrent file jobs (jobs.h)
+class JobTableModel;     // job list rows (jobmodel.h)
+struct JobSpec;
+class HistoryStore;      // operation history (history.h)
+class UiChannel;         // worker -> GUI progress / log channel (uichannel.h)
 
 class MainWindow : public QMainWindow {
     Q_OBJECT // macro enables Qt’s signals & slots system (automatic event handling like button clicks)
@@ -14,15 +34,38 @@ class MainWindow : public QMainWindow {
 public:
     MainWindow(QWidget* parent = nullptr);
 
+protected:
+    void dragEnterEvent(QDragEnterEvent* event) override; // files / folders from a file manager
+    void dropEvent(QDropEvent* event) override;
+
 private slots: // Event Handlers
     void onUpload();
     void onProcess();
     void onDownload();
     void onGenerateKey();
+    void onThrottleChanged();
+    void onBatchTick();
+    void onQueueJob();
+    void onQueueConsumerJob();
+    void onPauseJob();
+    void onCancelJob();
+    void onClearJobs();
+    void onJobTick();
+    void onShowHistory();
+    void onUiTick();
 
 private:
+    void generateSigningKey();
+    void processSignatureOp(const QString& op);
+    void finishSignatureBatch();
+    void verifyContainerFile();
+    void encryptContainerFileAsync();
+    bool jobKey(CryptoPP::SecByteBlock& key);                     // symmetric key for jobs; false if missing / invalid
+    std::function<JobSpec(const std::string& path)> jobFactory(); // selected operation + key; empty if incomplete
+    void recordOperation(const QString& op, int64_t startMs, uint64_t durationUs, uint64_t inputBytes,
+                         uint64_t outputBytes, const QString& error); // error empty = success
     void loadConfig();
-    void setStatus(const QString& s);
+    void setStatus(const QString& s, LogLevel level = LogLevel::Info); // status line + log entry
     bool readFileToByteArray(const QString& path, QByteArray& out);
     bool writeByteArrayToFile(const QString& path, const QByteArray& data);
 
@@ -32,29 +75,58 @@ private:
     QPushButton* genKeyBtn;
     QProgressBar* progressBar;
     QLabel* statusLabel;
-    QTextEdit* outputText;
+    QTextEdit* outputText;   // result of the last operation
+    LogView* logView;        // every status / job event, ring-buffered
     QComboBox* opCombo;
     QLineEdit* keyHexEdit;   // show symmetric key in hex
     QLineEdit* hmacKeyEdit;  // hmac key in hex (optional)
+    QLineEdit* signKeyEdit;  // Ed25519 key in hex (secret||public signs, public verifies)
+    QSpinBox* rateLimitSpin;   // background read limit in MB/s (0 = unlimited)
+    QSpinBox* workerLimitSpin; // background concurrency (0 = all cores)
+    QComboBox* ioClassCombo;   // Linux I/O class for background work
+    QTimer* batchTimer;        // samples progress of the running batch
+    QCheckBox* digestCheck;    // encrypt: plaintext + ciphertext digests, saved as a sidecar
+    QCheckBox* armorCheck;     // encrypt: save ciphertext as ASCII armor (.asc)
+    QTableView* jobTable;      // queued / running / finished jobs
+    JobTableModel* jobModel;   // rows of jobTable, updated per dirty row
+    QPushButton* queueJobBtn;
+    QPushButton* consumerJobBtn; // decrypt into a command / fifo / socket, no plaintext file
+    QPushButton* pauseJobBtn;
+    QPushButton* cancelJobBtn;
+    QPushButton* clearJobsBtn;
+    QTimer* jobTimer;          // samples job progress while any job is unfinished
+    QPushButton* historyBtn;   // browse / export the operation history
+    QTimer* uiTimer;           // samples the UI channel (30 Hz) while work is in flight
+
+    std::shared_ptr<SignatureBatch> runningBatch; // non-null while a batch runs
+    std::shared_ptr<JobQueue> jobQueue;           // file jobs on the shared pool
+    std::shared_ptr<HistoryStore> history;        // finished operations, shared with the job hook
+    std::shared_ptr<UiChannel> ui;                // progress / status / log lines from workers
 
     QString inputFilePath;
+    QString lastConsumer = "exec:"; // last Decrypt To target
     QByteArray processedData;
 
     // crypto params
     int aesKeyBytes = 32;
     int aesIvBytes = 16;
     int hmacKeyBytes = 32;
+    QString hashAlgorithm = "SHA-256"; // config hash_algorithm, used for encrypt digests
 
     // state tracking for download behavior & previews
     bool lastOutputIsText = false;
     QString lastTextOutput; // UTF-8 text to save if lastOutputIsText == true
+    QString lastPlainDigestHex;  // digests of the last encryption (empty unless requested)
+    QString lastCipherDigestHex;
 
     // keys generated & last action
     QString lastGeneratedSymKeyHex;
     QString lastGeneratedHmacKeyHex;
+    QString lastGeneratedSigningKeyHex;
     enum class LastAction { 
         None, 
         GeneratedKey, 
+        GeneratedSigningKey, 
         ProcessedData, 
         ShaOrHmacText 
     } lastAction = LastAction::None;
@@ -0,0 +1,393 @@
+#include "numa.h"
+
+#include <algorithm>   // sort, unique, set_intersection
+#include <cstdio>      // sscanf
+#include <cstdlib>     // strtoul, strtoll
+#include <cstring>     // memset
+#include <fstream>     // /proc and /sys files
+#include <iterator>    // back_inserter
+#include <new>         // bad_alloc
+#include <sstream>     // line parsing
+#include <thread>      // hardware_concurrency
+
+#include <dirent.h>    // /sys/devices/system/node
+#include <sched.h>     // sched_getaffinity, sched_getcpu
+#include <sys/mman.h>  // mmap
+#include <unistd.h>    // syscall, sysconf
+#ifdef __linux__
+#include <sys/syscall.h> // SYS_mbind
+#endif
+
+// mbind ABI (numaif.h comes with libnuma, which we do not depend on)
+static const int kMpolPreferred = 1;
+
+// ---------------- Helper functions ------------------
+
+/**
+ * @brief Reads the first line of a small /proc or /sys file ("" if missing).
+ */
+static std::string readLine(const std::string& path) {
+    std::ifstream f(path);
+    std::string line;
+    std::getline(f, line);
+    return line;
+}
+
+
+/**
+ * @brief CPUs the scheduler lets this process run on.
+ */
+static std::vector<unsigned> affinityCpus() {
+    std::vector<unsigned> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (unsigned c = 0; c < CPU_SETSIZE; ++c)
+            if (CPU_ISSET(c, &set)) cpus.push_back(c);
+    }
+#endif
+    if (cpus.empty()) {
+        unsigned n = std::thread::hardware_concurrency();
+        for (unsigned c = 0; c < (n ? n : 1); ++c) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+
+/**
+ * @brief Finds this process's cgroup directory for a controller.
+ *
+ * @param controller "cpuset" or "cpu" for cgroup v1, "" for the v2 unified hierarchy.
+ * @return Absolute directory, or "" if the process is not in such a cgroup.
+ */
+static std::string cgroupDir(const std::string& controller) {
+    std::ifstream f("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(f, line)) {
+        // "hierarchy-id:controller-list:path"
+        size_t a = line.find(':');
+        size_t b = line.find(':', a + 1);
+        if (a == std::string::npos || b == std::string::npos) continue;
+        std::string list = line.substr(a + 1, b - a - 1);
+        std::string path = line.substr(b + 1);
+        if (controller.empty()) {
+            if (line.compare(0, a, "0") == 0 && list.empty()) return "/sys/fs/cgroup" + path;
+            continue;
+        }
+        std::stringstream ss(list);
+        std::string c;
+        while (std::getline(ss, c, ','))
+            if (c == controller) {
+                const std::string mount = controller == "cpu" ? "/sys/fs/cgroup/cpu,cpuacct" : "/sys/fs/cgroup/" + controller;
+                return mount + path;
+            }
+    }
+    return "";
+}
+
+
+/**
+ * @brief CPUs allowed by the cgroup cpuset (empty if there is no restriction to read).
+ */
+static std::vector<unsigned> cgroupCpus() {
+    std::vector<unsigned> cpus;
+    std::string v2 = cgroupDir("");
+    if (!v2.empty() && parseCpuList(readLine(v2 + "/cpuset.cpus.effective"), cpus) && !cpus.empty())
+        return cpus;
+    std::string v1 = cgroupDir("cpuset");
+    if (!v1.empty()) parseCpuList(readLine(v1 + "/cpuset.cpus"), cpus);
+    return cpus;
+}
+
+
+/**
+ * @brief CPUs granted by the cgroup CPU quota, rounded up (0 = no quota).
+ */
+static unsigned cgroupQuotaCpus() {
+    long long quota = -1, period = 0;
+    std::string v2 = cgroupDir("");
+    if (!v2.empty()) {
+        // "max 100000" or "<quota> <period>"
+        std::stringstream ss(readLine(v2 + "/cpu.max"));
+        std::string q;
+        if (ss >> q >> period && q != "max") quota = std::strtoll(q.c_str(), nullptr, 10);
+    }
+    if (quota < 0) {
+        std::string v1 = cgroupDir("cpu");
+        if (!v1.empty()) {
+            quota = std::strtoll(readLine(v1 + "/cpu.cfs_quota_us").c_str(), nullptr, 10);
+            period = std::strtoll(readLine(v1 + "/cpu.cfs_period_us").c_str(), nullptr, 10);
+        }
+    }
+    if (quota <= 0 || period <= 0) return 0;
+    return static_cast<unsigned>((quota + period - 1) / period);
+}
+
+
+// ---------------- CpuTopology ------------------
+
+/**
+ * @brief Parses a kernel CPU list ("0-3,8,10-11") into sorted CPU numbers.
+ *
+ * @param text List as found in cpuset.cpus or nodeN/cpulist.
+ * @param out Receives the CPUs.
+ * @return false on malformed input.
+ */
+bool parseCpuList(const std::string& text, std::vector<unsigned>& out) {
+    out.clear();
+    std::stringstream ss(text);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        if (part.empty() || part == "\n") continue;
+        char* end;
+        unsigned long lo = std::strtoul(part.c_str(), &end, 10);
+        unsigned long hi = lo;
+        if (end == part.c_str()) return false;
+        if (*end == '-') {
+            const char* start = end + 1;
+            hi = std::strtoul(start, &end, 10);
+            if (end == start || hi < lo) return false;
+        }
+        if (*end != '\0' && *end != '\n') return false;
+        for (unsigned long c = lo; c <= hi; ++c) out.push_back(static_cast<unsigned>(c));
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return true;
+}
+
+
+/**
+ * @brief Detects usable CPUs, their NUMA nodes and the cgroup CPU quota.
+ */
+CpuTopology CpuTopology::detect() {
+    CpuTopology t;
+    t.cpus = affinityCpus();
+    std::vector<unsigned> allowed = cgroupCpus();
+    if (!allowed.empty()) {
+        std::vector<unsigned> both;
+        std::set_intersection(t.cpus.begin(), t.cpus.end(), allowed.begin(), allowed.end(), std::back_inserter(both));
+        if (!both.empty()) t.cpus.swap(both);
+    }
+    t.quotaCpus = cgroupQuotaCpus();
+
+    // Map CPUs to nodes; node ids are renumbered densely (offline nodes leave gaps).
+    t.nodeOf.assign(t.cpus.size(), 0);
+    t.nodes = 1;
+    t.kernelNode.assign(1, 0);
+    if (DIR* d = ::opendir("/sys/devices/system/node")) {
+        std::vector<unsigned> nodeIds;
+        while (dirent* e = ::readdir(d)) {
+            unsigned id;
+            char tail;
+            if (std::sscanf(e->d_name, "node%u%c", &id, &tail) == 1) nodeIds.push_back(id);
+        }
+        ::closedir(d);
+        std::sort(nodeIds.begin(), nodeIds.end());
+
+        unsigned dense = 0;
+        std::vector<unsigned> kernel;
+        for (unsigned id : nodeIds) {
+            std::vector<unsigned> nodeCpus;
+            parseCpuList(readLine("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist"), nodeCpus);
+            bool used = false;
+            for (size_t i = 0; i < t.cpus.size(); ++i)
+                if (std::binary_search(nodeCpus.begin(), nodeCpus.end(), t.cpus[i])) {
+                    t.nodeOf[i] = dense;
+                    used = true;
+                }
+            if (used) { ///< nodes without usable CPUs are not worth a pool
+                kernel.push_back(id);
+                ++dense;
+            }
+        }
+        if (dense > 0) {
+            t.nodes = dense;
+            t.kernelNode.swap(kernel);
+        }
+    }
+    return t;
+}
+
+
+/**
+ * @brief Topology of this process, detected on first use.
+ */
+const CpuTopology& CpuTopology::system() {
+    static const CpuTopology topo = detect();
+    return topo;
+}
+
+
+/**
+ * @brief Usable CPUs that belong to `node`.
+ */
+std::vector<unsigned> CpuTopology::cpusOfNode(unsigned node) const {
+    std::vector<unsigned> out;
+    for (size_t i = 0; i < cpus.size(); ++i)
+        if (nodeOf[i] == node) out.push_back(cpus[i]);
+    return out;
+}
+
+
+unsigned CpuTopology::nodeOfCpu(unsigned cpu) const {
+    auto it = std::lower_bound(cpus.begin(), cpus.end(), cpu);
+    return (it != cpus.end() && *it == cpu) ? nodeOf[it - cpus.begin()] : 0;
+}
+
+
+/**
+ * @brief Worker count that fits the cpuset and the CPU quota.
+ */
+unsigned CpuTopology::usableThreads() const {
+    unsigned n = static_cast<unsigned>(cpus.size());
+    if (quotaCpus && quotaCpus < n) n = quotaCpus; ///< more threads than quota only adds throttling
+    return n ? n : 1;
+}
+
+
+// ---------------- Placement ------------------
+
+bool pinThreadToCpu(unsigned cpu) {
+#ifdef __linux__
+    if (cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+
+bool pinThreadToNode(unsigned node) {
+#ifdef __linux__
+    std::vector<unsigned> cpus = CpuTopology::system().cpusOfNode(node);
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned c : cpus)
+        if (c < CPU_SETSIZE) CPU_SET(c, &set);
+    return ::sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+
+unsigned currentNumaNode() {
+#ifdef __linux__
+    int cpu = ::sched_getcpu();
+    if (cpu >= 0) return CpuTopology::system().nodeOfCpu(static_cast<unsigned>(cpu));
+#endif
+    return 0;
+}
+
+
+// ---------------- NodeBuffer ------------------
+
+/**
+ * @brief Maps `bytes` of memory and places it on `node`.
+ *
+ * The node is a preference (MPOL_PREFERRED), so allocation still succeeds
+ * when the node is full. Pages are touched here so placement happens now,
+ * not on the first hot-loop access.
+ *
+ * @param bytes Buffer size.
+ * @param node Dense node id from CpuTopology, or -1 for the caller's node.
+ */
+NodeBuffer::NodeBuffer(size_t bytes, int node) : len(bytes) {
+    if (bytes == 0) return;
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) throw std::bad_alloc();
+    ptr = static_cast<unsigned char*>(p);
+#if defined(__linux__) && defined(SYS_mbind)
+    const CpuTopology& topo = CpuTopology::system();
+    if (node >= 0 && static_cast<unsigned>(node) < topo.nodes && topo.kernelNode[node] < 64) {
+        unsigned long mask = 1UL << topo.kernelNode[node];
+        ::syscall(SYS_mbind, p, bytes, kMpolPreferred, &mask, sizeof(mask) * 8, 0); ///< best effort
+    }
+#else
+    (void)node;
+#endif
+    std::memset(ptr, 0, bytes); ///< fault in on the chosen (or current) node
+}
+
+
+NodeBuffer::~NodeBuffer() {
+    if (ptr) ::munmap(ptr, len);
+}
+
+
+NodeBuffer::NodeBuffer(NodeBuffer&& other) noexcept : ptr(other.ptr), len(other.len) {
+    other.ptr = nullptr;
+    other.len = 0;
+}
+
+
+NodeBuffer& NodeBuffer::operator=(NodeBuffer&& other) noexcept {
+    if (this != &other) {
+        if (ptr) ::munmap(ptr, len);
+        ptr = other.ptr;
+        len = other.len;
+        other.ptr = nullptr;
+        other.len = 0;
+    }
+    return *this;
+}
+
+
+// ---------------- ScratchBuffer ------------------
+
+namespace {
+
+// This thread's scratch levels; levels below `depth` belong to live ScratchBuffers.
+struct ScratchStack {
+    std::vector<NodeBuffer> levels;
+    size_t depth = 0;
+};
+
+thread_local ScratchStack tlScratch;
+
+} // namespace
+
+
+/**
+ * @brief Takes the thread's next scratch level (grown to `bytes` if needed),
+ * or maps a buffer of its own above kScratchKeepBytes.
+ *
+ * @param bytes Minimum size.
+ */
+ScratchBuffer::ScratchBuffer(size_t bytes) {
+    if (bytes > kScratchKeepBytes) {
+        own = NodeBuffer(bytes);
+        ptr = own.data();
+        return;
+    }
+    ScratchStack& s = tlScratch;
+    level = s.depth++;
+    stacked = true;
+    if (s.levels.size() <= level) s.levels.emplace_back(); ///< moving NodeBuffers keeps their memory in place
+    NodeBuffer& buf = s.levels[level];
+    if (buf.size() < bytes) buf = NodeBuffer(bytes);
+    ptr = buf.data();
+}
+
+
+/**
+ * @brief Returns the level; the outermost scope trims the stack to kScratchIdleBytes.
+ */
+ScratchBuffer::~ScratchBuffer() {
+    if (!stacked) return;
+    ScratchStack& s = tlScratch;
+    s.depth = level; ///< scopes end in reverse order
+    if (level != 0) return;
+    size_t kept = 0, keep = 0;
+    while (keep < s.levels.size() && kept + s.levels[keep].size() <= kScratchIdleBytes)
+        kept += s.levels[keep++].size();
+    s.levels.erase(s.levels.begin() + static_cast<std::ptrdiff_t>(keep), s.levels.end());
+}
@@ -0,0 +1,90 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <cstddef>  // size_t
+#include <string>   // cpu list parsing
+#include <vector>   // cpu / node lists
+
+// CPU and memory placement for the worker pools.
+//
+// The usable CPU set is the scheduler affinity mask intersected with the
+// cgroup cpuset (v1 or v2); a cgroup CPU quota (cpu.max / cfs_quota_us)
+// further caps how many workers are worth starting. NUMA nodes come from
+// /sys/devices/system/node. Everything degrades to "one node, all CPUs" on
+// systems without that information.
+
+struct CpuTopology {
+    std::vector<unsigned> cpus;   // usable CPUs, ascending
+    std::vector<unsigned> nodeOf; // NUMA node of cpus[i]
+    unsigned nodes = 1;           // number of NUMA nodes (node ids are 0 .. nodes-1)
+    std::vector<unsigned> kernelNode; // kernel node number of each node id (for mbind)
+    unsigned quotaCpus = 0;       // CPUs granted by the cgroup quota, 0 = no quota
+
+    std::vector<unsigned> cpusOfNode(unsigned node) const;
+    unsigned nodeOfCpu(unsigned cpu) const; // 0 if unknown
+    unsigned usableThreads() const;         // default worker count: cpus, capped by the quota
+
+    static CpuTopology detect();
+    static const CpuTopology& system(); // detected once per process
+};
+
+// Parses a kernel CPU list such as "0-3,8,10-11". Returns false on bad syntax.
+bool parseCpuList(const std::string& text, std::vector<unsigned>& out);
+
+// Pins the calling thread to one CPU / to all CPUs of a node. False if refused.
+bool pinThreadToCpu(unsigned cpu);
+bool pinThreadToNode(unsigned node);
+
+// NUMA node the calling thread is running on right now (0 if unknown).
+unsigned currentNumaNode();
+
+// Page-aligned buffer whose memory is placed on one NUMA node. With node < 0
+// the pages are faulted in by the constructing thread, so the kernel's
+// first-touch policy puts them on that thread's node.
+class NodeBuffer {
+public:
+    NodeBuffer() = default;
+    NodeBuffer(size_t bytes, int node = -1);
+    ~NodeBuffer();
+
+    NodeBuffer(NodeBuffer&& other) noexcept;
+    NodeBuffer& operator=(NodeBuffer&& other) noexcept;
+    NodeBuffer(const NodeBuffer&) = delete;
+    NodeBuffer& operator=(const NodeBuffer&) = delete;
+
+    unsigned char* data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    unsigned char* ptr = nullptr;
+    size_t len = 0;
+};
+
+// Node-local scratch buffer for one scope. Buffers up to kScratchKeepBytes
+// come from a small per-thread stack: each live ScratchBuffer on a thread
+// holds the next level, so nested users (a reader that seals, a hash inside
+// a resume check) never share memory and need no coordination. Levels are
+// allocated on the node of the thread that first uses them (workers are
+// pinned before they run tasks) and reused by later scopes. When the
+// outermost ScratchBuffer of a thread ends, levels beyond kScratchIdleBytes
+// are unmapped, so an idle worker keeps at most that much. Larger buffers
+// are a NodeBuffer of their own, freed with this object (so 64 MiB chunk
+// sizes do not stay pinned to every worker).
+constexpr size_t kScratchKeepBytes = 4u << 20;
+constexpr size_t kScratchIdleBytes = 4u << 20;
+
+class ScratchBuffer {
+public:
+    explicit ScratchBuffer(size_t bytes);
+    ~ScratchBuffer();
+
+    ScratchBuffer(const ScratchBuffer&) = delete;
+    ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+    unsigned char* data() const { return ptr; }
+
+private:
+    NodeBuffer own;
+    unsigned char* ptr;
+    size_t level = 0;      ///< stack level taken, when `stacked`
+    bool stacked = false;
+};
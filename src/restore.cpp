@@ -0,0 +1,257 @@
+#include "restore.h"
+#include "container.h"     // readContainer
+#include "dirwalk.h"       // directory sources
+#include "fdio.h"          // fdReader / fdWriter, hole recreation
+#include "streamcipher.h"  // decryptStream (.aescbc)
+#include "workerpool.h"    // shared pool
+
+#include <algorithm>   // sort
+#include <cerrno>      // EEXIST
+#include <chrono>      // per-file timing
+#include <cstdio>      // rename
+#include <filesystem>  // create_directories, path handling
+#include <fstream>     // list files
+#include <iostream>    // list on stdin
+#include <mutex>       // ordered reporting
+#include <numeric>     // iota
+#include <set>         // duplicate targets
+
+#include <fcntl.h>     // open
+#include <sys/stat.h>  // stat, fstat
+#include <unistd.h>    // close, fdatasync
+
+// Crypto++ includes
+#include <cryptopp/cryptlib.h> // CryptoPP::Exception
+
+namespace fs = std::filesystem;
+using namespace CryptoPP;
+
+// ---------------- Helper functions ------------------
+
+static bool endsWith(const std::string& s, const char* suffix) {
+    const size_t n = std::char_traits<char>::length(suffix);
+    return s.size() > n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+
+/**
+ * @brief Output path for an encrypted input: the path without ".cqac" / ".aescbc".
+ */
+static std::string plainName(const std::string& path) {
+    if (endsWith(path, ".cqac")) return path.substr(0, path.size() - 5);
+    if (endsWith(path, ".aescbc")) return path.substr(0, path.size() - 7);
+    return path + ".out";
+}
+
+
+/**
+ * @brief Fails if two items would write the same output.
+ */
+static bool uniqueTargets(const std::vector<RestoreItem>& items, std::string& error) {
+    std::set<std::string> seen;
+    for (const RestoreItem& item : items) {
+        if (!seen.insert(fs::path(item.dst).lexically_normal().string()).second) {
+            error = "more than one input restores to " + item.dst;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Output path under dstRoot for a list entry, keeping its directory structure.
+ *
+ * Absolute entries keep their whole path below dstRoot (/b/2024/db.cqac
+ * restores to dstRoot/b/2024/db). Entries with a ".." component are
+ * refused, since they could point outside dstRoot.
+ *
+ * @return false (with `error`) for an entry that would escape dstRoot.
+ */
+static bool listTarget(const std::string& dstRoot, const std::string& entry, std::string& dst, std::string& error) {
+    const fs::path rel = fs::path(entry).relative_path().lexically_normal();
+    for (const fs::path& part : rel) {
+        if (part == "..") {
+            error = "list entry leaves the target directory: " + entry;
+            return false;
+        }
+    }
+    if (rel.empty() || rel.filename().empty() || rel.filename() == ".") {
+        error = "list entry is not a file path: " + entry;
+        return false;
+    }
+    dst = dstRoot + "/" + plainName(rel.string());
+    return true;
+}
+
+
+// ---------------- Restore ------------------
+
+/**
+ * @brief Builds restore jobs from a directory tree or a list of paths.
+ *
+ * @param source Directory, list file, or "-" for a list on stdin.
+ * @param dstRoot Output root.
+ * @param items Receives the jobs in submission order.
+ * @param error Receives a description on failure.
+ * @return false if the source cannot be read, a list entry would leave
+ *         dstRoot, or two inputs map to the same output (such as a.cqac and
+ *         a.aescbc), which would otherwise be decrypted into one file at once.
+ */
+bool collectRestoreItems(const std::string& source, const std::string& dstRoot,
+                         std::vector<RestoreItem>& items, std::string& error) {
+    items.clear();
+    struct stat st;
+    if (source != "-" && ::stat(source.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        WalkOptions wo;
+        wo.include = { "*.cqac", "*.aescbc" };
+        WalkStats ws;
+        std::mutex m;
+        bool ok = walkTree(source, wo, [&](const WalkedFile& f) {
+            RestoreItem item;
+            item.src = source + "/" + f.path;
+            item.dst = dstRoot + "/" + plainName(f.path);
+            item.size = f.size;
+            std::lock_guard<std::mutex> lock(m);
+            items.push_back(item);
+            return true;
+        }, ws, error);
+        std::sort(items.begin(), items.end(), [](const RestoreItem& a, const RestoreItem& b) {
+            return a.src < b.src;
+        });
+        return ok && uniqueTargets(items, error);
+    }
+
+    std::ifstream file;
+    if (source != "-") {
+        file.open(source);
+        if (!file) {
+            error = "cannot read " + source;
+            return false;
+        }
+    }
+    std::istream& in = source == "-" ? std::cin : file;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        RestoreItem item;
+        item.src = line;
+        if (!listTarget(dstRoot, line, item.dst, error)) return false;
+        if (::stat(line.c_str(), &st) == 0) item.size = static_cast<uint64_t>(st.st_size); ///< missing: fails when run
+        items.push_back(item);
+    }
+    return uniqueTargets(items, error);
+}
+
+
+/**
+ * @brief Decrypts one file into item.dst (temp + fdatasync + rename).
+ *
+ * @param item Input / output paths.
+ * @param key Master key.
+ * @param ivBytes IV length of .aescbc inputs.
+ * @param plainBytes Receives the plaintext size.
+ * @return Empty string on success, otherwise the reason.
+ */
+std::string restoreFile(const RestoreItem& item, const SecByteBlock& key, size_t ivBytes, uint64_t& plainBytes) {
+    plainBytes = 0;
+    const bool container = endsWith(item.src, ".cqac");
+    if (!container && !endsWith(item.src, ".aescbc")) return "unknown format (expected .cqac or .aescbc)";
+
+    std::error_code ec;
+    fs::create_directories(fs::path(item.dst).parent_path(), ec);
+    if (ec) return "cannot create directory: " + ec.message();
+    int in = ::open(item.src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return "cannot open input";
+    tuneStreamFd(in);
+    const std::string tmp = item.dst + ".part";
+    int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600); ///< never share a .part
+    if (out < 0) {
+        const bool exists = errno == EEXIST;
+        ::close(in);
+        return exists ? "partial output " + tmp + " exists (another restore, or left by a crash)"
+                      : "cannot create output";
+    }
+
+    std::string error;
+    bool ok;
+    try {
+        if (container) {
+            HoleWriter holes = fdHoleWriter(out);
+            ContainerReport rep = readContainer(fdReader(in), fdWriter(out), key, nullptr, holes);
+            ok = rep.status == ContainerReport::Status::Ok && (!holes || finishHoles(out));
+            if (rep.status != ContainerReport::Status::Ok) error = describeContainerStatus(rep.status);
+            else if (!ok) error = "cannot set output size";
+        } else {
+            ok = decryptStream(in, out, key, ivBytes, error);
+        }
+    } catch (const Exception& e) {
+        ok = false;
+        error = e.what();
+    }
+    ::close(in);
+    struct stat st;
+    if (ok && ::fstat(out, &st) == 0) plainBytes = static_cast<uint64_t>(st.st_size);
+    if (ok && ::fdatasync(out) != 0) {
+        ok = false;
+        error = "sync failed";
+    }
+    if (::close(out) != 0 && ok) {
+        ok = false;
+        error = "close failed";
+    }
+    if (ok && std::rename(tmp.c_str(), item.dst.c_str()) != 0) {
+        ok = false;
+        error = "rename failed";
+    }
+    if (!ok) ::unlink(tmp.c_str());
+    return error;
+}
+
+
+/**
+ * @brief Restores every item, largest first, reporting in submission order.
+ *
+ * @param items Jobs in submission order.
+ * @param key Master key.
+ * @param ivBytes IV length of .aescbc inputs.
+ * @param stats Live counters (may be polled by other threads).
+ * @param report Optional ordered callback.
+ */
+void runRestore(const std::vector<RestoreItem>& items, const SecByteBlock& key, size_t ivBytes,
+                RestoreStats& stats, const RestoreReport& report) {
+    // Longest-processing-time-first: parallelFor hands out indices in order,
+    // so the biggest files start immediately and small ones fill the gaps.
+    std::vector<size_t> order(items.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return items[a].size > items[b].size; });
+
+    std::mutex m;
+    std::vector<RestoreResult> results(items.size());
+    std::vector<bool> finished(items.size(), false);
+    size_t nextReport = 0;
+
+    WorkerPool::shared().parallelFor(order.size(), [&](size_t k) {
+        const size_t i = order[k];
+        RestoreResult r;
+        const auto start = std::chrono::steady_clock::now();
+        r.error = restoreFile(items[i], key, ivBytes, r.plainBytes);
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (r.error.empty()) {
+            ++stats.filesOk;
+            stats.bytesOut += r.plainBytes;
+        } else {
+            ++stats.filesFailed;
+        }
+
+        // Hand out the finished prefix; the lock also serialises the callback.
+        std::lock_guard<std::mutex> lock(m);
+        results[i] = std::move(r);
+        finished[i] = true;
+        for (; nextReport < items.size() && finished[nextReport]; ++nextReport) {
+            if (report) report(nextReport, items[nextReport], results[nextReport]);
+            results[nextReport] = RestoreResult(); ///< drop error text once reported
+        }
+    });
+}
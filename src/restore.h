@@ -0,0 +1,57 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <atomic>     // live counters
+#include <cstddef>    // size_t
+#include <cstdint>    // byte counts
+#include <functional> // ordered report
+#include <string>     // paths
+#include <vector>     // job list
+
+#include <cryptopp/secblock.h> // SecByteBlock keys
+
+// Parallel restore of many encrypted files (.cqac containers and .aescbc).
+//
+// All jobs are known up front, so they are started largest first on the
+// shared WorkerPool: a big file picked last would otherwise keep one core
+// busy long after the others are done. Completions are handed to the report
+// callback in submission order, so output and logs read like a sequential
+// restore while the work itself overlaps.
+
+struct RestoreItem {
+    std::string src;    // encrypted input
+    std::string dst;    // plaintext output (written via "<dst>.part" + rename)
+    uint64_t size = 0;  // input size, used for scheduling
+};
+
+struct RestoreResult {
+    std::string error;       // empty on success
+    uint64_t plainBytes = 0;
+    double seconds = 0;      // decrypt time of this file
+};
+
+struct RestoreStats {
+    std::atomic<uint64_t> filesOk{0};
+    std::atomic<uint64_t> filesFailed{0};
+    std::atomic<uint64_t> bytesOut{0};
+};
+
+// Called for items 0, 1, 2, ... in that order, one call at a time (from
+// whichever worker completes the next item in line).
+using RestoreReport = std::function<void(size_t index, const RestoreItem& item, const RestoreResult& result)>;
+
+// Builds the job list from a directory (every *.cqac / *.aescbc below it,
+// sorted by path) or from a list file with one path per line ("-" = stdin).
+// Outputs mirror the paths under dstRoot without the extension (absolute
+// list entries keep their whole path). Fails on list entries that would
+// leave dstRoot and on two inputs with the same output.
+bool collectRestoreItems(const std::string& source, const std::string& dstRoot,
+                         std::vector<RestoreItem>& items, std::string& error);
+
+// Decrypts one file by its extension; ivBytes is the .aescbc IV size. Returns "" or the reason.
+std::string restoreFile(const RestoreItem& item, const CryptoPP::SecByteBlock& key, size_t ivBytes,
+                        uint64_t& plainBytes);
+
+// Runs every item under the calling thread's throttle and blocks until all
+// are reported. Must not be called from a pool task.
+void runRestore(const std::vector<RestoreItem>& items, const CryptoPP::SecByteBlock& key, size_t ivBytes,
+                RestoreStats& stats, const RestoreReport& report);
@@ -0,0 +1,165 @@
+#include "scrubber.h"
+#include "container.h"  // readContainer (verify-only mode)
+#include "fdio.h"       // fdReader
+#include "throttle.h"   // rate limit, I/O class, nice
+
+#include <algorithm>    // sort
+#include <chrono>       // checkpoint interval
+#include <cstdio>       // rename
+#include <cstdlib>      // strtoull
+#include <filesystem>   // directory walk
+#include <fstream>      // state file
+#include <vector>       // file list
+
+#include <fcntl.h>          // open, posix_fadvise
+#include <unistd.h>         // close
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+// ---------------- Helper functions ------------------
+
+/**
+ * @brief Reads the checkpoint: the last fully checked path of the current pass.
+ */
+static void loadState(const std::string& path, std::string& lastDone, ScrubStats& carried) {
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        std::string k = line.substr(0, eq), v = line.substr(eq + 1);
+        if (k == "last") lastDone = v;
+        else if (k == "files_ok") carried.filesOk = std::strtoull(v.c_str(), nullptr, 10);
+        else if (k == "files_bad") carried.filesBad = std::strtoull(v.c_str(), nullptr, 10);
+    }
+}
+
+
+/**
+ * @brief Atomically replaces the checkpoint file (write temp + rename).
+ *
+ * @param last Last checked path, empty once the pass has completed.
+ */
+static bool saveState(const std::string& path, const std::string& last, const ScrubStats& pass) {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << "version=1\n"
+            << "last=" << last << "\n"
+            << "files_ok=" << pass.filesOk << "\n"
+            << "files_bad=" << pass.filesBad << "\n"
+            << "updated=" << std::chrono::duration_cast<std::chrono::seconds>(
+                   std::chrono::system_clock::now().time_since_epoch()).count() << "\n";
+        if (!out.flush()) return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+
+// ---------------- Scrub pass ------------------
+
+/**
+ * @brief Verifies every container under opt.root, resuming a previous pass if any.
+ *
+ * @param opt Root, checkpoint file, rate limit and priority settings.
+ * @param key Master key the containers were written with.
+ * @param stats Receives counters for the whole pass (including resumed parts).
+ * @param report Called for every damaged or unreadable container.
+ * @param error Receives a description if the walk itself fails.
+ * @return true if the pass completed.
+ */
+bool runScrub(const ScrubOptions& opt, const CryptoPP::SecByteBlock& key, ScrubStats& stats,
+              const ScrubReport& report, std::string& error) {
+    const std::string statePath = opt.statePath.empty() ? opt.root + "/.cqac-scrub.state" : opt.statePath;
+    if (opt.lowPriority) {
+        // failures are ignored: scrubbing still works, just less politely
+        setThreadNice(19);
+        setThreadIoClass(IoClass::Idle);
+    }
+    ThrottleScope scope(opt.throttle); ///< every container read is charged to the rate limit
+
+    std::string lastDone;
+    ScrubStats carried;
+    loadState(statePath, lastDone, carried);
+    if (!lastDone.empty()) { ///< resuming: counts from before the interruption belong to this pass
+        stats.filesOk = carried.filesOk;
+        stats.filesBad = carried.filesBad;
+    }
+
+    // Collect and sort so the order (and therefore the checkpoint) is stable across runs.
+    // Only iterator errors end the walk; an entry whose type cannot be read
+    // is skipped and counted; with the extension it is a bad container of
+    // this pass (unless a resumed pass is already past it).
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(opt.root, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        const std::string p = it->path().string();
+        const bool named = p.size() >= opt.extension.size()
+                           && p.compare(p.size() - opt.extension.size(), opt.extension.size(), opt.extension) == 0;
+        std::error_code entryEc;
+        const bool regular = it->is_regular_file(entryEc);
+        if (entryEc) {
+            ++stats.entriesUnreadable;
+            if (named && (lastDone.empty() || p > lastDone)) {
+                ++stats.filesBad;
+                if (report) report(p, "cannot read entry: " + entryEc.message());
+            }
+            continue;
+        }
+        if (regular && named) files.push_back(p);
+    }
+    if (ec) {
+        error = "cannot walk " + opt.root + ": " + ec.message();
+        return false;
+    }
+    std::sort(files.begin(), files.end());
+
+    auto lastSave = Clock::now();
+
+    for (const std::string& path : files) {
+        if (!lastDone.empty() && path <= lastDone) {
+            ++stats.filesSkipped;
+            continue;
+        }
+
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            ++stats.filesBad;
+            if (report) report(path, "cannot open");
+        } else {
+            ContainerReport rep = readContainer(fdReader(fd), ByteWriter(), key, [&](size_t bytes) {
+                stats.bytes += bytes;
+            });
+#ifdef POSIX_FADV_DONTNEED
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED); ///< don't evict production data from the page cache
+#endif
+            ::close(fd);
+            if (rep.status == ContainerReport::Status::Ok) {
+                ++stats.filesOk;
+            } else {
+                ++stats.filesBad;
+                std::string why = describeContainerStatus(rep.status);
+                if (rep.status == ContainerReport::Status::Corrupt || rep.status == ContainerReport::Status::Truncated)
+                    why += " at record " + std::to_string(rep.badRecord);
+                if (report) report(path, why);
+            }
+        }
+
+        if (Clock::now() - lastSave > std::chrono::seconds(5)) {
+            if (!saveState(statePath, path, stats)) {
+                error = "cannot write state file " + statePath;
+                return false;
+            }
+            lastSave = Clock::now();
+        }
+    }
+
+    // Pass complete: the next run starts over from the beginning
+    if (!saveState(statePath, std::string(), stats)) {
+        error = "cannot write state file " + statePath;
+        return false;
+    }
+    return true;
+}
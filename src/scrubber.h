@@ -0,0 +1,38 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <cstdint>    // counters
+#include <functional> // report callback
+#include <string>     // paths
+
+#include <cryptopp/secblock.h> // SecByteBlock keys
+
+struct Throttle;
+
+// Background integrity scrub of a directory tree of containers (.cqac).
+// Every record's GCM tag is checked without writing any plaintext. Files are
+// visited in sorted path order and the position is checkpointed to a state
+// file, so an interrupted pass resumes where it stopped.
+
+struct ScrubOptions {
+    std::string root;                 // directory to walk (recursively)
+    std::string statePath;            // checkpoint file; empty = "<root>/.cqac-scrub.state"
+    std::string extension = ".cqac";  // only files with this suffix are checked
+    Throttle* throttle = nullptr;     // read rate limit (adjustable while running), nullptr = unlimited
+    bool lowPriority = true;          // idle I/O class + lowest CPU priority
+};
+
+struct ScrubStats {
+    uint64_t filesOk = 0;
+    uint64_t filesBad = 0;
+    uint64_t filesSkipped = 0; // already checked earlier in a resumed pass
+    uint64_t entriesUnreadable = 0; // walk entries whose type could not be read (dangling links, EACCES)
+    uint64_t bytes = 0;        // container bytes verified in this run
+};
+
+// Called once per damaged (or unreadable) file with the path and a reason.
+using ScrubReport = std::function<void(const std::string& path, const std::string& problem)>;
+
+// Runs (or resumes) one scrub pass. Returns false if the walk or the state
+// file failed; damaged containers are reported, not treated as errors.
+bool runScrub(const ScrubOptions& opt, const CryptoPP::SecByteBlock& key, ScrubStats& stats,
+              const ScrubReport& report, std::string& error);
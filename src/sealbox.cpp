@@ -0,0 +1,72 @@
+#include "sealbox.h"
+
+#include <cstring>  // memset
+
+// Crypto++ includes
+#include <cryptopp/osrng.h>  // nonce prefixes
+
+using namespace CryptoPP;
+
+static const size_t kPrefixBytes = 8;
+
+/**
+ * @brief Keys both directions once; every later message reuses the schedule.
+ *
+ * @param key AES key.
+ * @param keyLen 16, 24 or 32.
+ * @return false for any other key length.
+ */
+bool SealBox::setKey(const byte* key, size_t keyLen) {
+    if (!key || (keyLen != 16 && keyLen != 24 && keyLen != 32)) return false;
+    enc.SetKey(key, keyLen);
+    dec.SetKey(key, keyLen);
+    refreshPrefix();
+    keyed = true;
+    return true;
+}
+
+
+void SealBox::refreshPrefix() {
+    AutoSeededRandomPool rng; ///< only on setKey() and every 2^32 messages
+    rng.GenerateBlock(nonce, kPrefixBytes);
+    counter = 0;
+}
+
+
+/**
+ * @brief Encrypts and authenticates one message under the next nonce.
+ *
+ * @param aad Associated data, authenticated but not encrypted (may be null if aadLen is 0).
+ * @param aadLen Associated data length.
+ * @param plain Message.
+ * @param n Message length.
+ * @param out Receives nonce || ciphertext || tag (n + kSealOverheadBytes bytes).
+ */
+void SealBox::seal(const byte* aad, size_t aadLen, const byte* plain, size_t n, byte* out) {
+    if (++counter == 0) { ///< counter exhausted: new prefix, counting from 1 again
+        refreshPrefix();
+        counter = 1;
+    }
+    nonce[8] = static_cast<byte>(counter >> 24);
+    nonce[9] = static_cast<byte>(counter >> 16);
+    nonce[10] = static_cast<byte>(counter >> 8);
+    nonce[11] = static_cast<byte>(counter);
+    std::memcpy(out, nonce, kSealNonceBytes);
+    enc.EncryptAndAuthenticate(out + kSealNonceBytes, out + kSealNonceBytes + n, kSealTagBytes,
+                               nonce, kSealNonceBytes, aad, aadLen, plain, n);
+}
+
+
+/**
+ * @brief Verifies and decrypts one sealed message.
+ *
+ * @return true if it authenticated; on failure no plaintext is left in `plain`.
+ */
+bool SealBox::open(const byte* aad, size_t aadLen, const byte* sealed, size_t sealedLen, byte* plain) {
+    if (sealedLen < kSealOverheadBytes) return false;
+    const size_t n = sealedLen - kSealOverheadBytes;
+    const bool ok = dec.DecryptAndVerify(plain, sealed + kSealNonceBytes + n, kSealTagBytes,
+                                         sealed, kSealNonceBytes, aad, aadLen, sealed + kSealNonceBytes, n);
+    if (!ok && n) std::memset(plain, 0, n); ///< GCM decrypts before it verifies
+    return ok;
+}
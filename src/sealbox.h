@@ -0,0 +1,49 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <cstddef>  // size_t
+#include <cstdint>  // nonce counter
+
+// Crypto++ includes
+#include <cryptopp/aes.h>  // AES block cipher
+#include <cryptopp/gcm.h>  // GCM authenticated mode
+
+// Small-message AEAD (AES-GCM) for tokens and other payloads of a few
+// hundred bytes, where per-call setup would cost more than the cipher. The
+// AES key schedule and GHASH tables are computed once in setKey(); seal()
+// and open() only resynchronize the mode with the next nonce and work on the
+// caller's buffers, with no filters, strings or heap allocation per call.
+//
+//   sealed = nonce (12) || ciphertext (n) || tag (16)
+//
+// A nonce is an 8-byte random prefix, drawn by setKey() and again every
+// 2^32 messages, followed by a 32-bit message counter. Nonces never repeat
+// within one SealBox; boxes sharing a key collide with probability about
+// boxes^2 / 2^65.
+//
+// Not thread-safe (the mode objects hold per-message state): one per thread.
+
+constexpr size_t kSealNonceBytes = 12;
+constexpr size_t kSealTagBytes = 16;
+constexpr size_t kSealOverheadBytes = kSealNonceBytes + kSealTagBytes;
+
+class SealBox {
+public:
+    bool setKey(const CryptoPP::byte* key, size_t keyLen); // 16, 24 or 32 bytes; false otherwise
+    bool hasKey() const { return keyed; }
+
+    // `out` receives n + kSealOverheadBytes bytes and must not overlap `plain`.
+    void seal(const CryptoPP::byte* aad, size_t aadLen, const CryptoPP::byte* plain, size_t n, CryptoPP::byte* out);
+    // `plain` receives sealedLen - kSealOverheadBytes bytes. False (and `plain`
+    // zeroed) if the input is too short, forged or sealed under another key.
+    bool open(const CryptoPP::byte* aad, size_t aadLen, const CryptoPP::byte* sealed, size_t sealedLen,
+              CryptoPP::byte* plain);
+
+private:
+    void refreshPrefix();
+
+    CryptoPP::GCM<CryptoPP::AES>::Encryption enc;
+    CryptoPP::GCM<CryptoPP::AES>::Decryption dec;
+    CryptoPP::byte nonce[kSealNonceBytes] = {}; ///< prefix || counter of the last sealed message
+    uint32_t counter = 0;
+    bool keyed = false;
+};
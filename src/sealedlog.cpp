@@ -0,0 +1,527 @@
+#include "sealedlog.h"
+#include "fdio.h"      // writeAll
+#include "textcodec.h" // checkpoint hex
+
+#include <algorithm>   // max
+#include <cerrno>      // EINTR
+#include <cstring>     // memcpy, memcmp
+#include <deque>       // tail offsets
+#include <sstream>     // checkpoint parsing
+
+#include <fcntl.h>     // open
+#include <sys/file.h>  // flock
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // pread, ftruncate, fdatasync
+
+// Crypto++ includes
+#include <cryptopp/aes.h>    // AES block cipher
+#include <cryptopp/gcm.h>    // GCM authenticated mode
+#include <cryptopp/hmac.h>   // per-file key derivation
+#include <cryptopp/sha.h>    // SHA-256
+#include <cryptopp/osrng.h>  // salts and record nonces
+
+using namespace CryptoPP;
+
+static const byte kMagic[4] = { 'C', 'Q', 'A', 'L' };
+static const uint8_t kLogVersion = 2;
+static const char kLogKeyLabel[] = "CQAL/v1 log key";
+static const size_t kSaltBytes = 16;
+static const size_t kNonceBytes = 12;     ///< random, stored in the record header
+static const size_t kSequenceOffset = 4 + kNonceBytes;
+static const size_t kReadAheadBytes = 256 * 1024;
+
+// ---------------- Helper functions ------------------
+
+static void putBe32(byte* p, uint32_t v) {
+    p[0] = static_cast<byte>(v >> 24);
+    p[1] = static_cast<byte>(v >> 16);
+    p[2] = static_cast<byte>(v >> 8);
+    p[3] = static_cast<byte>(v);
+}
+
+static uint32_t getBe32(const byte* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+static void putBe64(byte* p, uint64_t v) {
+    putBe32(p, static_cast<uint32_t>(v >> 32));
+    putBe32(p + 4, static_cast<uint32_t>(v));
+}
+
+static uint64_t getBe64(const byte* p) {
+    return (uint64_t(getBe32(p)) << 32) | getBe32(p + 4);
+}
+
+/**
+ * @brief pread() until `n` bytes or end of file.
+ *
+ * @return Bytes read, or -1 on error.
+ */
+static ssize_t preadFull(int fd, void* buf, size_t n, uint64_t offset) {
+    size_t got = 0;
+    while (got < n) {
+        ssize_t r = ::pread(fd, static_cast<char*>(buf) + got, n - got, static_cast<off_t>(offset + got));
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) return -1;
+        if (r == 0) break;
+        got += static_cast<size_t>(r);
+    }
+    return static_cast<ssize_t>(got);
+}
+
+static bool fileSize(int fd, uint64_t& size) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0) return false;
+    size = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+static void startCursor(LogCursor& cursor) {
+    cursor.offset = kSealedLogHeaderBytes;
+    cursor.sequence = 0;
+    std::memset(cursor.chain, 0, kLogTagBytes);
+}
+
+enum class HeaderWalk { Complete, Torn, Bad };
+
+/**
+ * @brief Reads the record header at `offset` without touching the payload.
+ *
+ * @return Complete with its length and sequence, Torn if the file ends inside
+ *         the record, Bad for an impossible length or a read error.
+ */
+static HeaderWalk recordAt(int fd, uint64_t offset, uint64_t size, uint32_t& len, uint64_t& sequence) {
+    if (size - offset < kLogRecordHeaderBytes) return HeaderWalk::Torn;
+    byte rh[kLogRecordHeaderBytes];
+    if (preadFull(fd, rh, sizeof(rh), offset) != static_cast<ssize_t>(sizeof(rh))) return HeaderWalk::Bad;
+    len = getBe32(rh);
+    sequence = getBe64(rh + kSequenceOffset);
+    if (len > kMaxLogRecordBytes) return HeaderWalk::Bad;
+    return size - offset < sealedLogRecordBytes(len) ? HeaderWalk::Torn : HeaderWalk::Complete;
+}
+
+
+// ---------------- SealedLogCodec ------------------
+
+// Per-file key and header of one log; seals and opens single records.
+class SealedLogCodec {
+public:
+    SealedLogCodec(const SecByteBlock& masterKey, const byte header[kSealedLogHeaderBytes])
+        : fileKey(masterKey.size() < 32 ? masterKey.size() : 32) {
+        std::memcpy(hdr, header, kSealedLogHeaderBytes);
+        HMAC<SHA256> kdf(masterKey, masterKey.size());
+        kdf.Update(reinterpret_cast<const byte*>(kLogKeyLabel), sizeof(kLogKeyLabel) - 1);
+        kdf.Update(hdr + 8, kSaltBytes);
+        SecByteBlock prk(kdf.DigestSize());
+        kdf.Final(prk);
+        std::memcpy(fileKey, prk, fileKey.size()); ///< AES-128/192 keys use a prefix of the 32-byte output
+    }
+
+    static bool parseHeader(const byte header[kSealedLogHeaderBytes]) {
+        return std::memcmp(header, kMagic, sizeof(kMagic)) == 0 && header[4] == kLogVersion;
+    }
+
+    // `out` must hold sealedLogRecordBytes(n) bytes. Every record gets a
+    // fresh random nonce, so a sequence number reused after a torn or
+    // dropped tail was cut off never reuses a (key, nonce) pair.
+    void seal(uint64_t sequence, const byte chain[kLogTagBytes], const byte* plain, size_t n, byte* out) {
+        putBe32(out, static_cast<uint32_t>(n));
+        rng.GenerateBlock(out + 4, kNonceBytes);
+        putBe64(out + kSequenceOffset, sequence);
+        byte aad[kSealedLogHeaderBytes + kLogRecordHeaderBytes + kLogTagBytes];
+        buildAad(out, chain, aad);
+
+        GCM<AES>::Encryption enc;
+        enc.SetKeyWithIV(fileKey, fileKey.size(), out + 4, kNonceBytes);
+        enc.EncryptAndAuthenticate(out + kLogRecordHeaderBytes, out + kLogRecordHeaderBytes + n, kLogTagBytes,
+                                   out + 4, kNonceBytes, aad, sizeof(aad), plain, n);
+    }
+
+    // `record` is header || ciphertext || tag of sealedLogRecordBytes(n) bytes.
+    bool open(uint64_t sequence, const byte chain[kLogTagBytes], const byte* record, size_t n, byte* plain) const {
+        if (getBe64(record + kSequenceOffset) != sequence) return false;
+        byte aad[kSealedLogHeaderBytes + kLogRecordHeaderBytes + kLogTagBytes];
+        buildAad(record, chain, aad);
+
+        GCM<AES>::Decryption dec;
+        dec.SetKeyWithIV(fileKey, fileKey.size(), record + 4, kNonceBytes);
+        return dec.DecryptAndVerify(plain, record + kLogRecordHeaderBytes + n, kLogTagBytes, record + 4, kNonceBytes,
+                                    aad, sizeof(aad), record + kLogRecordHeaderBytes, n);
+    }
+
+private:
+    void buildAad(const byte* recordHeader, const byte chain[kLogTagBytes], byte* aad) const {
+        std::memcpy(aad, hdr, kSealedLogHeaderBytes);
+        std::memcpy(aad + kSealedLogHeaderBytes, recordHeader, kLogRecordHeaderBytes);
+        std::memcpy(aad + kSealedLogHeaderBytes + kLogRecordHeaderBytes, chain, kLogTagBytes);
+    }
+
+    byte hdr[kSealedLogHeaderBytes];
+    SecByteBlock fileKey;
+    AutoSeededRandomPool rng; ///< record nonces
+};
+
+
+// ---------------- LogCursor ------------------
+
+std::string LogCursor::toString() const {
+    return std::to_string(sequence) + " " + std::to_string(offset) + " " + toHex(chain, kLogTagBytes);
+}
+
+
+bool LogCursor::parse(const std::string& text) {
+    std::istringstream in(text);
+    std::string hex;
+    if (!(in >> sequence >> offset >> hex) || hex.size() != 2 * kLogTagBytes) return false;
+    return hexDecode(hex.data(), hex.size(), chain);
+}
+
+
+const char* describeSealedLogStatus(SealedLogReport::Status status) {
+    switch (status) {
+    case SealedLogReport::Status::Ok: return "ok";
+    case SealedLogReport::Status::IoError: return "read error";
+    case SealedLogReport::Status::BadHeader: return "not a sealed log";
+    case SealedLogReport::Status::Corrupt: return "record failed verification (tampered, reordered or wrong key)";
+    case SealedLogReport::Status::Truncated: return "log is shorter than the checkpoint (records removed)";
+    }
+    return "unknown";
+}
+
+
+// ---------------- SealedLogWriter ------------------
+
+SealedLogWriter::SealedLogWriter() = default;
+
+SealedLogWriter::~SealedLogWriter() {
+    close();
+}
+
+
+/**
+ * @brief Opens a log for appending, creating it with a fresh salt if empty.
+ *
+ * An existing log is walked header by header to find its end; only the last
+ * record is decrypted, to check the key and to pick up its tag as the chain
+ * value for the next append.
+ *
+ * @param path Log file.
+ * @param key Master key (16, 24 or 32 bytes).
+ * @param error Receives a description on failure.
+ * @return true if records can be appended.
+ */
+bool SealedLogWriter::open(const std::string& path, const SecByteBlock& key, std::string& error) {
+    close();
+    std::lock_guard<std::mutex> lock(mutex);
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    ::flock(fd, LOCK_EX);
+    auto fail = [&](const std::string& why) {
+        error = path + ": " + why;
+        ::flock(fd, LOCK_UN);
+        ::close(fd);
+        fd = -1;
+        return false;
+    };
+
+    uint64_t size = 0;
+    if (!fileSize(fd, size)) return fail("cannot stat");
+    byte hdr[kSealedLogHeaderBytes] = {};
+    if (size == 0) {
+        std::memcpy(hdr, kMagic, sizeof(kMagic));
+        hdr[4] = kLogVersion;
+        AutoSeededRandomPool rng;
+        rng.GenerateBlock(hdr + 8, kSaltBytes);
+        if (!writeAll(fd, hdr, sizeof(hdr))) return fail("cannot write header");
+        size = sizeof(hdr);
+    } else if (size < sizeof(hdr) || preadFull(fd, hdr, sizeof(hdr), 0) != static_cast<ssize_t>(sizeof(hdr))
+               || !SealedLogCodec::parseHeader(hdr)) {
+        return fail("not a sealed log");
+    }
+    codec.reset(new SealedLogCodec(key, hdr));
+
+    startCursor(end);
+    uint64_t lastOffset = 0;
+    uint32_t lastLen = 0;
+    for (;;) {
+        uint32_t len;
+        uint64_t seq;
+        const HeaderWalk w = recordAt(fd, end.offset, size, len, seq);
+        if (w == HeaderWalk::Bad || (w == HeaderWalk::Complete && seq != end.sequence))
+            return fail("record " + std::to_string(end.sequence) + " is damaged");
+        if (w == HeaderWalk::Torn) break;
+        lastOffset = end.offset;
+        lastLen = len;
+        end.offset += sealedLogRecordBytes(len);
+        ++end.sequence;
+    }
+    if (end.offset < size && ::ftruncate(fd, static_cast<off_t>(end.offset)) != 0) ///< torn by a crash
+        return fail("cannot cut off a torn record");
+
+    if (end.sequence > 0) {
+        std::vector<byte> last(sealedLogRecordBytes(lastLen));
+        std::vector<byte> plain(lastLen);
+        byte prev[kLogTagBytes] = {};
+        if (lastOffset > kSealedLogHeaderBytes
+            && preadFull(fd, prev, kLogTagBytes, lastOffset - kLogTagBytes) != static_cast<ssize_t>(kLogTagBytes))
+            return fail("read error");
+        if (preadFull(fd, last.data(), last.size(), lastOffset) != static_cast<ssize_t>(last.size()))
+            return fail("read error");
+        if (!codec->open(end.sequence - 1, prev, last.data(), lastLen, plain.data()))
+            return fail("last record does not verify (wrong key or tampered)");
+        std::memcpy(end.chain, last.data() + last.size() - kLogTagBytes, kLogTagBytes);
+    }
+    ::flock(fd, LOCK_UN);
+    return true;
+}
+
+
+void SealedLogWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    codec.reset();
+}
+
+
+/**
+ * @brief Moves `end` past records that other writers appended since our last append.
+ *
+ * Their tags are taken from the file as they are; they become part of the
+ * chain through the next record sealed here.
+ */
+bool SealedLogWriter::catchUp(std::string& error) {
+    uint64_t size = 0;
+    if (!fileSize(fd, size)) {
+        error = "cannot stat log";
+        return false;
+    }
+    if (size < end.offset) {
+        error = "log was truncated while open";
+        return false;
+    }
+    while (end.offset < size) {
+        uint32_t len;
+        uint64_t seq;
+        const HeaderWalk w = recordAt(fd, end.offset, size, len, seq);
+        if (w == HeaderWalk::Torn) { ///< a writer died mid-record: nobody holds the lock, cut it off
+            if (::ftruncate(fd, static_cast<off_t>(end.offset)) != 0) {
+                error = "cannot cut off a torn record";
+                return false;
+            }
+            break;
+        }
+        if (w == HeaderWalk::Bad || seq != end.sequence) {
+            error = "record " + std::to_string(end.sequence) + " is damaged";
+            return false;
+        }
+        end.offset += sealedLogRecordBytes(len);
+        ++end.sequence;
+        if (preadFull(fd, end.chain, kLogTagBytes, end.offset - kLogTagBytes) != static_cast<ssize_t>(kLogTagBytes)) {
+            error = "read error";
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool SealedLogWriter::appendOne(const byte* data, size_t n, std::string& error) {
+    record.resize(sealedLogRecordBytes(n));
+    ::flock(fd, LOCK_EX);
+    bool ok = catchUp(error);
+    if (ok) {
+        codec->seal(end.sequence, end.chain, data, n, record.data());
+        ok = writeAll(fd, record.data(), record.size());
+        if (!ok) error = "write failed";
+    }
+    ::flock(fd, LOCK_UN);
+    if (!ok) return false;
+    end.offset += record.size();
+    ++end.sequence;
+    std::memcpy(end.chain, record.data() + record.size() - kLogTagBytes, kLogTagBytes);
+    return true;
+}
+
+
+/**
+ * @brief Appends `data` as one record, or as several of kMaxLogRecordBytes.
+ */
+bool SealedLogWriter::append(const byte* data, size_t n, std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd < 0) {
+        error = "log not open";
+        return false;
+    }
+    size_t done = 0;
+    do {
+        const size_t piece = std::min<size_t>(n - done, kMaxLogRecordBytes);
+        if (!appendOne(data + done, piece, error)) return false;
+        done += piece;
+    } while (done < n);
+    return true;
+}
+
+
+bool SealedLogWriter::sync(std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd < 0 || ::fdatasync(fd) != 0) {
+        error = "fdatasync failed";
+        return false;
+    }
+    return true;
+}
+
+
+uint64_t SealedLogWriter::records() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return end.sequence;
+}
+
+
+// ---------------- Reading ------------------
+
+/**
+ * @brief Verifies and decrypts records from `cursor` on, in large sequential reads.
+ *
+ * A resumed cursor is first checked against the file: the log must still
+ * reach its offset and the tag just before it must be the saved chain value,
+ * so records removed or rewritten since the checkpoint are reported.
+ *
+ * @param fd Log opened for reading.
+ * @param key Master key.
+ * @param cursor Where to start; advanced past every verified record.
+ * @param sink Receives each record's plaintext; returning false stops early.
+ * @return Outcome; Ok also when the log simply has no further complete record.
+ */
+SealedLogReport readSealedLog(int fd, const SecByteBlock& key, LogCursor& cursor, const LogRecordSink& sink) {
+    SealedLogReport rep;
+    uint64_t size = 0;
+    if (!fileSize(fd, size)) {
+        rep.status = SealedLogReport::Status::IoError;
+        return rep;
+    }
+    if (size == 0 && cursor.offset == 0) return rep; ///< just created, header not written yet
+    byte hdr[kSealedLogHeaderBytes];
+    if (preadFull(fd, hdr, sizeof(hdr), 0) != static_cast<ssize_t>(sizeof(hdr)) || !SealedLogCodec::parseHeader(hdr)) {
+        rep.status = SealedLogReport::Status::BadHeader;
+        return rep;
+    }
+    SealedLogCodec codec(key, hdr);
+    if (cursor.offset == 0) startCursor(cursor);
+    if (size < cursor.offset) {
+        rep.status = SealedLogReport::Status::Truncated;
+        return rep;
+    }
+    if (cursor.offset > kSealedLogHeaderBytes) {
+        byte prev[kLogTagBytes];
+        if (preadFull(fd, prev, kLogTagBytes, cursor.offset - kLogTagBytes) != static_cast<ssize_t>(kLogTagBytes)
+            || std::memcmp(prev, cursor.chain, kLogTagBytes) != 0) {
+            rep.status = SealedLogReport::Status::Corrupt;
+            rep.badRecord = cursor.sequence - 1;
+            return rep;
+        }
+    }
+
+    std::vector<byte> buf;       ///< read-ahead window [bufStart, bufStart + buf.size())
+    uint64_t bufStart = cursor.offset;
+    std::vector<byte> plain;
+    auto window = [&](uint64_t offset, size_t n) -> const byte* {
+        if (offset >= bufStart && offset + n <= bufStart + buf.size()) return buf.data() + (offset - bufStart);
+        if (size - offset < n) return nullptr;
+        buf.resize(static_cast<size_t>(std::min<uint64_t>(std::max(n, kReadAheadBytes), size - offset)));
+        bufStart = offset;
+        const ssize_t got = preadFull(fd, buf.data(), buf.size(), offset);
+        if (got < static_cast<ssize_t>(n)) {
+            buf.clear();
+            return nullptr;
+        }
+        buf.resize(static_cast<size_t>(got));
+        return buf.data();
+    };
+
+    while (cursor.offset < size) {
+        const byte* rh = window(cursor.offset, kLogRecordHeaderBytes);
+        if (!rh) {
+            rep.partialTail = true;
+            break;
+        }
+        const uint32_t len = getBe32(rh);
+        if (len > kMaxLogRecordBytes || getBe64(rh + kSequenceOffset) != cursor.sequence) {
+            rep.status = SealedLogReport::Status::Corrupt;
+            rep.badRecord = cursor.sequence;
+            return rep;
+        }
+        const size_t total = static_cast<size_t>(sealedLogRecordBytes(len));
+        const byte* record = window(cursor.offset, total);
+        if (!record) {
+            rep.partialTail = true;
+            break;
+        }
+        plain.resize(len);
+        if (!codec.open(cursor.sequence, cursor.chain, record, len, plain.data())) {
+            rep.status = SealedLogReport::Status::Corrupt;
+            rep.badRecord = cursor.sequence;
+            return rep;
+        }
+        const bool more = !sink || sink(cursor.sequence, plain.data(), len);
+        std::memcpy(cursor.chain, record + total - kLogTagBytes, kLogTagBytes);
+        cursor.offset += total;
+        ++cursor.sequence;
+        ++rep.records;
+        if (!more) break;
+    }
+    return rep;
+}
+
+
+/**
+ * @brief Positions a cursor `count` records before the end of the log.
+ *
+ * @return false if the file is not a sealed log or its headers are damaged.
+ */
+bool seekSealedLogTail(int fd, uint64_t count, LogCursor& cursor, std::string& error) {
+    uint64_t size = 0;
+    byte hdr[kSealedLogHeaderBytes];
+    if (!fileSize(fd, size) || preadFull(fd, hdr, sizeof(hdr), 0) != static_cast<ssize_t>(sizeof(hdr))
+        || !SealedLogCodec::parseHeader(hdr)) {
+        error = "not a sealed log";
+        return false;
+    }
+    LogCursor walk;
+    startCursor(walk);
+    std::deque<std::pair<uint64_t, uint64_t>> recent; ///< (offset, sequence) of the last `count` records
+    for (;;) {
+        uint32_t len;
+        uint64_t seq;
+        const HeaderWalk w = recordAt(fd, walk.offset, size, len, seq);
+        if (w == HeaderWalk::Torn) break;
+        if (w == HeaderWalk::Bad || seq != walk.sequence) {
+            error = "record " + std::to_string(walk.sequence) + " is damaged";
+            return false;
+        }
+        if (count) {
+            recent.emplace_back(walk.offset, walk.sequence);
+            if (recent.size() > count) recent.pop_front();
+        }
+        walk.offset += sealedLogRecordBytes(len);
+        ++walk.sequence;
+    }
+    if (!recent.empty()) {
+        walk.offset = recent.front().first;
+        walk.sequence = recent.front().second;
+    }
+    std::memset(walk.chain, 0, kLogTagBytes);
+    if (walk.offset > kSealedLogHeaderBytes
+        && preadFull(fd, walk.chain, kLogTagBytes, walk.offset - kLogTagBytes) != static_cast<ssize_t>(kLogTagBytes)) {
+        error = "read error";
+        return false;
+    }
+    cursor = walk;
+    return true;
+}
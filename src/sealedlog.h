@@ -0,0 +1,109 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <cstdint>    // offsets, sequence numbers
+#include <functional> // record sink
+#include <memory>     // codec
+#include <mutex>      // appends from several threads
+#include <string>     // paths, error text
+#include <vector>     // record buffer
+
+#include <cryptopp/secblock.h> // SecByteBlock keys
+
+// Encrypted append-only log (.cqal), for logs that are encrypted as they are
+// written instead of after rotation.
+//
+//   file header  32 bytes: "CQAL" | version u8 (2) | reserved[3] | salt[16] | reserved[8]
+//   record       24 bytes: length u32 BE | nonce[12] | sequence u64 BE
+//                then ciphertext (length bytes) and a 16-byte GCM tag
+//
+// Each record is sealed on its own with AES-GCM under a per-file key
+// HMAC-SHA256(master key, "CQAL/v1 log key" || salt) and a random 96-bit
+// nonce of its own. Sequence numbers are not unique once a torn tail has
+// been cut off (the next append takes the same number again), so they are
+// not used as nonces.
+// The AAD is file header || record header || tag of the previous record
+// (zeros for the first), so the tags form a MAC chain: removing, reordering
+// or replacing a record breaks the chain at that point. Appending never
+// touches earlier bytes.
+//
+// Dropping records from the end leaves a shorter but valid log; that is
+// caught by keeping a LogCursor as a checkpoint. A reader resumed from a
+// cursor checks that the log still extends past it and that the next record
+// chains to the saved tag, then only reads what was appended since
+// (O(new data)), which is what `log-read --follow` and tail views use.
+
+constexpr size_t kSealedLogHeaderBytes = 32;
+constexpr size_t kLogRecordHeaderBytes = 24;
+constexpr size_t kLogTagBytes = 16;
+constexpr uint32_t kMaxLogRecordBytes = 1u << 20; // payload; longer appends are split
+
+inline uint64_t sealedLogRecordBytes(size_t payloadLen) {
+    return kLogRecordHeaderBytes + payloadLen + kLogTagBytes;
+}
+
+// Position just after the last verified record.
+struct LogCursor {
+    uint64_t offset = 0;    // 0 = before the file header (read from the start)
+    uint64_t sequence = 0;  // sequence number of the next record
+    CryptoPP::byte chain[kLogTagBytes] = {}; // tag of the record before `offset`
+
+    std::string toString() const;           // "sequence offset chain-hex", for checkpoint files
+    bool parse(const std::string& text);
+};
+
+struct SealedLogReport {
+    enum class Status { Ok, IoError, BadHeader, Corrupt, Truncated };
+
+    Status status = Status::Ok;
+    uint64_t records = 0;     // records verified (and passed to the sink) in this call
+    uint64_t badRecord = 0;   // sequence number where verification failed (Corrupt)
+    bool partialTail = false; // the log ends in a record still being written
+};
+
+const char* describeSealedLogStatus(SealedLogReport::Status status);
+
+class SealedLogCodec; // sealedlog.cpp
+
+class SealedLogWriter {
+public:
+    SealedLogWriter();
+    ~SealedLogWriter();
+    SealedLogWriter(const SealedLogWriter&) = delete;
+    SealedLogWriter& operator=(const SealedLogWriter&) = delete;
+
+    // Creates the log or continues an existing one. A record torn by a crash
+    // at the end is cut off; a last record that fails to verify (wrong key,
+    // tampering) refuses the open.
+    bool open(const std::string& path, const CryptoPP::SecByteBlock& key, std::string& error);
+    void close();
+
+    // Seals `data` as one record (several if longer than kMaxLogRecordBytes),
+    // written with one write() under flock. Other processes may append to
+    // the same log; their records are chained in, never overwritten.
+    bool append(const CryptoPP::byte* data, size_t n, std::string& error);
+    bool sync(std::string& error); // fdatasync
+    uint64_t records() const;      // records in the log as of the last append
+
+private:
+    bool catchUp(std::string& error);  // with flock held: follow records other writers added
+    bool appendOne(const CryptoPP::byte* data, size_t n, std::string& error);
+
+    int fd = -1;
+    std::unique_ptr<SealedLogCodec> codec;
+    LogCursor end;
+    std::vector<CryptoPP::byte> record;
+    mutable std::mutex mutex;
+};
+
+// Called for each verified record; return false to stop reading.
+using LogRecordSink = std::function<bool(uint64_t sequence, const CryptoPP::byte* data, size_t n)>;
+
+// Verifies and decrypts the records after `cursor` (the whole log for a
+// default cursor), advancing it past each one. A record still being written
+// at the end is left for the next call.
+SealedLogReport readSealedLog(int fd, const CryptoPP::SecByteBlock& key, LogCursor& cursor,
+                              const LogRecordSink& sink);
+
+// Cursor for reading the last `count` records. Walks record headers only
+// (nothing is decrypted); the chain value comes from the record before.
+bool seekSealedLogTail(int fd, uint64_t count, LogCursor& cursor, std::string& error);
@@ -0,0 +1,294 @@
+#include "signing.h"
+#include "streamhash.h"   // sha512File (streaming digest)
+#include "textcodec.h"    // toHex / fromHex
+#include "workerpool.h"   // parallel batch processing
+
+#include <sstream>        // manifest line parsing
+
+// Crypto++ includes
+#include <cryptopp/xed25519.h> // Ed25519 signer / verifier
+#include <cryptopp/osrng.h>    // secure random number generator
+
+using namespace CryptoPP;
+
+// ---------------- Helper functions ------------------
+
+/**
+ * @brief Resolves a manifest path against the manifest's directory.
+ */
+static std::string resolvePath(const std::string& baseDir, const std::string& path) {
+    if (baseDir.empty() || path.empty() || path[0] == '/') return path;
+    return baseDir + "/" + path;
+}
+
+
+/**
+ * @brief Signs a precomputed SHA-512 digest.
+ */
+static void signDigest(const ed25519Signer& signer, const std::string& digest, std::string& signature) {
+    signature.resize(kEd25519SignatureBytes);
+    // Ed25519 signing is deterministic, the RNG is never used
+    signer.SignMessage(NullRNG(),
+                       reinterpret_cast<const byte*>(digest.data()), digest.size(),
+                       reinterpret_cast<byte*>(&signature[0]));
+}
+
+
+/**
+ * @brief Verifies a signature over a precomputed SHA-512 digest.
+ */
+static bool verifyDigest(const ed25519Verifier& verifier, const std::string& digest, const std::string& signature) {
+    if (signature.size() != kEd25519SignatureBytes) return false;
+    return verifier.VerifyMessage(reinterpret_cast<const byte*>(digest.data()), digest.size(),
+                                  reinterpret_cast<const byte*>(signature.data()), signature.size());
+}
+
+
+// ---------------- Keys ------------------
+
+/**
+ * @brief Generates a fresh Ed25519 key pair.
+ *
+ * @param out Receives the raw secret and public keys.
+ */
+void generateEd25519KeyPair(Ed25519KeyPair& out) {
+    AutoSeededRandomPool rng;
+    ed25519::Signer signer(rng);
+    const ed25519PrivateKey& priv = dynamic_cast<const ed25519PrivateKey&>(signer.GetPrivateKey());
+    out.secretKey.assign(reinterpret_cast<const char*>(priv.GetPrivateKeyBytePtr()), kEd25519KeyBytes);
+    out.publicKey.assign(reinterpret_cast<const char*>(priv.GetPublicKeyBytePtr()), kEd25519KeyBytes);
+}
+
+
+/**
+ * @brief Parses a hex key: secret||public (128 hex chars) or public only (64 hex chars).
+ *
+ * @param hex Key text, surrounding whitespace is ignored.
+ * @param out Receives the key; secretKey stays empty for public-only input.
+ * @return false if the text is not valid hex of either length, or the public
+ *         half does not match the secret half.
+ */
+bool parseEd25519Key(const std::string& hex, Ed25519KeyPair& out) {
+    size_t b = hex.find_first_not_of(" \t\r\n");
+    size_t e = hex.find_last_not_of(" \t\r\n");
+    std::string raw;
+    if (b == std::string::npos || !fromHex(hex.substr(b, e - b + 1), raw)) return false;
+
+    if (raw.size() == kEd25519KeyBytes) {
+        out.secretKey.clear();
+        out.publicKey = raw;
+        return true;
+    }
+    if (raw.size() != 2 * kEd25519KeyBytes) return false;
+
+    out.secretKey = raw.substr(0, kEd25519KeyBytes);
+    out.publicKey = raw.substr(kEd25519KeyBytes);
+
+    // reject mismatched halves: a wrong public key would yield signatures nobody can verify
+    ed25519::Signer signer(reinterpret_cast<const byte*>(out.secretKey.data()));
+    const ed25519PrivateKey& priv = dynamic_cast<const ed25519PrivateKey&>(signer.GetPrivateKey());
+    return out.publicKey.compare(0, kEd25519KeyBytes,
+                                 reinterpret_cast<const char*>(priv.GetPublicKeyBytePtr()),
+                                 kEd25519KeyBytes) == 0;
+}
+
+
+/**
+ * @brief Formats a key pair as hex (secret||public, or public only).
+ */
+std::string formatEd25519Key(const Ed25519KeyPair& key) {
+    return toHex(key.secretKey + key.publicKey);
+}
+
+
+/**
+ * @brief Parses a hex signature (as stored in .ed25519sig sidecar files).
+ *
+ * @param hex Signature text, surrounding whitespace is ignored.
+ * @param signature Receives the raw 64-byte signature.
+ * @return false if the text is not 128 hex characters.
+ */
+bool parseEd25519Signature(const std::string& hex, std::string& signature) {
+    size_t b = hex.find_first_not_of(" \t\r\n");
+    size_t e = hex.find_last_not_of(" \t\r\n");
+    if (b == std::string::npos || !fromHex(hex.substr(b, e - b + 1), signature)) return false;
+    return signature.size() == kEd25519SignatureBytes;
+}
+
+
+/**
+ * @brief Formats a raw signature as lowercase hex.
+ */
+std::string formatEd25519Signature(const std::string& signature) {
+    return toHex(signature);
+}
+
+
+// ---------------- Single file ------------------
+
+/**
+ * @brief Signs the SHA-512 digest of a file.
+ *
+ * @param path File to sign.
+ * @param key Key pair; must contain the secret half.
+ * @param signature Receives the raw 64-byte signature.
+ * @return false if the key has no secret half or the file cannot be read.
+ */
+bool signFileDigest(const std::string& path, const Ed25519KeyPair& key, std::string& signature) {
+    if (key.secretKey.size() != kEd25519KeyBytes) return false;
+    std::string digest;
+    if (!sha512File(path, digest)) return false;
+    ed25519::Signer signer(reinterpret_cast<const byte*>(key.publicKey.data()),
+                           reinterpret_cast<const byte*>(key.secretKey.data()));
+    signDigest(signer, digest, signature);
+    return true;
+}
+
+
+/**
+ * @brief Verifies a signature over the SHA-512 digest of a file.
+ *
+ * @param path File to check.
+ * @param key Key pair; only the public half is used.
+ * @param signature Raw 64-byte signature.
+ * @param valid Set to the verification result.
+ * @return false if the key or file cannot be used (valid is then false as well).
+ */
+bool verifyFileDigest(const std::string& path, const Ed25519KeyPair& key, const std::string& signature,
+                      bool& valid) {
+    valid = false;
+    std::string digest;
+    if (key.publicKey.size() != kEd25519KeyBytes || !sha512File(path, digest)) return false;
+    ed25519::Verifier verifier(reinterpret_cast<const byte*>(key.publicKey.data()));
+    valid = verifyDigest(verifier, digest, signature);
+    return true;
+}
+
+
+// ---------------- Batches ------------------
+
+/**
+ * @brief Signs many files in parallel.
+ *
+ * The signer (including the public key, so it is not re-derived from the
+ * secret per file) is built once and shared read-only by all workers.
+ *
+ * @param entries Files to sign; signature and status are filled in.
+ * @param key Key pair with secret half.
+ * @param baseDir Directory that relative paths are resolved against.
+ * @param pool Pool that runs the hashing and signing.
+ * @param completed Optional counter incremented once per finished entry.
+ */
+void signFilesBatch(std::vector<SignatureEntry>& entries, const Ed25519KeyPair& key,
+                    const std::string& baseDir, WorkerPool& pool, std::atomic<size_t>* completed) {
+    if (key.secretKey.size() != kEd25519KeyBytes) {
+        for (SignatureEntry& e : entries) e.status = SignatureEntry::Status::Invalid;
+        return;
+    }
+    const ed25519::Signer signer(reinterpret_cast<const byte*>(key.publicKey.data()),
+                                 reinterpret_cast<const byte*>(key.secretKey.data()));
+
+    pool.parallelFor(entries.size(), [&](size_t i) {
+        SignatureEntry& e = entries[i];
+        std::string digest;
+        if (!sha512File(resolvePath(baseDir, e.path), digest)) {
+            e.status = SignatureEntry::Status::Unreadable;
+        } else {
+            signDigest(signer, digest, e.signature);
+            e.status = SignatureEntry::Status::Valid;
+        }
+        if (completed) completed->fetch_add(1, std::memory_order_relaxed);
+    });
+}
+
+
+/**
+ * @brief Verifies many file signatures in parallel.
+ *
+ * Crypto++ exposes no multi-scalar batch equation for Ed25519, so the
+ * amortization is per-key (one verifier shared by all workers) and across
+ * cores; file hashing, the dominant cost, streams in constant memory.
+ *
+ * @param entries Files with signatures; status is filled in.
+ * @param key Key pair; only the public half is used.
+ * @param baseDir Directory that relative paths are resolved against.
+ * @param pool Pool that runs the hashing and verification.
+ * @param completed Optional counter incremented once per finished entry.
+ * @return Number of entries with a valid signature.
+ */
+size_t verifyFilesBatch(std::vector<SignatureEntry>& entries, const Ed25519KeyPair& key,
+                        const std::string& baseDir, WorkerPool& pool, std::atomic<size_t>* completed) {
+    if (key.publicKey.size() != kEd25519KeyBytes) {
+        for (SignatureEntry& e : entries) e.status = SignatureEntry::Status::Invalid;
+        return 0;
+    }
+    const ed25519::Verifier verifier(reinterpret_cast<const byte*>(key.publicKey.data()));
+    std::atomic<size_t> valid{0};
+
+    pool.parallelFor(entries.size(), [&](size_t i) {
+        SignatureEntry& e = entries[i];
+        std::string digest;
+        if (!sha512File(resolvePath(baseDir, e.path), digest)) {
+            e.status = SignatureEntry::Status::Unreadable;
+        } else if (verifyDigest(verifier, digest, e.signature)) {
+            e.status = SignatureEntry::Status::Valid;
+            valid.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            e.status = SignatureEntry::Status::Invalid;
+        }
+        if (completed) completed->fetch_add(1, std::memory_order_relaxed);
+    });
+    return valid.load();
+}
+
+
+// ---------------- Manifests ------------------
+
+/**
+ * @brief Parses a signature manifest ("<hex signature>  <path>" per line).
+ *
+ * Blank lines and lines starting with '#' are skipped.
+ *
+ * @param text Manifest contents.
+ * @param out Receives one entry per file line.
+ * @param badLine Set to the 1-based number of the first malformed line on failure.
+ * @return false if any line is malformed.
+ */
+bool parseSignatureManifest(const std::string& text, std::vector<SignatureEntry>& out, size_t& badLine) {
+    out.clear();
+    std::istringstream in(text);
+    std::string line;
+    size_t lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        const size_t hexLen = 2 * kEd25519SignatureBytes;
+        SignatureEntry e;
+        if (line.size() < hexLen + 3 || line.compare(hexLen, 2, "  ") != 0 ||
+            !fromHex(line.substr(0, hexLen), e.signature)) {
+            badLine = lineNo;
+            return false;
+        }
+        e.path = line.substr(hexLen + 2);
+        out.push_back(std::move(e));
+    }
+    return true;
+}
+
+
+/**
+ * @brief Formats signed entries as a manifest; unreadable entries are skipped.
+ */
+std::string formatSignatureManifest(const std::vector<SignatureEntry>& entries) {
+    std::string text;
+    for (const SignatureEntry& e : entries) {
+        if (e.status != SignatureEntry::Status::Valid) continue;
+        text += toHex(e.signature);
+        text += "  ";
+        text += e.path;
+        text += '\n';
+    }
+    return text;
+}
@@ -0,0 +1,57 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <atomic>   // optional completion counter for progress display
+#include <cstddef>  // size_t
+#include <string>   // raw keys, signatures and paths
+#include <vector>   // batch entries
+
+class WorkerPool;
+
+// Ed25519 signatures over SHA-512 file digests ("ed25519-sha512").
+// The signed message is the raw 64-byte SHA-512 digest of the file contents,
+// so files are streamed once through the hash and never held in memory.
+//
+// Key encoding (hex in the GUI / key files):
+//   secret || public  (64 bytes, 128 hex chars) - can sign and verify
+//   public            (32 bytes,  64 hex chars) - can only verify
+
+constexpr size_t kEd25519KeyBytes = 32;
+constexpr size_t kEd25519SignatureBytes = 64;
+
+struct Ed25519KeyPair {
+    std::string secretKey; // raw 32 bytes (empty for verify-only keys)
+    std::string publicKey; // raw 32 bytes
+};
+
+// One file in a batch sign/verify run.
+struct SignatureEntry {
+    enum class Status { Pending, Valid, Invalid, Unreadable };
+
+    std::string path;      // path as written in the manifest
+    std::string signature; // raw 64 bytes (filled by batch sign, read by batch verify)
+    Status status = Status::Pending;
+};
+
+void generateEd25519KeyPair(Ed25519KeyPair& out);
+bool parseEd25519Key(const std::string& hex, Ed25519KeyPair& out);
+std::string formatEd25519Key(const Ed25519KeyPair& key); // secret||public in hex
+bool parseEd25519Signature(const std::string& hex, std::string& signature);
+std::string formatEd25519Signature(const std::string& signature);
+
+bool signFileDigest(const std::string& path, const Ed25519KeyPair& key, std::string& signature);
+bool verifyFileDigest(const std::string& path, const Ed25519KeyPair& key, const std::string& signature,
+                      bool& valid);
+
+// Batch variants: every entry is hashed and signed/verified on the pool.
+// `baseDir` resolves relative manifest paths; `completed` (if given) is bumped
+// once per finished entry so callers can poll progress.
+void signFilesBatch(std::vector<SignatureEntry>& entries, const Ed25519KeyPair& key,
+                    const std::string& baseDir, WorkerPool& pool,
+                    std::atomic<size_t>* completed = nullptr);
+size_t verifyFilesBatch(std::vector<SignatureEntry>& entries, const Ed25519KeyPair& key,
+                        const std::string& baseDir, WorkerPool& pool,
+                        std::atomic<size_t>* completed = nullptr);
+
+// Manifest text: one "<signature hex>  <path>" line per file (sha256sum layout).
+bool parseSignatureManifest(const std::string& text, std::vector<SignatureEntry>& out, size_t& badLine);
+std::string formatSignatureManifest(const std::vector<SignatureEntry>& entries);
@@ -0,0 +1,192 @@
+#include "streamcipher.h"
+#include "fdio.h"    // readFull, fdWriter, kStreamChunkBytes
+#include "streamhash.h" // fused digests
+
+#include <vector>    // read buffer
+
+// Crypto++ includes
+#include <cryptopp/aes.h>     // AES block cipher
+#include <cryptopp/modes.h>   // CBC mode
+#include <cryptopp/filters.h> // StreamTransformationFilter, StringSink
+#include <cryptopp/osrng.h>   // IV generation
+
+using namespace CryptoPP;
+
+struct StreamCipher::Impl {
+    CBC_Mode<AES>::Encryption enc;
+    CBC_Mode<AES>::Decryption dec;
+    std::string pending;                               ///< filter output not yet handed out
+    std::unique_ptr<StreamTransformationFilter> filter;
+};
+
+
+/**
+ * @brief Keys the cipher and builds the padding filter.
+ *
+ * @param dir Encrypt or decrypt.
+ * @param key AES key (16, 24 or 32 bytes).
+ * @param iv Initialization vector.
+ * @param ivLen IV length (AES block size).
+ */
+StreamCipher::StreamCipher(Direction dir, const SecByteBlock& key, const byte* iv, size_t ivLen)
+    : d(new Impl) {
+    StreamTransformation* mode;
+    if (dir == Direction::Encrypt) {
+        d->enc.SetKeyWithIV(key, key.size(), iv, ivLen);
+        mode = &d->enc;
+    } else {
+        d->dec.SetKeyWithIV(key, key.size(), iv, ivLen);
+        mode = &d->dec;
+    }
+    d->filter.reset(new StreamTransformationFilter(
+        *mode,
+        new StringSink(d->pending),
+        StreamTransformationFilter::PKCS_PADDING
+    ));
+}
+
+StreamCipher::~StreamCipher() = default;
+
+
+/**
+ * @brief Transforms the next piece of input.
+ *
+ * @param in Input bytes.
+ * @param n Input length.
+ * @param out Receives (appended) whatever output is ready.
+ */
+void StreamCipher::update(const byte* in, size_t n, std::string& out) {
+    d->filter->Put(in, n);
+    out.append(d->pending);
+    d->pending.clear();
+}
+
+
+/**
+ * @brief Flushes the last block (adds or strips padding).
+ *
+ * @param out Receives (appended) the remaining output.
+ * @throws CryptoPP::Exception if decryption finds invalid padding.
+ */
+void StreamCipher::final(std::string& out) {
+    d->filter->MessageEnd();
+    out.append(d->pending);
+    d->pending.clear();
+}
+
+
+/**
+ * @brief Encrypts a stream: writes a fresh IV, then the CBC ciphertext.
+ *
+ * @param in Plaintext source, read until EOF.
+ * @param out Destination for IV || ciphertext.
+ * @param key AES key.
+ * @param ivBytes IV length (from config, normally 16).
+ * @param error Receives a description on failure.
+ * @param digests Optional plaintext / output hashes, updated in the same pass.
+ * @return true on success.
+ */
+bool encryptStream(const ByteReader& in, const ByteWriter& out, const SecByteBlock& key, size_t ivBytes,
+                   std::string& error, const StreamDigests* digests) {
+    HashTransformation* plainHash = digests ? digests->plain : nullptr;
+    const ByteWriter write = hashingWriter(out, digests ? digests->cipher : nullptr);
+
+    AutoSeededRandomPool rng;
+    SecByteBlock iv(ivBytes);
+    rng.GenerateBlock(iv, iv.size());
+    if (!write(iv.BytePtr(), iv.size())) {
+        error = "write failed";
+        return false;
+    }
+
+    StreamCipher cipher(StreamCipher::Direction::Encrypt, key, iv, iv.size());
+    std::vector<byte> buf(kStreamChunkBytes);
+    std::string ct;
+    ct.reserve(kStreamChunkBytes + AES::BLOCKSIZE);
+    for (;;) {
+        ssize_t n = in(buf.data(), buf.size());
+        if (n < 0) {
+            error = "read failed";
+            return false;
+        }
+        if (n == 0) break;
+        if (plainHash) plainHash->Update(buf.data(), static_cast<size_t>(n));
+        ct.clear();
+        cipher.update(buf.data(), static_cast<size_t>(n), ct);
+        if (!write(reinterpret_cast<const byte*>(ct.data()), ct.size())) {
+            error = "write failed";
+            return false;
+        }
+        if (static_cast<size_t>(n) < buf.size()) break; ///< short read means EOF
+    }
+    ct.clear();
+    cipher.final(ct);
+    if (!write(reinterpret_cast<const byte*>(ct.data()), ct.size())) {
+        error = "write failed";
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Decrypts a stream produced by encryptStream() or the GUI (.aescbc).
+ *
+ * CBC has no authentication: plaintext is emitted as it is recovered, and a
+ * wrong key or corrupt tail is only detected by the padding check at the end.
+ *
+ * @param in Source of IV || ciphertext.
+ * @param out Plaintext destination.
+ * @param key AES key.
+ * @param ivBytes IV length (from config, normally 16).
+ * @param error Receives a description on failure.
+ * @return true on success.
+ * @throws CryptoPP::Exception on invalid padding (wrong key or corrupt data).
+ */
+bool decryptStream(const ByteReader& in, const ByteWriter& out, const SecByteBlock& key, size_t ivBytes,
+                   std::string& error) {
+    SecByteBlock iv(ivBytes);
+    ssize_t got = in(iv.BytePtr(), iv.size());
+    if (got < 0 || static_cast<size_t>(got) != iv.size()) {
+        error = "input too small to contain IV";
+        return false;
+    }
+
+    StreamCipher cipher(StreamCipher::Direction::Decrypt, key, iv, iv.size());
+    std::vector<byte> buf(kStreamChunkBytes);
+    std::string pt;
+    pt.reserve(kStreamChunkBytes + AES::BLOCKSIZE);
+    for (;;) {
+        ssize_t n = in(buf.data(), buf.size());
+        if (n < 0) {
+            error = "read failed";
+            return false;
+        }
+        if (n == 0) break;
+        pt.clear();
+        cipher.update(buf.data(), static_cast<size_t>(n), pt);
+        if (!out(reinterpret_cast<const byte*>(pt.data()), pt.size())) {
+            error = "write failed";
+            return false;
+        }
+        if (static_cast<size_t>(n) < buf.size()) break; ///< short read means EOF
+    }
+    pt.clear();
+    cipher.final(pt);
+    if (!out(reinterpret_cast<const byte*>(pt.data()), pt.size())) {
+        error = "write failed";
+        return false;
+    }
+    return true;
+}
+
+
+bool encryptStream(int inFd, int outFd, const SecByteBlock& key, size_t ivBytes, std::string& error,
+                   const StreamDigests* digests) {
+    return encryptStream(fdReader(inFd), fdWriter(outFd), key, ivBytes, error, digests);
+}
+
+
+bool decryptStream(int inFd, int outFd, const SecByteBlock& key, size_t ivBytes, std::string& error) {
+    return decryptStream(fdReader(inFd), fdWriter(outFd), key, ivBytes, error);
+}
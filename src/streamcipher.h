@@ -0,0 +1,41 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include "fdio.h"   // ByteReader / ByteWriter
+
+#include <cstddef>  // size_t
+#include <memory>   // pimpl
+#include <string>   // output buffers, error text
+
+#include <cryptopp/secblock.h> // SecByteBlock keys
+
+// Incremental AES-CBC (PKCS#7 padding) in the app's file format: the caller
+// handles the IV, this class only transforms. Output for each update() may
+// lag the input by one block because padding is resolved in final().
+class StreamCipher {
+public:
+    enum class Direction { Encrypt, Decrypt };
+
+    StreamCipher(Direction dir, const CryptoPP::SecByteBlock& key, const CryptoPP::byte* iv, size_t ivLen);
+    ~StreamCipher();
+
+    void update(const CryptoPP::byte* in, size_t n, std::string& out); // appends to out
+    void final(std::string& out);                                      // appends to out; throws on bad padding
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+};
+
+struct StreamDigests; // streamhash.h
+
+// Stream formats used by the CLI filter mode; identical to the GUI's .aescbc
+// files (IV || AES-CBC ciphertext). Both run in constant memory. `digests`
+// see the plaintext and the output (IV included) as they pass.
+bool encryptStream(int inFd, int outFd, const CryptoPP::SecByteBlock& key, size_t ivBytes, std::string& error,
+                   const StreamDigests* digests = nullptr);
+bool decryptStream(int inFd, int outFd, const CryptoPP::SecByteBlock& key, size_t ivBytes, std::string& error);
+// Same over pluggable streams (e.g. armor.h wrapped around a descriptor).
+bool encryptStream(const ByteReader& in, const ByteWriter& out, const CryptoPP::SecByteBlock& key, size_t ivBytes,
+                   std::string& error, const StreamDigests* digests = nullptr);
+bool decryptStream(const ByteReader& in, const ByteWriter& out, const CryptoPP::SecByteBlock& key, size_t ivBytes,
+                   std::string& error);
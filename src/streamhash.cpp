@@ -0,0 +1,147 @@
+#include "streamhash.h"
+#include "fdio.h"    // readFull, tuneStreamFd, kStreamChunkBytes, renameNoReplace
+#include "numa.h"    // ScratchBuffer
+#include "textcodec.h" // toHex
+
+#include <algorithm> // min
+#include <cctype>    // tolower
+#include <cerrno>    // EEXIST
+#include <cstdio>    // rename
+
+#include <fcntl.h>   // open
+#include <unistd.h>  // close, fdatasync, unlink
+
+#include <cryptopp/sha.h>     // SHA-256 / SHA-512
+
+using namespace CryptoPP;
+
+
+/**
+ * @brief Hashes a stream without loading it into memory.
+ *
+ * @param fd Descriptor to read until EOF (file, pipe or stdin).
+ * @param hash Hash (or MAC) object; it is restarted before use.
+ * @param digest Receives the raw digest bytes.
+ * @return true on success, false on a read error.
+ */
+bool hashFd(int fd, HashTransformation& hash, std::string& digest) {
+    hash.Restart();
+    ScratchBuffer buf(kStreamChunkBytes); ///< node-local on pinned batch workers
+    for (;;) {
+        ssize_t n = readFull(fd, buf.data(), kStreamChunkBytes);
+        if (n < 0) return false;
+        if (n == 0) break; ///< EOF
+        hash.Update(buf.data(), static_cast<size_t>(n));
+        if (static_cast<size_t>(n) < kStreamChunkBytes) break; ///< short read means EOF
+    }
+
+    digest.resize(hash.DigestSize());
+    hash.Final(reinterpret_cast<byte*>(&digest[0]));
+    return true;
+}
+
+
+/**
+ * @brief Hashes a file without loading it into memory.
+ *
+ * @param path Path of the file to hash.
+ * @param hash Hash (or MAC) object; it is restarted before use.
+ * @param digest Receives the raw digest bytes.
+ * @return true on success, false if the file could not be opened or read.
+ */
+bool hashFile(const std::string& path, HashTransformation& hash, std::string& digest) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    tuneStreamFd(fd);
+    bool ok = hashFd(fd, hash, digest);
+    ::close(fd);
+    return ok;
+}
+
+
+/**
+ * @brief Computes the raw SHA-512 digest of a file.
+ *
+ * @param path Path of the file to hash.
+ * @param digest Receives the 64-byte digest.
+ * @return true on success.
+ */
+bool sha512File(const std::string& path, std::string& digest) {
+    SHA512 sha;
+    return hashFile(path, sha, digest);
+}
+
+// ---------------- Fused digests ------------------
+
+std::string hashShortName(const std::string& name) {
+    std::string s;
+    for (char c : name)
+        if (c != '-') s += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return (s == "sha256" || s == "sha512") ? s : std::string();
+}
+
+
+std::unique_ptr<HashTransformation> makeHash(const std::string& name) {
+    const std::string s = hashShortName(name);
+    if (s == "sha256") return std::unique_ptr<HashTransformation>(new SHA256);
+    if (s == "sha512") return std::unique_ptr<HashTransformation>(new SHA512);
+    return nullptr;
+}
+
+
+ByteWriter hashingWriter(ByteWriter out, HashTransformation* hash) {
+    if (!hash) return out;
+    return [out = std::move(out), hash](const unsigned char* data, size_t n) {
+        hash->Update(data, n);
+        return out(data, n);
+    };
+}
+
+
+/**
+ * @brief Feeds a run of zero bytes (hole or zero extent) into a hash.
+ *
+ * Costs hashing time but no I/O, so sparse inputs still get the digest of
+ * the full logical file.
+ */
+void hashZeros(HashTransformation& hash, uint64_t n) {
+    static const byte zeros[64 * 1024] = {};
+    while (n > 0) {
+        const size_t step = static_cast<size_t>(std::min<uint64_t>(n, sizeof(zeros)));
+        hash.Update(zeros, step);
+        n -= step;
+    }
+}
+
+
+std::string finalHex(HashTransformation& hash) {
+    std::string digest(hash.DigestSize(), '\0');
+    hash.Final(reinterpret_cast<byte*>(&digest[0]));
+    return toHex(digest);
+}
+
+
+/**
+ * @brief Writes a digest sidecar atomically.
+ *
+ * @param path Final sidecar path.
+ * @param hexAndName Lines to write as "<hex>  <name>".
+ * @param replace Whether an existing sidecar may be replaced.
+ * @return Empty on success, otherwise the reason.
+ */
+std::string writeDigestSidecar(const std::string& path,
+                               const std::vector<std::pair<std::string, std::string>>& hexAndName, bool replace) {
+    std::string text;
+    for (const auto& e : hexAndName) text += e.first + "  " + e.second + "\n";
+
+    const std::string tmp = path + ".part";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | (replace ? O_TRUNC : O_EXCL) | O_CLOEXEC, 0644);
+    if (fd < 0) return (!replace && errno == EEXIST ? "output in progress: " : "cannot create ") + tmp;
+    bool ok = writeAll(fd, text.data(), text.size()) && ::fdatasync(fd) == 0;
+    ok = (::close(fd) == 0) && ok;
+    if (ok && (replace ? std::rename(tmp.c_str(), path.c_str()) == 0 : renameNoReplace(tmp, path)))
+        return std::string();
+    const bool exists = !replace && errno == EEXIST;
+    ::unlink(tmp.c_str());
+    return (exists ? "output already exists: " : "cannot write ") + path;
+}
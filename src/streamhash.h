@@ -0,0 +1,51 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include "fdio.h"    // ByteWriter
+
+#include <cstddef>  // size_t
+#include <cstdint>  // zero run lengths
+#include <memory>   // makeHash
+#include <string>   // file paths and raw digests
+#include <utility>  // sidecar entries
+#include <vector>
+
+#include <cryptopp/cryptlib.h> // HashTransformation (SHA-256, SHA-512, HMAC, ...)
+
+// Streams everything readable from `fd` through `hash` in fixed-size chunks
+// (constant memory) and stores the raw digest in `digest`. Returns false on read errors.
+bool hashFd(int fd, CryptoPP::HashTransformation& hash, std::string& digest);
+
+// Same as hashFd() for the file at `path`. Returns false if the file cannot be read.
+bool hashFile(const std::string& path, CryptoPP::HashTransformation& hash, std::string& digest);
+
+// Convenience wrapper: raw 64-byte SHA-512 digest of a file.
+bool sha512File(const std::string& path, std::string& digest);
+
+// ---------------- Fused digests ------------------
+
+// Hashes updated during an encryption pass, so an inventory needs no second
+// read: `plain` sees every plaintext byte (zero extents as zeros), `cipher`
+// every output byte. Either may be null; the caller finalizes them.
+struct StreamDigests {
+    CryptoPP::HashTransformation* plain = nullptr;
+    CryptoPP::HashTransformation* cipher = nullptr;
+};
+
+// New hash object for "SHA-256" / "sha256" / "SHA-512" / "sha512"; null if unsupported.
+std::unique_ptr<CryptoPP::HashTransformation> makeHash(const std::string& name);
+// "sha256" / "sha512" for a name accepted by makeHash() (sidecar extension, CLI spelling).
+std::string hashShortName(const std::string& name);
+
+// Writer that feeds everything it forwards to `out` into `hash` (`out` itself when hash is null).
+ByteWriter hashingWriter(ByteWriter out, CryptoPP::HashTransformation* hash);
+void hashZeros(CryptoPP::HashTransformation& hash, uint64_t n);
+// Finalizes `hash` and returns the lowercase hex digest.
+std::string finalHex(CryptoPP::HashTransformation& hash);
+
+// Publishes "<hex>  <name>" lines (sha256sum format) at `path` via "<path>.part",
+// fdatasync and rename. With replace = false the .part is created
+// exclusively and an existing `path` is never replaced (renameNoReplace).
+// Returns "" or the failure reason.
+std::string writeDigestSidecar(const std::string& path,
+                               const std::vector<std::pair<std::string, std::string>>& hexAndName,
+                               bool replace = true);
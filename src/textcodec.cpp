@@ -0,0 +1,405 @@
+#include "textcodec.h"
+
+#include <algorithm>  // min
+#include <array>      // lookup tables
+#include <cstdint>    // SIZE_MAX
+#include <cstring>    // memcpy
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define TEXTCODEC_X86 1
+#include <immintrin.h> // SSE2 (baseline on x86-64), SSSE3 behind a target attribute
+#endif
+
+// ---------------- Tables ------------------
+
+namespace {
+
+const char kHexDigits[] = "0123456789abcdef";
+const char kBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+constexpr std::array<signed char, 256> makeHexValues() {
+    std::array<signed char, 256> t{};
+    for (int c = 0; c < 256; ++c) t[c] = -1;
+    for (int c = '0'; c <= '9'; ++c) t[c] = static_cast<signed char>(c - '0');
+    for (int c = 'a'; c <= 'f'; ++c) t[c] = static_cast<signed char>(c - 'a' + 10);
+    for (int c = 'A'; c <= 'F'; ++c) t[c] = static_cast<signed char>(c - 'A' + 10);
+    return t;
+}
+
+constexpr std::array<signed char, 256> makeBase64Values() {
+    std::array<signed char, 256> t{};
+    for (int c = 0; c < 256; ++c) t[c] = -1;
+    for (int i = 0; i < 64; ++i) t[static_cast<unsigned char>(kBase64Alphabet[i])] = static_cast<signed char>(i);
+    return t;
+}
+
+constexpr std::array<signed char, 256> kHexValues = makeHexValues();
+constexpr std::array<signed char, 256> kBase64Values = makeBase64Values();
+
+inline bool isBase64Space(char c) {
+    return c == '\n' || c == '\r' || c == ' ' || c == '\t';
+}
+
+// ---------------- SIMD kernels ------------------
+
+#ifdef TEXTCODEC_X86
+
+/**
+ * @brief Hex-encodes 16 bytes per iteration; returns how many input bytes were done.
+ */
+size_t hexEncodeSse2(const unsigned char* in, size_t n, char* out) {
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i letterGap = _mm_set1_epi8('a' - '0' - 10);
+    auto toChars = [&](__m128i nibbles) {
+        const __m128i gap = _mm_and_si128(_mm_cmpgt_epi8(nibbles, nine), letterGap);
+        return _mm_add_epi8(_mm_add_epi8(nibbles, zero), gap);
+    };
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+        const __m128i lo = _mm_and_si128(v, mask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), toChars(_mm_unpacklo_epi8(hi, lo)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), toChars(_mm_unpackhi_epi8(hi, lo)));
+    }
+    return i;
+}
+
+
+/**
+ * @brief Nibble values of 16 hex characters; sets `ok` to false if any is not hex.
+ */
+inline __m128i hexNibblesSse2(__m128i c, bool& ok) {
+    const __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    const __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                          _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), c));
+    const __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                           _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lower));
+    ok = _mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) == 0xffff;
+    return _mm_or_si128(_mm_and_si128(isDigit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+                        _mm_and_si128(isLetter, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+}
+
+
+/**
+ * @brief Decodes 32 hex characters per iteration; stops early at the first block with a non-hex character.
+ */
+size_t hexDecodeSse2(const char* in, size_t n, unsigned char* out) {
+    const __m128i lowByte = _mm_set1_epi16(0x00ff);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        bool ok1, ok2;
+        const __m128i a = hexNibblesSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), ok1);
+        const __m128i b = hexNibblesSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 16)), ok2);
+        if (!ok1 || !ok2) break; ///< the scalar loop reports it
+        // each 16-bit lane holds (high nibble, low nibble): byte = high << 4 | low
+        const __m128i wa = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(a, lowByte), 4), _mm_srli_epi16(a, 8));
+        const __m128i wb = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(b, lowByte), 4), _mm_srli_epi16(b, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 2), _mm_packus_epi16(wa, wb));
+    }
+    return i;
+}
+
+
+/**
+ * @brief Base64-encodes 12 bytes per iteration (reads 16); returns how many input bytes were done.
+ *
+ * Byte shuffle and 6-bit split as in W. Muła's SSE base64 encoder; the
+ * alphabet lookup adds a per-range offset selected with pshufb.
+ */
+__attribute__((target("ssse3")))
+size_t base64EncodeSsse3(const unsigned char* in, size_t n, char* out) {
+    const __m128i shuffle = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                          '/' - 63, 'A', 0, 0);
+    size_t i = 0, o = 0;
+    for (; i + 16 <= n; i += 12, o += 16) {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), shuffle);
+        const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        const __m128i idx = _mm_or_si128(t0, t1); ///< one 6-bit index per byte
+        // 0..25 -> 13 ('A'), 26..51 -> 0 ('a' - 26), 52..61 -> 1..10, 62 -> 11, 63 -> 12
+        __m128i range = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+        range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), idx), _mm_set1_epi8(13)));
+        v = _mm_add_epi8(idx, _mm_shuffle_epi8(offsets, range));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), v);
+    }
+    return i;
+}
+
+
+/**
+ * @brief Base64-decodes 16 characters per iteration (writes 16 bytes, 12 valid).
+ *
+ * The caller guarantees 4 bytes of slack after the output. Stops at the
+ * first block with a character outside the alphabet (padding included).
+ * Validation and packing follow the Klomp / Muła SSSE3 decoder.
+ *
+ * @return Number of input characters consumed (multiple of 16).
+ */
+__attribute__((target("ssse3")))
+size_t base64DecodeSsse3(const char* in, size_t n, unsigned char* out) {
+    const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                        0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0, o = 0;
+    for (; i + 16 <= n; i += 16, o += 12) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i hi = _mm_and_si128(_mm_srli_epi32(c, 4), mask);
+        const __m128i lo = _mm_and_si128(c, mask);
+        const __m128i bad = _mm_and_si128(_mm_shuffle_epi8(lutLo, lo), _mm_shuffle_epi8(lutHi, hi));
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(bad, _mm_setzero_si128())) != 0) break;
+        const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8('/')), hi));
+        const __m128i v = _mm_add_epi8(c, roll);                                     ///< 6-bit values
+        const __m128i ab = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));          ///< 12-bit pairs
+        const __m128i abcd = _mm_madd_epi16(ab, _mm_set1_epi32(0x00011000));          ///< 24-bit groups
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), _mm_shuffle_epi8(abcd, pack));
+    }
+    return i;
+}
+
+
+bool cpuHasSsse3() {
+    static const bool has = __builtin_cpu_supports("ssse3");
+    return has;
+}
+
+#endif // TEXTCODEC_X86
+
+// ---------------- Scalar base64 ------------------
+
+void base64EncodeScalar(const unsigned char* in, size_t n, char* out) {
+    size_t i = 0;
+    for (; i + 3 <= n; i += 3, out += 4) {
+        const uint32_t v = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8) | in[i + 2];
+        out[0] = kBase64Alphabet[v >> 18];
+        out[1] = kBase64Alphabet[(v >> 12) & 63];
+        out[2] = kBase64Alphabet[(v >> 6) & 63];
+        out[3] = kBase64Alphabet[v & 63];
+    }
+    if (i < n) {
+        const uint32_t v = (uint32_t(in[i]) << 16) | (i + 1 < n ? uint32_t(in[i + 1]) << 8 : 0);
+        out[0] = kBase64Alphabet[v >> 18];
+        out[1] = kBase64Alphabet[(v >> 12) & 63];
+        out[2] = (i + 1 < n) ? kBase64Alphabet[(v >> 6) & 63] : '=';
+        out[3] = '=';
+    }
+}
+
+
+/**
+ * @brief Decodes complete groups of 4 characters; padding is only accepted in the last group.
+ *
+ * @param in Characters (no whitespace), n a multiple of 4.
+ * @param out Receives up to n / 4 * 3 bytes (plus 4 bytes of slack for the SIMD path).
+ * @param padded Set when the last group carried '=' padding.
+ * @return Bytes written, or SIZE_MAX on invalid input.
+ */
+size_t base64DecodeGroups(const char* in, size_t n, unsigned char* out, bool& padded) {
+    padded = false;
+    size_t i = 0, o = 0;
+#ifdef TEXTCODEC_X86
+    if (cpuHasSsse3() && n >= 20) {
+        i = base64DecodeSsse3(in, n - 4, out); ///< keep the last group (maybe padded) for the scalar loop
+        o = i / 4 * 3;
+    }
+#endif
+    for (; i < n; i += 4) {
+        const int a = kBase64Values[static_cast<unsigned char>(in[i])];
+        const int b = kBase64Values[static_cast<unsigned char>(in[i + 1])];
+        int c = kBase64Values[static_cast<unsigned char>(in[i + 2])];
+        int d = kBase64Values[static_cast<unsigned char>(in[i + 3])];
+        size_t bytes = 3;
+        if (i + 4 == n && in[i + 3] == '=') { ///< "xx==" or "xxx="
+            bytes = (in[i + 2] == '=') ? 1 : 2;
+            if (bytes == 1) c = 0;
+            d = 0;
+            padded = true;
+        }
+        if ((a | b | c | d) < 0) return SIZE_MAX;
+        const uint32_t v = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | uint32_t(d);
+        out[o++] = static_cast<unsigned char>(v >> 16);
+        if (bytes > 1) out[o++] = static_cast<unsigned char>(v >> 8);
+        if (bytes > 2) out[o++] = static_cast<unsigned char>(v);
+    }
+    return o;
+}
+
+} // namespace
+
+// ---------------- Hex ------------------
+
+/**
+ * @brief Encodes n bytes as 2n lowercase hex characters.
+ */
+void hexEncode(const unsigned char* in, size_t n, char* out) {
+    size_t i = 0;
+#ifdef TEXTCODEC_X86
+    i = hexEncodeSse2(in, n, out);
+#endif
+    for (; i < n; ++i) {
+        out[2 * i] = kHexDigits[in[i] >> 4];
+        out[2 * i + 1] = kHexDigits[in[i] & 15];
+    }
+}
+
+
+/**
+ * @brief Decodes n hex characters (either case) into n / 2 bytes.
+ *
+ * @return false if n is odd or a character is not a hex digit (out is then partly written).
+ */
+bool hexDecode(const char* in, size_t n, unsigned char* out) {
+    if (n % 2 != 0) return false;
+    size_t i = 0;
+#ifdef TEXTCODEC_X86
+    i = hexDecodeSse2(in, n, out);
+#endif
+    for (; i < n; i += 2) {
+        const int hi = kHexValues[static_cast<unsigned char>(in[i])];
+        const int lo = kHexValues[static_cast<unsigned char>(in[i + 1])];
+        if ((hi | lo) < 0) return false;
+        out[i / 2] = static_cast<unsigned char>((hi << 4) | lo);
+    }
+    return true;
+}
+
+
+std::string toHex(const void* data, size_t n) {
+    std::string hex(2 * n, '\0');
+    hexEncode(static_cast<const unsigned char*>(data), n, &hex[0]);
+    return hex;
+}
+
+
+bool fromHex(const std::string& hex, std::string& raw) {
+    raw.assign(hex.size() / 2, '\0');
+    if (hexDecode(hex.data(), hex.size(), reinterpret_cast<unsigned char*>(&raw[0]))) return true;
+    raw.clear();
+    return false;
+}
+
+// ---------------- Base64 ------------------
+
+/**
+ * @brief Encodes n bytes as base64EncodedSize(n) characters with '=' padding.
+ */
+void base64Encode(const unsigned char* in, size_t n, char* out) {
+    size_t i = 0;
+#ifdef TEXTCODEC_X86
+    if (cpuHasSsse3()) i = base64EncodeSsse3(in, n, out);
+#endif
+    base64EncodeScalar(in + i, n - i, out + i / 3 * 4);
+}
+
+
+Base64StreamEncoder::Base64StreamEncoder(size_t lineLength)
+    : lineLength(lineLength == 0 ? 0 : std::max<size_t>(4, lineLength - lineLength % 4)) {}
+
+
+void Base64StreamEncoder::encodeGroups(const unsigned char* data, size_t n, std::string& out) {
+    while (n > 0) {
+        size_t take = n;
+        if (lineLength) take = std::min(n, (lineLength - column) / 4 * 3);
+        const size_t chars = base64EncodedSize(take);
+        const size_t at = out.size();
+        out.resize(at + chars);
+        base64Encode(data, take, &out[at]);
+        data += take;
+        n -= take;
+        if (lineLength) {
+            column += chars;
+            if (column == lineLength) {
+                out += '\n';
+                column = 0;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Encodes whole 3-byte groups; up to two trailing bytes wait for more input or final().
+ */
+void Base64StreamEncoder::update(const unsigned char* data, size_t n, std::string& out) {
+    if (carried > 0) {
+        while (carried < 3 && n > 0) {
+            carry[carried++] = *data++;
+            --n;
+        }
+        if (carried < 3) return;
+        encodeGroups(carry, 3, out);
+        carried = 0;
+    }
+    const size_t whole = n - n % 3;
+    encodeGroups(data, whole, out);
+    for (size_t i = whole; i < n; ++i) carry[carried++] = data[i];
+}
+
+
+void Base64StreamEncoder::final(std::string& out) {
+    encodeGroups(carry, carried, out);
+    carried = 0;
+    if (lineLength && column > 0) {
+        out += '\n';
+        column = 0;
+    }
+}
+
+
+bool Base64StreamDecoder::decodeGroups(std::string& out) {
+    const size_t n = pending.size() - pending.size() % 4;
+    if (n == 0) return true;
+    if (ended) return false; ///< data after the padding
+    const size_t at = out.size();
+    out.resize(at + n / 4 * 3 + 4); ///< SIMD stores write 4 bytes past the last group
+    bool padded = false;
+    const size_t got = base64DecodeGroups(pending.data(), n, reinterpret_cast<unsigned char*>(&out[at]), padded);
+    if (got == SIZE_MAX) {
+        out.resize(at);
+        return false;
+    }
+    out.resize(at + got);
+    ended = padded;
+    pending.erase(0, n);
+    return true;
+}
+
+
+/**
+ * @brief Decodes the complete groups in `text` (whitespace skipped); the rest waits for more input.
+ *
+ * @return false on a character outside the alphabet or data after the padding.
+ */
+bool Base64StreamDecoder::update(const char* text, size_t n, std::string& out) {
+    size_t i = 0;
+    while (i < n) {
+        size_t j = i;
+        while (j < n && !isBase64Space(text[j])) ++j;
+        pending.append(text + i, j - i);
+        while (j < n && isBase64Space(text[j])) ++j;
+        i = j;
+    }
+    return decodeGroups(out);
+}
+
+
+bool Base64StreamDecoder::final(std::string& out) {
+    return decodeGroups(out) && pending.empty();
+}
+
+
+const char* textCodecPath() {
+#ifdef TEXTCODEC_X86
+    return cpuHasSsse3() ? "ssse3" : "sse2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,59 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <cstddef>  // size_t
+#include <string>   // encoded / decoded text
+
+// Hex and base64 (RFC 4648, standard alphabet, '=' padding) for keys,
+// digests, manifests and armored output. On x86-64 the bulk loops use SSE2
+// (hex) and SSSE3 (base64, chosen at run time); other targets and the tails
+// use the scalar tables. The output is identical on every path.
+
+// ---------------- Hex ------------------
+
+void hexEncode(const unsigned char* in, size_t n, char* out);   // writes 2n lowercase chars
+bool hexDecode(const char* in, size_t n, unsigned char* out);   // n even, any case; false on non-hex
+
+std::string toHex(const void* data, size_t n);
+inline std::string toHex(const std::string& raw) { return toHex(raw.data(), raw.size()); }
+bool fromHex(const std::string& hex, std::string& raw);         // false on odd length / non-hex
+
+// ---------------- Base64 ------------------
+
+inline size_t base64EncodedSize(size_t n) { return (n + 2) / 3 * 4; }
+void base64Encode(const unsigned char* in, size_t n, char* out); // padded, no line breaks
+
+// Incremental encoder: holds back at most two bytes between calls and
+// breaks lines after `lineLength` characters (0 = one line; rounded down
+// to a multiple of 4 so every line decodes on its own).
+class Base64StreamEncoder {
+public:
+    explicit Base64StreamEncoder(size_t lineLength = 0);
+
+    void update(const unsigned char* data, size_t n, std::string& out); // appends to out
+    void final(std::string& out);                                        // padding + last line break
+
+private:
+    void encodeGroups(const unsigned char* data, size_t n, std::string& out); // n multiple of 3, or the tail
+
+    size_t lineLength;
+    size_t column = 0;          ///< characters on the current line
+    unsigned char carry[3];     ///< a group being completed across calls
+    size_t carried = 0;
+};
+
+// Incremental decoder: ignores whitespace (line breaks from any encoder),
+// rejects anything else outside the alphabet and data after the padding.
+class Base64StreamDecoder {
+public:
+    bool update(const char* text, size_t n, std::string& out); // appends decoded bytes
+    bool final(std::string& out);                              // false if a group is incomplete
+
+private:
+    bool decodeGroups(std::string& out);
+
+    std::string pending;        ///< non-whitespace characters not yet decoded
+    bool ended = false;         ///< padding seen
+};
+
+// Which bulk implementation this CPU uses ("ssse3", "sse2" or "scalar"), for bench output.
+const char* textCodecPath();
@@ -0,0 +1,372 @@
+#include "throttle.h"
+
+#include <algorithm>     // min
+#include <cctype>        // isdigit
+#include <cerrno>        // ERANGE from strtoull
+#include <cstdlib>       // strtoull
+#include <fstream>       // control file
+#include <sstream>       // settings parsing
+
+#include <sys/stat.h>     // control file mtime
+
+#include <sys/resource.h> // setpriority
+#include <unistd.h>       // syscall
+#ifdef __linux__
+#include <sys/syscall.h>  // SYS_ioprio_set / SYS_ioprio_get
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+// ioprio ABI (linux/ioprio.h is not always installed)
+static const int kIoprioClassShift = 13;
+static const int kIoprioClassBe = 2;
+static const int kIoprioClassIdle = 3;
+static const int kIoprioWhoProcess = 1; ///< with id 0: the calling thread
+
+static thread_local Throttle* tlThrottle = nullptr;
+static thread_local IoClass tlAppliedIoClass = IoClass::Default; ///< class this thread runs with now
+static thread_local int tlSavedIoprio = -1; ///< raw ioprio on scope entry, -1 = unknown
+
+// ---------------- TokenBucket ------------------
+
+TokenBucket::TokenBucket(uint64_t bytesPerSecond)
+    : bytesPerSec(bytesPerSecond), last(Clock::now()) {}
+
+
+/**
+ * @brief Changes the rate; blocked acquirers re-evaluate immediately.
+ *
+ * @param bytesPerSecond New rate, 0 = unlimited.
+ */
+void TokenBucket::setRate(uint64_t bytesPerSecond) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bytesPerSec.store(bytesPerSecond, std::memory_order_relaxed);
+        last = Clock::now();
+        tokens = std::min(tokens, double(bytesPerSecond)); ///< never carry more than one second of burst
+    }
+    rateChanged.notify_all();
+}
+
+
+/**
+ * @brief Takes `bytes` tokens, waiting while the bucket is in debt.
+ *
+ * A request larger than the bucket is allowed through and leaves a debt, so
+ * big chunks are paced correctly instead of blocking forever.
+ *
+ * @param bytes Bytes about to be (or just) transferred.
+ */
+void TokenBucket::acquire(uint64_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        const uint64_t r = bytesPerSec.load(std::memory_order_relaxed);
+        if (r == 0) return;
+
+        const auto now = Clock::now();
+        tokens = std::min(double(r), tokens + std::chrono::duration<double>(now - last).count() * double(r));
+        last = now;
+        if (tokens >= 0) {
+            tokens -= double(bytes);
+            return;
+        }
+        rateChanged.wait_for(lock, std::chrono::duration<double>(-tokens / double(r)));
+    }
+}
+
+
+// ---------------- ConcurrencyLimiter ------------------
+
+ConcurrencyLimiter::ConcurrencyLimiter(unsigned limit) : max(limit) {}
+
+
+/**
+ * @brief Changes the limit; lowering it lets running items finish, raising it wakes waiters.
+ *
+ * @param limit New limit, 0 = unlimited.
+ */
+void ConcurrencyLimiter::setLimit(unsigned limit) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        max.store(limit, std::memory_order_relaxed);
+    }
+    slotFreed.notify_all();
+}
+
+
+/**
+ * @brief Waits for a free slot and takes it.
+ */
+void ConcurrencyLimiter::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    slotFreed.wait(lock, [this] {
+        unsigned m = max.load(std::memory_order_relaxed);
+        return m == 0 || active < m;
+    });
+    ++active;
+}
+
+
+/**
+ * @brief Takes a free slot without waiting.
+ *
+ * @return false if the limit is reached.
+ */
+bool ConcurrencyLimiter::tryAcquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    const unsigned m = max.load(std::memory_order_relaxed);
+    if (m != 0 && active >= m) return false;
+    ++active;
+    return true;
+}
+
+
+/**
+ * @brief Returns a slot taken with acquire() or tryAcquire().
+ */
+void ConcurrencyLimiter::release() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        --active;
+    }
+    slotFreed.notify_one();
+}
+
+
+// ---------------- Priorities ------------------
+
+const char* ioClassName(IoClass cls) {
+    switch (cls) {
+    case IoClass::Default:    return "default";
+    case IoClass::BestEffort: return "best-effort";
+    case IoClass::Idle:       return "idle";
+    }
+    return "default";
+}
+
+
+bool parseIoClass(const std::string& name, IoClass& out) {
+    if (name == "default") out = IoClass::Default;
+    else if (name == "best-effort" || name == "be") out = IoClass::BestEffort;
+    else if (name == "idle") out = IoClass::Idle;
+    else return false;
+    return true;
+}
+
+
+/**
+ * @brief Sets the calling thread's I/O scheduling class (Linux only).
+ *
+ * @param cls Class to apply; Default does nothing.
+ * @param level Priority within BestEffort, 0 (high) .. 7 (low).
+ * @return true if applied (or nothing to do).
+ */
+bool setThreadIoClass(IoClass cls, int level) {
+    if (cls == IoClass::Default) return true;
+#if defined(__linux__) && defined(SYS_ioprio_set)
+    int value = (cls == IoClass::Idle) ? (kIoprioClassIdle << kIoprioClassShift)
+                                       : ((kIoprioClassBe << kIoprioClassShift) | std::min(std::max(level, 0), 7));
+    return ::syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, value) == 0;
+#else
+    (void)level;
+    return false;
+#endif
+}
+
+
+/**
+ * @brief Raises the nice value of the calling thread (Linux nice is per thread).
+ */
+bool setThreadNice(int nice) {
+    return ::setpriority(PRIO_PROCESS, 0, nice) == 0;
+}
+
+
+// ---------------- Throttle ------------------
+
+/**
+ * @brief Parses a byte count such as "512K", "50M" or "1G".
+ *
+ * Signs, leading spaces and values that do not fit in 64 bits after the
+ * suffix is applied are rejected.
+ */
+bool parseByteSize(const std::string& text, uint64_t& out) {
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) return false;
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long long v = std::strtoull(text.c_str(), &end, 10);
+    if (errno == ERANGE) return false;
+    const std::string suffix(end);
+    unsigned shift = 0;
+    if (suffix == "K" || suffix == "k") shift = 10;
+    else if (suffix == "M" || suffix == "m") shift = 20;
+    else if (suffix == "G" || suffix == "g") shift = 30;
+    else if (!suffix.empty()) return false;
+    if (v > (UINT64_MAX >> shift)) return false;
+    out = static_cast<uint64_t>(v) << shift;
+    return true;
+}
+
+
+/**
+ * @brief Parses a worker count; suffixes, signs and values above kMaxWorkerLimit are rejected.
+ */
+bool parseWorkerCount(const std::string& text, unsigned& out) {
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) return false;
+    char* end = nullptr;
+    const unsigned long long v = std::strtoull(text.c_str(), &end, 10);
+    if (*end != '\0' || v > kMaxWorkerLimit) return false;
+    out = static_cast<unsigned>(v);
+    return true;
+}
+
+
+/**
+ * @brief Applies "key=value" lines (rate, workers, ioclass) to a running throttle.
+ *
+ * @param text Settings, e.g. the contents of a control file.
+ * @return false if a known key had an invalid value (valid keys are still applied).
+ */
+bool Throttle::applySettings(const std::string& text) {
+    std::istringstream in(text);
+    std::string line;
+    bool ok = true;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t eq = line.find('=');
+        if (line.empty() || line[0] == '#' || eq == std::string::npos) continue;
+        const std::string k = line.substr(0, eq), v = line.substr(eq + 1);
+        uint64_t n;
+        unsigned count;
+        IoClass cls;
+        if (k == "rate") {
+            if (parseByteSize(v, n)) bandwidth.setRate(n); else ok = false;
+        } else if (k == "workers") {
+            if (parseWorkerCount(v, count)) workers.setLimit(count); else ok = false;
+        } else if (k == "ioclass") {
+            if (parseIoClass(v, cls)) ioClass.store(cls); else ok = false;
+        }
+    }
+    return ok;
+}
+
+
+/**
+ * @brief Returns the process-wide throttle for background work (unlimited by default).
+ */
+Throttle& Throttle::background() {
+    static Throttle t;
+    return t;
+}
+
+
+// ---------------- Control file ------------------
+
+/**
+ * @brief Starts watching `path`; an existing file is applied right away.
+ *
+ * @param path Control file with Throttle::applySettings() syntax.
+ * @param target Throttle to reshape.
+ */
+ThrottleControlFile::ThrottleControlFile(const std::string& path, Throttle& target)
+    : path(path), target(target), thread([this] { run(); }) {}
+
+
+ThrottleControlFile::~ThrottleControlFile() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+}
+
+
+/**
+ * @brief Watcher thread: re-applies the file whenever its mtime or size changes.
+ */
+void ThrottleControlFile::run() {
+    struct timespec lastMtime = {0, 0};
+    off_t lastSize = -1;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        struct stat st;
+        if (::stat(path.c_str(), &st) == 0 &&
+            (st.st_mtim.tv_sec != lastMtime.tv_sec || st.st_mtim.tv_nsec != lastMtime.tv_nsec ||
+             st.st_size != lastSize)) {
+            lastMtime = st.st_mtim;
+            lastSize = st.st_size;
+            std::ifstream in(path);
+            std::stringstream text;
+            text << in.rdbuf();
+            target.applySettings(text.str());
+        }
+        wake.wait_for(lock, std::chrono::seconds(1));
+    }
+}
+
+
+// ---------------- Thread scope ------------------
+
+/**
+ * @brief Brings the calling thread's I/O class in line with its throttle.
+ *
+ * Called on scope entry and for every chunk (throttleIo), so a class changed
+ * while a job runs takes effect at the next chunk. Default restores the
+ * priority saved on scope entry instead of leaving the old class in place.
+ */
+static void syncIoClass() {
+    const IoClass wanted = tlThrottle ? tlThrottle->ioClass.load(std::memory_order_relaxed) : IoClass::Default;
+    if (wanted == tlAppliedIoClass) return;
+#if defined(__linux__) && defined(SYS_ioprio_set)
+    if (wanted == IoClass::Default) {
+        if (tlSavedIoprio >= 0) ::syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, tlSavedIoprio);
+    } else {
+        setThreadIoClass(wanted);
+    }
+#endif
+    tlAppliedIoClass = wanted;
+}
+
+
+ThrottleScope::ThrottleScope(Throttle* t)
+    : previous(tlThrottle), previousApplied(tlAppliedIoClass), previousSavedIoprio(tlSavedIoprio) {
+    tlThrottle = t;
+    tlAppliedIoClass = IoClass::Default; ///< i.e. whatever the thread runs with right now
+    tlSavedIoprio = -1;
+#if defined(__linux__) && defined(SYS_ioprio_get)
+    if (t) tlSavedIoprio = static_cast<int>(::syscall(SYS_ioprio_get, kIoprioWhoProcess, 0));
+#endif
+    syncIoClass();
+}
+
+
+ThrottleScope::~ThrottleScope() {
+#if defined(__linux__) && defined(SYS_ioprio_set)
+    if (tlAppliedIoClass != IoClass::Default && tlSavedIoprio >= 0)
+        ::syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, tlSavedIoprio);
+#endif
+    tlThrottle = previous;
+    tlAppliedIoClass = previousApplied;
+    tlSavedIoprio = previousSavedIoprio;
+}
+
+
+/**
+ * @brief Throttle installed on the calling thread, or nullptr.
+ */
+Throttle* currentThrottle() {
+    return tlThrottle;
+}
+
+
+/**
+ * @brief Charges transferred bytes to the current throttle (no-op without one).
+ *
+ * Also picks up a changed I/O class before the chunk is transferred.
+ */
+void throttleIo(size_t bytes) {
+    if (!tlThrottle) return;
+    syncIoClass();
+    tlThrottle->bandwidth.acquire(bytes);
+}
@@ -0,0 +1,125 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <atomic>             // lock-free settings reads
+#include <chrono>             // token refill clock
+#include <condition_variable> // blocked acquirers
+#include <cstddef>            // size_t
+#include <cstdint>            // byte counts
+#include <mutex>              // bucket / slot state
+#include <string>             // control file parsing
+#include <thread>             // control file watcher
+
+// Resource shaping for background jobs: a byte-rate token bucket, an
+// adjustable worker-concurrency limit and Linux I/O / CPU priorities.
+// Every setting can be changed while a job runs and takes effect at the next
+// chunk. Engine I/O loops call throttleIo() and WorkerPool::parallelFor()
+// honours the concurrency limit of the throttle installed on the calling
+// thread (see ThrottleScope); without one, both are no-ops.
+
+// Token bucket limiting bytes per second; 0 = unlimited.
+class TokenBucket {
+public:
+    explicit TokenBucket(uint64_t bytesPerSecond = 0);
+
+    void setRate(uint64_t bytesPerSecond);
+    uint64_t rate() const { return bytesPerSec.load(std::memory_order_relaxed); }
+    void acquire(uint64_t bytes); // blocks until the bytes may be transferred
+
+private:
+    std::atomic<uint64_t> bytesPerSec;
+    std::mutex mutex;
+    std::condition_variable rateChanged;
+    double tokens = 0;                               ///< may go negative (debt) for large requests
+    std::chrono::steady_clock::time_point last;
+};
+
+// Counting semaphore whose limit can change at any time; 0 = unlimited.
+class ConcurrencyLimiter {
+public:
+    explicit ConcurrencyLimiter(unsigned limit = 0);
+
+    void setLimit(unsigned limit);
+    unsigned limit() const { return max.load(std::memory_order_relaxed); }
+    void acquire();
+    bool tryAcquire();  // takes a slot only if one is free right now
+    void release();
+
+private:
+    std::atomic<unsigned> max;
+    unsigned active = 0;
+    std::mutex mutex;
+    std::condition_variable slotFreed;
+};
+
+// Linux I/O scheduling classes (ioprio_set); Default leaves the thread alone.
+enum class IoClass { Default, BestEffort, Idle };
+
+const char* ioClassName(IoClass cls);
+bool parseIoClass(const std::string& name, IoClass& out);
+
+// Applies an I/O class (level 0..7 for BestEffort) to the calling thread.
+// Returns false if the kernel refused.
+bool setThreadIoClass(IoClass cls, int level = 4);
+
+// Lowers the CPU priority of the calling thread. Unprivileged processes
+// cannot undo this, so it is meant for whole background processes (CLI).
+bool setThreadNice(int nice);
+
+struct Throttle {
+    TokenBucket bandwidth;               // bytes per second across all workers
+    ConcurrencyLimiter workers;          // items processed at the same time
+    std::atomic<IoClass> ioClass{IoClass::Default};
+
+    // "rate=50M\nworkers=2\nioclass=idle" - unknown keys are ignored.
+    bool applySettings(const std::string& text);
+
+    static Throttle& background(); // shared by GUI batch jobs and long-running CLI commands
+};
+
+// Installs `t` as the calling thread's throttle for the scope's lifetime and
+// applies its I/O class. throttleIo() re-checks the class, so a change made
+// while the scope is active (control file, GUI) reaches the thread at its
+// next chunk; Default puts back the priority the thread had on entry. The
+// previous state is restored when the scope ends.
+class ThrottleScope {
+public:
+    explicit ThrottleScope(Throttle* t);
+    ~ThrottleScope();
+
+    ThrottleScope(const ThrottleScope&) = delete;
+    ThrottleScope& operator=(const ThrottleScope&) = delete;
+
+private:
+    Throttle* previous;
+    IoClass previousApplied;   ///< enclosing scope's state, restored on exit
+    int previousSavedIoprio;
+};
+
+// Parses a byte count with an optional K/M/G (binary) suffix, e.g. "50M".
+bool parseByteSize(const std::string& text, uint64_t& out);
+
+// Parses a worker count: plain decimal, 0 (unlimited) .. kMaxWorkerLimit.
+constexpr unsigned kMaxWorkerLimit = 4096;
+bool parseWorkerCount(const std::string& text, unsigned& out);
+
+// Polls a control file (about once a second) and applies it to a throttle
+// whenever it changes, so long-running CLI jobs can be reshaped from outside:
+//   echo rate=10M > /run/cryptoqtapp.ctl
+class ThrottleControlFile {
+public:
+    ThrottleControlFile(const std::string& path, Throttle& target);
+    ~ThrottleControlFile();
+
+private:
+    void run();
+
+    std::string path;
+    Throttle& target;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread thread;
+};
+
+Throttle* currentThrottle();
+void throttleIo(size_t bytes); // charge bytes to the current throttle's bucket (may block)
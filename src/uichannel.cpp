@@ -0,0 +1,125 @@
+#include "uichannel.h"
+
+#include <chrono> // log timestamps
+
+// ---------------- Helper functions ------------------
+
+static size_t roundUpPow2(size_t n) {
+    size_t p = 2;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+
+const char* logLevelName(LogLevel level) {
+    switch (level) {
+    case LogLevel::Debug: return "DEBUG";
+    case LogLevel::Info: return "INFO";
+    case LogLevel::Warning: return "WARN";
+    case LogLevel::Error: return "ERROR";
+    }
+    return "?";
+}
+
+
+// ---------------- UiChannel ------------------
+
+UiChannel::UiChannel(size_t logCapacity)
+    : cells(new Cell[roundUpPow2(logCapacity)]), mask(roundUpPow2(logCapacity) - 1) {
+    for (size_t i = 0; i <= mask; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+
+/**
+ * @brief Publishes absolute progress; the GUI shows it at its next tick.
+ */
+void UiChannel::setProgress(uint64_t done, uint64_t total) {
+    totalBytes.store(total, std::memory_order_relaxed);
+    doneBytes.store(done, std::memory_order_relaxed);
+    progressGeneration.fetch_add(1, std::memory_order_release);
+}
+
+
+void UiChannel::addProgress(uint64_t bytes) {
+    doneBytes.fetch_add(bytes, std::memory_order_relaxed);
+    progressGeneration.fetch_add(1, std::memory_order_release);
+}
+
+
+void UiChannel::setStatus(const std::string& text) {
+    std::lock_guard<std::mutex> lock(statusMutex);
+    statusText = text;
+    statusGeneration.fetch_add(1, std::memory_order_release);
+}
+
+
+/**
+ * @brief Queues one log line without blocking.
+ *
+ * Claims a cell by CAS on the enqueue position; a cell whose sequence does
+ * not match yet is still held by the consumer, i.e. the ring is full.
+ *
+ * @return false if the ring is full; the line is dropped and counted.
+ */
+bool UiChannel::log(LogLevel level, std::string text) {
+    const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::system_clock::now().time_since_epoch()).count();
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[pos & mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.line.level = level;
+                cell.line.timeMs = now;
+                cell.line.text = std::move(text);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            droppedLines.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+
+/**
+ * @brief Collects what changed since the previous sample (GUI thread).
+ *
+ * @param out Receives progress, status and up to maxLines log lines.
+ * @param maxLines Cap per tick; the rest stays queued for the next one.
+ */
+void UiChannel::sample(Sample& out, size_t maxLines) {
+    out.lines.clear();
+
+    const uint64_t pg = progressGeneration.load(std::memory_order_acquire);
+    out.progressChanged = pg != sampledProgress;
+    if (out.progressChanged) {
+        sampledProgress = pg;
+        const uint64_t total = totalBytes.load(std::memory_order_relaxed);
+        const uint64_t done = doneBytes.load(std::memory_order_relaxed);
+        out.percent = total ? static_cast<int>((done >= total ? total : done) * 100 / total) : 0;
+    }
+
+    const uint64_t sg = statusGeneration.load(std::memory_order_acquire);
+    out.statusChanged = sg != sampledStatus;
+    if (out.statusChanged) {
+        std::lock_guard<std::mutex> lock(statusMutex);
+        out.status = statusText;
+        sampledStatus = statusGeneration.load(std::memory_order_relaxed);
+    }
+
+    while (out.lines.size() < maxLines) {
+        Cell& cell = cells[dequeuePos & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1) break; ///< empty (or still being written)
+        out.lines.push_back(std::move(cell.line));
+        cell.line.text.clear();
+        cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        ++dequeuePos;
+    }
+    out.dropped = droppedLines.exchange(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,82 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <atomic>   // progress counters, ring sequence numbers
+#include <cstddef>  // size_t
+#include <cstdint>  // byte counts
+#include <memory>   // ring cells
+#include <mutex>    // status text
+#include <string>
+#include <vector>   // drained lines
+
+// Coalesced channel from worker threads to the GUI. Workers never touch
+// widgets or post events: they store progress in atomics, replace the status
+// text and push log lines into a bounded ring. The GUI samples everything on
+// one timer (30 Hz), so redraw cost per tick is bounded by maxLines no matter
+// how fast chunks complete or how many jobs run.
+//
+// The log ring is a fixed-size multi-producer / single-consumer queue
+// (sequence-numbered cells, no locks). When the GUI falls behind, new lines
+// are dropped and counted instead of growing memory or blocking workers.
+
+enum class LogLevel { Debug, Info, Warning, Error };
+
+const char* logLevelName(LogLevel level);
+
+struct LogLine {
+    LogLevel level = LogLevel::Info;
+    int64_t timeMs = 0;        // wall clock when logged, ms since the epoch
+    std::string text;
+};
+
+class UiChannel {
+public:
+    explicit UiChannel(size_t logCapacity = 4096); // rounded up to a power of two
+    UiChannel(const UiChannel&) = delete;
+    UiChannel& operator=(const UiChannel&) = delete;
+
+    // ---- any thread, never blocks on the GUI ----
+    void setProgress(uint64_t done, uint64_t total);
+    void addProgress(uint64_t bytes);          // done += bytes (several workers on one total)
+    void setStatus(const std::string& text);   // latest wins; meant for phase changes, not per chunk
+    bool log(LogLevel level, std::string text); // false if the ring is full (line dropped)
+
+    // Work in flight; the GUI stops sampling once this is 0 and nothing is pending.
+    void begin() { sources.fetch_add(1, std::memory_order_relaxed); }
+    void end() { sources.fetch_sub(1, std::memory_order_relaxed); }
+    bool active() const { return sources.load(std::memory_order_relaxed) != 0; }
+
+    // ---- GUI thread only ----
+    struct Sample {
+        bool progressChanged = false;
+        int percent = 0;                  // 0..100
+        bool statusChanged = false;
+        std::string status;
+        std::vector<LogLine> lines;       // oldest first, at most maxLines
+        uint64_t dropped = 0;             // lines lost to a full ring since the last sample
+        bool idle() const { return !progressChanged && !statusChanged && lines.empty() && !dropped; }
+    };
+    void sample(Sample& out, size_t maxLines);
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        LogLine line;
+    };
+
+    std::atomic<uint64_t> doneBytes{0};
+    std::atomic<uint64_t> totalBytes{0};
+    std::atomic<uint64_t> progressGeneration{0};
+    uint64_t sampledProgress = 0;            ///< GUI side
+
+    std::mutex statusMutex;
+    std::string statusText;
+    std::atomic<uint64_t> statusGeneration{0};
+    uint64_t sampledStatus = 0;              ///< GUI side
+
+    std::unique_ptr<Cell[]> cells;
+    const size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) size_t dequeuePos = 0;       ///< single consumer
+    std::atomic<uint64_t> droppedLines{0};
+    std::atomic<unsigned> sources{0};
+};
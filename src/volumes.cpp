@@ -0,0 +1,373 @@
+#include "volumes.h"
+#include "container.h"   // encryptContainer / readContainer
+#include "textcodec.h"   // salts and MAC in the index
+#include "throttle.h"    // throttleIo for pread slices
+#include "workerpool.h"  // parallel part encryption
+
+#include <cerrno>       // EINTR
+#include <cstdio>       // rename, snprintf
+#include <cstdlib>      // strtoull
+#include <cstring>      // memcpy
+#include <filesystem>   // absolute paths, parent directories
+#include <memory>       // slice reader position
+#include <sstream>      // index parsing
+
+#include <fcntl.h>      // open
+#include <sys/stat.h>   // fstat
+#include <unistd.h>     // pread, fdatasync, close
+
+// Crypto++ includes
+#include <cryptopp/cryptlib.h> // CryptoPP::Exception
+#include <cryptopp/hmac.h>     // index MAC
+#include <cryptopp/misc.h>     // VerifyBufsEqual
+#include <cryptopp/sha.h>      // SHA-256
+
+namespace fs = std::filesystem;
+using namespace CryptoPP;
+
+static const char kIndexMagic[] = "CQAV 1";
+static const char kIndexMacLabel[] = "CQAC/v1 volume index";
+
+// ---------------- Helper functions ------------------
+
+/**
+ * @brief HMAC-SHA256 (hex) of the index body, domain-separated from other uses of the key.
+ */
+static std::string indexMac(const SecByteBlock& key, const std::string& body) {
+    HMAC<SHA256> mac(key, key.size());
+    mac.Update(reinterpret_cast<const byte*>(kIndexMacLabel), sizeof(kIndexMacLabel) - 1);
+    mac.Update(reinterpret_cast<const byte*>(body.data()), body.size());
+    byte d[SHA256::DIGESTSIZE];
+    mac.Final(d);
+    return toHex(d, sizeof(d));
+}
+
+
+/**
+ * @brief Index entry for part i: "<index name>.NNN", in partDirs[i % n] if any.
+ */
+static std::string partPath(const std::string& indexPath, size_t i, const std::vector<std::string>& dirs) {
+    char suffix[24];
+    std::snprintf(suffix, sizeof(suffix), ".%03zu", i);
+    const std::string name = fs::path(indexPath).filename().string() + suffix;
+    if (dirs.empty()) return name;
+    return (fs::absolute(dirs[i % dirs.size()]) / name).string();
+}
+
+
+/**
+ * @brief Resolves an index entry against the index's directory.
+ */
+static std::string resolvePart(const std::string& indexPath, const std::string& entry) {
+    fs::path p(entry);
+    if (p.is_absolute()) return entry;
+    return (fs::path(indexPath).parent_path() / p).string();
+}
+
+
+/**
+ * @brief Reader over [offset, offset + length) of a file, via pread so slices can be read concurrently.
+ */
+static ByteReader sliceReader(int fd, uint64_t offset, uint64_t length) {
+    auto pos = std::make_shared<uint64_t>(offset);
+    const uint64_t end = offset + length;
+    return [fd, pos, end](unsigned char* buf, size_t n) -> ssize_t {
+        if (end - *pos < n) n = static_cast<size_t>(end - *pos);
+        size_t got = 0;
+        while (got < n) {
+            ssize_t r = ::pread(fd, buf + got, n - got, static_cast<off_t>(*pos + got));
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            if (r == 0) break;
+            got += static_cast<size_t>(r);
+        }
+        *pos += got;
+        throttleIo(got);
+        return static_cast<ssize_t>(got);
+    };
+}
+
+
+/**
+ * @brief Encrypts one slice into a part file (temp + fdatasync + rename).
+ *
+ * @param in Plaintext of this part only.
+ * @param path Final part path.
+ * @param key Master key.
+ * @param chunkSize Container record size.
+ * @param part Receives sizes and salt; path is left to the caller.
+ * @return Empty string on success, otherwise the reason.
+ */
+static std::string writePart(const ByteReader& in, const std::string& path, const SecByteBlock& key,
+                             uint32_t chunkSize, VolumePart& part) {
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+    const std::string tmp = path + ".part";
+    int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (out < 0) return "cannot create " + tmp;
+
+    byte hb[kContainerHeaderBytes];
+    part.plainBytes = part.containerBytes = 0;
+    ByteReader counted = [&](unsigned char* buf, size_t n) {
+        ssize_t r = in(buf, n);
+        if (r > 0) part.plainBytes += static_cast<uint64_t>(r);
+        return r;
+    };
+    ByteWriter writer = [&](const unsigned char* data, size_t n) {
+        if (part.containerBytes == 0 && n >= sizeof(hb)) std::memcpy(hb, data, sizeof(hb)); ///< header comes in one write
+        part.containerBytes += n;
+        return writeAll(out, data, n);
+    };
+
+    std::string error;
+    bool ok;
+    try {
+        ok = encryptContainer(counted, writer, key, chunkSize, error);
+    } catch (const Exception& e) {
+        ok = false;
+        error = e.what();
+    }
+    if (ok && ::fdatasync(out) != 0) {
+        ok = false;
+        error = "sync failed";
+    }
+    if (::close(out) != 0 && ok) {
+        ok = false;
+        error = "close failed";
+    }
+    if (ok && std::rename(tmp.c_str(), path.c_str()) != 0) {
+        ok = false;
+        error = "rename failed";
+    }
+    if (!ok) {
+        ::unlink(tmp.c_str());
+        return path + ": " + error;
+    }
+    ContainerHeader hdr;
+    hdr.parse(hb);
+    part.saltHex = toHex(hdr.salt, kContainerSaltBytes);
+    return std::string();
+}
+
+
+/**
+ * @brief Writes the index (temp + fdatasync + rename) with its MAC line.
+ */
+static bool writeIndex(const std::string& indexPath, const SecByteBlock& key, uint32_t chunkSize,
+                       const std::vector<VolumePart>& parts, std::string& error) {
+    std::string body = std::string(kIndexMagic) + "\n";
+    body += "chunk " + std::to_string(chunkSize) + "\n";
+    for (const VolumePart& p : parts)
+        body += "part " + std::to_string(p.plainBytes) + " " + std::to_string(p.containerBytes) + " "
+              + p.saltHex + " " + p.path + "\n";
+    const std::string text = body + "mac " + indexMac(key, body) + "\n";
+
+    const std::string tmp = indexPath + ".part";
+    int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    bool ok = out >= 0 && writeAll(out, text.data(), text.size()) && ::fdatasync(out) == 0;
+    if (out >= 0) ok = (::close(out) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), indexPath.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        error = "cannot write index " + indexPath;
+        return false;
+    }
+    return true;
+}
+
+
+// ---------------- Volumes ------------------
+
+/**
+ * @brief Plaintext per part: whole records of chunkSize that fit after the container header.
+ */
+uint64_t volumePlainBytes(const VolumeOptions& opt) {
+    if (opt.chunkSize == 0 || opt.volumeBytes < kContainerHeaderBytes) return 0;
+    const uint64_t records = (opt.volumeBytes - kContainerHeaderBytes) / containerRecordBytes(opt.chunkSize);
+    return records * opt.chunkSize;
+}
+
+
+/**
+ * @brief Splits the input into independently authenticated parts plus an index.
+ *
+ * @param inFd Plaintext source (file, pipe or stdin).
+ * @param indexPath Index to write; parts are named after it.
+ * @param key Master key.
+ * @param opt Part size, record size and target directories.
+ * @param error Receives a description on failure.
+ * @return true if every part and the index were written.
+ */
+bool encryptVolumes(int inFd, const std::string& indexPath, const SecByteBlock& key,
+                    const VolumeOptions& opt, std::string& error) {
+    const uint64_t perPart = volumePlainBytes(opt);
+    if (perPart == 0) {
+        error = "volume size too small for one record";
+        return false;
+    }
+
+    std::vector<VolumePart> parts;
+    struct stat st;
+    if (::fstat(inFd, &st) == 0 && S_ISREG(st.st_mode)) {
+        // Known size: every part reads its own slice, so parts are sealed and
+        // written concurrently (to different disks when partDirs says so).
+        const uint64_t size = static_cast<uint64_t>(st.st_size);
+        const size_t count = size == 0 ? 1 : static_cast<size_t>((size + perPart - 1) / perPart);
+        parts.resize(count);
+        std::vector<std::string> errors(count);
+        WorkerPool::shared().parallelFor(count, [&](size_t i) {
+            const uint64_t offset = i * perPart;
+            const uint64_t length = size - offset < perPart ? size - offset : perPart;
+            parts[i].path = partPath(indexPath, i, opt.partDirs);
+            errors[i] = writePart(sliceReader(inFd, offset, length), resolvePart(indexPath, parts[i].path),
+                                  key, opt.chunkSize, parts[i]);
+        });
+        for (const std::string& e : errors) {
+            if (!e.empty()) {
+                error = e;
+                return false;
+            }
+        }
+    } else {
+        // Stream: parts follow each other; one byte of look-ahead tells
+        // whether another part is needed, so there is no empty trailing part.
+        unsigned char pending = 0;
+        bool hasPending = false;
+        for (size_t i = 0;; ++i) {
+            uint64_t left = perPart;
+            ByteReader limited = [&](unsigned char* buf, size_t n) -> ssize_t {
+                size_t want = left < n ? static_cast<size_t>(left) : n;
+                size_t got = 0;
+                if (want > 0 && hasPending) {
+                    buf[got++] = pending;
+                    hasPending = false;
+                }
+                if (got < want) {
+                    ssize_t r = readFull(inFd, buf + got, want - got);
+                    if (r < 0) return -1;
+                    got += static_cast<size_t>(r);
+                }
+                left -= got;
+                return static_cast<ssize_t>(got);
+            };
+            VolumePart part;
+            part.path = partPath(indexPath, i, opt.partDirs);
+            std::string e = writePart(limited, resolvePart(indexPath, part.path), key, opt.chunkSize, part);
+            if (!e.empty()) {
+                error = e;
+                return false;
+            }
+            parts.push_back(part);
+
+            ssize_t r = readFull(inFd, &pending, 1);
+            if (r < 0) {
+                error = "read failed";
+                return false;
+            }
+            if (r == 0) break;
+            hasPending = true;
+        }
+    }
+    return writeIndex(indexPath, key, opt.chunkSize, parts, error);
+}
+
+
+/**
+ * @brief Authenticates the index and every part, streaming the plaintext in order.
+ *
+ * @param indexPath Index written by encryptVolumes().
+ * @param out Plaintext destination, or empty to verify only.
+ * @param key Master key.
+ * @param error Receives a description on failure (which part, and why).
+ * @return true if the whole set is intact.
+ */
+bool decryptVolumes(const std::string& indexPath, const ByteWriter& out, const SecByteBlock& key,
+                    std::string& error) {
+    int fd = ::open(indexPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "cannot open " + indexPath;
+        return false;
+    }
+    std::string text;
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0) text.append(buf, static_cast<size_t>(n));
+    ::close(fd);
+
+    const size_t macPos = text.rfind("mac ");
+    if (text.compare(0, sizeof(kIndexMagic) - 1, kIndexMagic) != 0 || macPos == std::string::npos
+        || (macPos > 0 && text[macPos - 1] != '\n')) {
+        error = indexPath + ": not a volume index";
+        return false;
+    }
+    const std::string body = text.substr(0, macPos);
+    std::string mac = text.substr(macPos + 4);
+    while (!mac.empty() && (mac.back() == '\n' || mac.back() == '\r')) mac.pop_back();
+    const std::string expected = indexMac(key, body);
+    if (mac.size() != expected.size()
+        || !VerifyBufsEqual(reinterpret_cast<const byte*>(mac.data()),
+                            reinterpret_cast<const byte*>(expected.data()), expected.size())) {
+        error = indexPath + ": index authentication failed (corrupt or wrong key)";
+        return false;
+    }
+
+    std::vector<VolumePart> parts;
+    std::istringstream lines(body);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, 5, "part ") != 0) continue;
+        std::istringstream fields(line.substr(5));
+        std::string plain, bytes;
+        VolumePart p;
+        fields >> plain >> bytes >> p.saltHex;
+        fields.get(); ///< the single space before the path
+        std::getline(fields, p.path);
+        p.plainBytes = std::strtoull(plain.c_str(), nullptr, 10);
+        p.containerBytes = std::strtoull(bytes.c_str(), nullptr, 10);
+        parts.push_back(p);
+    }
+    if (parts.empty()) {
+        error = indexPath + ": index lists no parts";
+        return false;
+    }
+
+    for (size_t i = 0; i < parts.size(); ++i) {
+        const VolumePart& p = parts[i];
+        const std::string path = resolvePart(indexPath, p.path);
+        int in = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (in < 0) {
+            error = "part " + std::to_string(i) + ": cannot open " + path;
+            return false;
+        }
+        tuneStreamFd(in);
+        struct stat st;
+        byte hb[kContainerHeaderBytes];
+        ContainerHeader hdr;
+        if (::fstat(in, &st) != 0 || static_cast<uint64_t>(st.st_size) != p.containerBytes
+            || ::pread(in, hb, sizeof(hb), 0) != static_cast<ssize_t>(sizeof(hb)) || !hdr.parse(hb)
+            || toHex(hdr.salt, kContainerSaltBytes) != p.saltHex) {
+            ::close(in);
+            error = "part " + std::to_string(i) + ": " + path + " is not the part listed in the index";
+            return false;
+        }
+        ContainerReport rep;
+        try {
+            rep = readContainer(fdReader(in), out, key);
+        } catch (const Exception& e) {
+            ::close(in);
+            error = "part " + std::to_string(i) + ": " + e.what();
+            return false;
+        }
+        ::close(in);
+        if (rep.status != ContainerReport::Status::Ok) {
+            error = "part " + std::to_string(i) + ": " + describeContainerStatus(rep.status);
+            return false;
+        }
+        if (rep.plainBytes != p.plainBytes) {
+            error = "part " + std::to_string(i) + ": size does not match the index";
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include "fdio.h"     // ByteWriter
+
+#include <cstdint>    // sizes
+#include <string>     // paths, error text
+#include <vector>     // part list / directories
+
+#include <cryptopp/secblock.h> // SecByteBlock keys
+
+// Multi-part encrypted volumes, for targets with a per-object size limit.
+//
+// The plaintext is cut into consecutive slices and each slice becomes a
+// complete container (.cqac) of at most volumeBytes bytes, so every part
+// authenticates on its own. The parts are listed in a small text index:
+//
+//   CQAV 1
+//   chunk <record size>
+//   part <plaintext bytes> <container bytes> <salt hex> <path>
+//   ...
+//   mac <HMAC-SHA256 hex>
+//
+// The MAC covers every line before it under the master key, and each part's
+// salt is unique, so a missing, reordered or foreign part is detected. Part
+// paths are relative to the index's directory unless absolute.
+
+struct VolumeOptions {
+    uint64_t volumeBytes = 0;           // maximum size of one part file
+    uint32_t chunkSize = 1u << 20;      // container record size
+    std::vector<std::string> partDirs;  // parts go round-robin into these; empty = next to the index
+};
+
+struct VolumePart {
+    std::string path;          // as written in the index
+    uint64_t plainBytes = 0;
+    uint64_t containerBytes = 0;
+    std::string saltHex;
+};
+
+// Plaintext bytes that fit into one part, 0 if volumeBytes is too small for a record.
+uint64_t volumePlainBytes(const VolumeOptions& opt);
+
+// Encrypts `inFd` into "<index>.000", "<index>.001", ... and writes the index
+// last. A regular-file input has its parts encrypted in parallel (one pread
+// slice each); other inputs are split as they stream in. Parts and index are
+// published by rename after fdatasync.
+bool encryptVolumes(int inFd, const std::string& indexPath, const CryptoPP::SecByteBlock& key,
+                    const VolumeOptions& opt, std::string& error);
+
+// Checks the index and streams the parts back in order into `out`; with an
+// empty `out` every part is authenticated without producing plaintext.
+bool decryptVolumes(const std::string& indexPath, const ByteWriter& out, const CryptoPP::SecByteBlock& key,
+                    std::string& error);
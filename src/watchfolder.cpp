@@ -0,0 +1,330 @@
+#include "watchfolder.h"
+#include "batch.h"       // encryptFileToContainer
+#include "dirwalk.h"     // matchesAnyGlob
+#include "streamhash.h"  // sha512File, writeDigestSidecar
+#include "textcodec.h"   // toHex
+#include "throttle.h"    // throttle propagation
+#include "workerpool.h"  // shared pool
+
+#include <algorithm>  // find, min
+#include <chrono>     // settle / batch timers
+#include <condition_variable> // shutdown waits for pool tasks
+#include <map>        // candidates by name
+#include <memory>     // batch shared with the pool task
+#include <mutex>      // finished list
+#include <set>        // names being processed
+#include <vector>
+
+#include <dirent.h>       // initial sweep
+#include <fcntl.h>        // O_NONBLOCK / O_CLOEXEC
+#include <poll.h>         // wait for events / completions
+#include <sys/inotify.h>  // inotify
+#include <sys/stat.h>     // stat (settle check)
+#include <unistd.h>       // pipe, read, write, close, unlink
+
+// Crypto++ includes
+#include <cryptopp/cryptlib.h> // CryptoPP::Exception
+
+using namespace CryptoPP;
+using Clock = std::chrono::steady_clock;
+
+static const int kMaxPollMs = 200;                   ///< stop flag latency
+static const unsigned kBatchFilesPerWorker = 2;      ///< batch is dispatched early once this full
+static const size_t kInotifyBufferBytes = 64 * 1024;
+
+namespace {
+
+// A spool file that is not yet ready (or ready and waiting for its batch).
+struct Candidate {
+    Clock::time_point firstSeen;
+    Clock::time_point lastEvent;
+    bool closed = false;       ///< IN_CLOSE_WRITE / IN_MOVED_TO seen since the last modification
+    bool eventSeen = false;    ///< inotify reported it (otherwise found by a sweep: stat twice)
+    bool statValid = false;    ///< size / mtime below were sampled
+    off_t size = 0;
+    struct timespec mtime = {};
+};
+
+// Outcome handed back from the pool to the watcher thread.
+struct Finished {
+    std::string name;
+    std::string error;
+    Clock::time_point firstSeen;
+};
+
+} // namespace
+
+// ---------------- Helper functions ------------------
+
+/**
+ * @brief Hashes a file and publishes "<hex>  <name>" at `dst` via rename.
+ */
+static std::string hashFileToSidecar(const std::string& src, const std::string& dst, const std::string& name) {
+    std::string digest;
+    if (!sha512File(src, digest)) return "cannot read input";
+    return writeDigestSidecar(dst, { { toHex(digest), name } }).empty() ? std::string() : "write failed";
+}
+
+
+static std::string outputPath(const WatchOptions& opt, const std::string& name) {
+    return opt.dstDir + "/" + name + (opt.action == WatchOptions::Action::Encrypt ? ".cqac" : ".sha512");
+}
+
+
+/**
+ * @brief True if two stats describe the same, unmodified file.
+ */
+static bool sameFile(const struct stat& a, const struct stat& b) {
+    return a.st_dev == b.st_dev && a.st_ino == b.st_ino && a.st_size == b.st_size
+        && a.st_mtim.tv_sec == b.st_mtim.tv_sec && a.st_mtim.tv_nsec == b.st_mtim.tv_nsec
+        && a.st_ctim.tv_sec == b.st_ctim.tv_sec && a.st_ctim.tv_nsec == b.st_ctim.tv_nsec;
+}
+
+
+/**
+ * @brief Runs the configured action for one spool file.
+ *
+ * The spool entry is stat'ed before and after. If it was replaced, written to
+ * or removed meanwhile, the output was built from something other than the
+ * final file: it is discarded and the source is left alone (the watcher
+ * queues the name again once its events settle).
+ */
+static std::string processSpoolFile(const WatchOptions& opt, const SecByteBlock& key, const std::string& name) {
+    const std::string src = opt.spoolDir + "/" + name;
+    const std::string dst = outputPath(opt, name);
+    struct stat before, after;
+    if (::stat(src.c_str(), &before) != 0) return "cannot stat input";
+    std::string err;
+    try {
+        err = opt.action == WatchOptions::Action::Encrypt ? encryptFileToContainer(src, dst, key, opt.chunkSize)
+                                                          : hashFileToSidecar(src, dst, name);
+    } catch (const Exception& e) {
+        err = e.what();
+    }
+    if (!err.empty()) return err;
+    if (::stat(src.c_str(), &after) != 0 || !sameFile(before, after)) {
+        ::unlink(dst.c_str());
+        return "input changed while it was processed; output discarded";
+    }
+    if (opt.removeSource && ::unlink(src.c_str()) != 0) return "output published, but removing the source failed";
+    return err;
+}
+
+
+/**
+ * @brief True for names the watcher should act on (no dot files, globs).
+ */
+static bool wanted(const WatchOptions& opt, const std::string& name) {
+    if (name.empty() || name[0] == '.') return false;
+    if (!opt.include.empty() && !matchesAnyGlob(opt.include, name, name)) return false;
+    return !matchesAnyGlob(opt.exclude, name, name);
+}
+
+
+// ---------------- Watch loop ------------------
+
+/**
+ * @brief Watches opt.spoolDir and processes complete files in parallel batches.
+ *
+ * @param opt Spool / target directories, action, timing.
+ * @param key Master key (Encrypt).
+ * @param stats Live counters.
+ * @param report Optional per-file callback (watcher thread).
+ * @param stop Set by another thread or a signal handler to end the loop.
+ * @param error Receives a description if watching cannot start.
+ * @return true after a clean stop.
+ */
+bool runWatchFolder(const WatchOptions& opt, const SecByteBlock& key, WatchStats& stats,
+                    const WatchReport& report, const std::atomic<bool>& stop, std::string& error) {
+    int ino = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (ino < 0) {
+        error = "inotify unavailable";
+        return false;
+    }
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY | IN_DELETE | IN_MOVED_FROM;
+    if (::inotify_add_watch(ino, opt.spoolDir.c_str(), mask | IN_ONLYDIR) < 0) {
+        ::close(ino);
+        error = "cannot watch " + opt.spoolDir;
+        return false;
+    }
+    int wake[2];
+    if (::pipe2(wake, O_NONBLOCK | O_CLOEXEC) != 0) {
+        ::close(ino);
+        error = "pipe failed";
+        return false;
+    }
+
+    WorkerPool& pool = WorkerPool::shared();
+    Throttle* throttle = currentThrottle();
+    const auto settle = std::chrono::milliseconds(opt.settleMs);
+    const auto window = std::chrono::milliseconds(opt.batchWindowMs);
+    const size_t batchLimit = pool.size() * kBatchFilesPerWorker;
+
+    std::map<std::string, Candidate> candidates;
+    std::set<std::string> busy;
+    std::map<std::string, Candidate> deferred; ///< events for busy names, queued when their job ends
+    std::vector<std::string> ready;
+    Clock::time_point readySince;
+
+    std::mutex finishedMutex;
+    std::vector<Finished> finished;
+    std::condition_variable tasksDone;
+    size_t tasksRunning = 0; ///< batch tasks still on the pool (they use the wake pipe)
+
+    // Files already in the spool (at startup, or after an event queue overflow)
+    // go through the settle check, since we cannot know whether they are complete.
+    auto sweep = [&] {
+        DIR* d = ::opendir(opt.spoolDir.c_str());
+        if (!d) return;
+        const Clock::time_point now = Clock::now();
+        while (dirent* e = ::readdir(d)) {
+            std::string name = e->d_name;
+            if (!wanted(opt, name) || candidates.count(name) || busy.count(name)) continue;
+            if (e->d_type != DT_REG && e->d_type != DT_UNKNOWN) continue;
+            if (::access(outputPath(opt, name).c_str(), F_OK) == 0) continue; ///< done in an earlier run
+            Candidate& c = candidates[name];
+            c.firstSeen = now;
+            c.lastEvent = now - settle; ///< first stat sample right away
+        }
+        ::closedir(d);
+    };
+
+    auto dispatch = [&] {
+        auto batch = std::make_shared<std::vector<std::pair<std::string, Clock::time_point>>>();
+        for (std::string& name : ready) {
+            batch->emplace_back(name, candidates[name].firstSeen);
+            candidates.erase(name);
+            busy.insert(std::move(name));
+        }
+        ready.clear();
+        ++stats.batches;
+        {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            ++tasksRunning;
+        }
+        pool.submit([&, batch] {
+            ThrottleScope scope(throttle);
+            pool.parallelFor(batch->size(), [&](size_t i) {
+                std::string err = processSpoolFile(opt, key, (*batch)[i].first);
+                {
+                    std::lock_guard<std::mutex> lock(finishedMutex);
+                    finished.push_back(Finished{ (*batch)[i].first, err, (*batch)[i].second });
+                }
+                char b = 1;
+                (void)!::write(wake[1], &b, 1); ///< pipe full is fine: the watcher is awake anyway
+            });
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            if (--tasksRunning == 0) tasksDone.notify_all();
+        });
+    };
+
+    auto collectFinished = [&] {
+        std::vector<Finished> done;
+        {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            done.swap(finished);
+        }
+        const Clock::time_point now = Clock::now();
+        for (const Finished& f : done) {
+            busy.erase(f.name);
+            auto again = deferred.find(f.name);
+            if (again != deferred.end()) { ///< dropped again while the earlier copy was processed
+                candidates[f.name] = again->second;
+                deferred.erase(again);
+            }
+            if (f.error.empty()) ++stats.filesOk;
+            else ++stats.filesFailed;
+            if (report)
+                report(f.name, f.error, std::chrono::duration<double, std::milli>(now - f.firstSeen).count());
+        }
+    };
+
+    sweep();
+    std::vector<char> buf(kInotifyBufferBytes);
+    while (!stop.load() || !busy.empty()) {
+        // Sleep until the next settle deadline or batch window, capped for the stop flag.
+        Clock::time_point now = Clock::now();
+        Clock::time_point deadline = now + std::chrono::milliseconds(kMaxPollMs);
+        if (!ready.empty()) deadline = std::min(deadline, readySince + window);
+        for (const auto& kv : candidates) {
+            const Candidate& c = kv.second;
+            if (!c.closed && !(c.eventSeen && opt.removeSource)) deadline = std::min(deadline, c.lastEvent + settle);
+        }
+        int timeout = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count());
+
+        pollfd fds[2] = { { ino, POLLIN, 0 }, { wake[0], POLLIN, 0 } };
+        ::poll(fds, 2, timeout < 0 ? 0 : timeout);
+
+        ssize_t n;
+        bool overflow = false;
+        while ((n = ::read(ino, buf.data(), buf.size())) > 0) {
+            now = Clock::now();
+            for (ssize_t off = 0; off < n;) {
+                const inotify_event* ev = reinterpret_cast<const inotify_event*>(buf.data() + off);
+                off += sizeof(inotify_event) + ev->len;
+                if (ev->mask & IN_Q_OVERFLOW) overflow = true;
+                if (ev->len == 0 || (ev->mask & IN_ISDIR)) continue;
+                std::string name = ev->name;
+                if (!wanted(opt, name)) continue;
+                std::map<std::string, Candidate>& pending = busy.count(name) ? deferred : candidates;
+
+                if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    pending.erase(name);
+                    continue;
+                }
+                auto it = pending.find(name);
+                if (it == pending.end()) {
+                    it = pending.emplace(name, Candidate()).first;
+                    it->second.firstSeen = now;
+                }
+                Candidate& c = it->second;
+                c.lastEvent = now;
+                c.eventSeen = true;
+                c.closed = (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) != 0;
+                if (!c.closed) ready.erase(std::remove(ready.begin(), ready.end(), name), ready.end());
+            }
+        }
+        if (overflow) sweep();
+
+        char drain[256];
+        while (::read(wake[0], drain, sizeof(drain)) > 0) {}
+        collectFinished();
+        if (stop.load()) continue; ///< no new batches; wait for busy ones
+
+        // Promote finished or settled files. With removeSource, a file that
+        // inotify reported is only taken once its writer closed it (or it was
+        // moved in): a writer pausing longer than settleMs must not have its
+        // file encrypted half-way and then unlinked.
+        now = Clock::now();
+        for (auto& kv : candidates) {
+            Candidate& c = kv.second;
+            if (std::find(ready.begin(), ready.end(), kv.first) != ready.end()) continue;
+            bool isReady = c.closed || (c.eventSeen && !opt.removeSource && now - c.lastEvent >= settle);
+            if (!isReady && !c.eventSeen && now - c.lastEvent >= settle) {
+                struct stat st;
+                const std::string path = opt.spoolDir + "/" + kv.first;
+                if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+                isReady = c.statValid && st.st_size == c.size && st.st_mtim.tv_sec == c.mtime.tv_sec
+                          && st.st_mtim.tv_nsec == c.mtime.tv_nsec;
+                c.statValid = true;
+                c.size = st.st_size;
+                c.mtime = st.st_mtim;
+                if (!isReady) c.lastEvent = now; ///< sample again after another quiet period
+            }
+            if (isReady) {
+                if (ready.empty()) readySince = now;
+                ready.push_back(kv.first);
+            }
+        }
+        if (!ready.empty() && (now - readySince >= window || ready.size() >= batchLimit)) dispatch();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(finishedMutex);
+        tasksDone.wait(lock, [&] { return tasksRunning == 0; });
+    }
+    ::close(wake[0]);
+    ::close(wake[1]);
+    ::close(ino);
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <atomic>     // stop flag, counters
+#include <cstdint>    // chunk size, counters
+#include <functional> // per-file report
+#include <string>     // paths
+#include <vector>     // globs
+
+#include <cryptopp/secblock.h> // SecByteBlock keys
+
+// Watch-folder ingest: files dropped into a spool directory are encrypted
+// (or hashed) into a target directory shortly after they are complete.
+//
+// inotify reports IN_CLOSE_WRITE / IN_MOVED_TO, which mark a file as
+// finished right away; files that only show IN_CREATE / IN_MODIFY (writer
+// still holding them open) become ready once their size and mtime have been
+// stable for settleMs (with removeSource they wait for the close, so a
+// slow writer never loses its file). Ready files are gathered for
+// batchWindowMs and then processed as one parallel batch on the shared
+// WorkerPool while the watcher keeps collecting the next batch. Outputs are published by rename, so
+// consumers of the target directory only ever see complete files. A file
+// that is replaced or modified while it is processed gets its output
+// discarded and is queued again, as is a file dropped again under the name
+// of one still being processed; the source is only unlinked if it is still
+// the file that was read.
+//
+// The spool is watched flat (no subdirectories). Dot files are ignored so
+// writers can use ".name.tmp" + rename for their own atomic drops.
+
+struct WatchOptions {
+    enum class Action { Encrypt, Hash };
+
+    std::string spoolDir;
+    std::string dstDir;
+    Action action = Action::Encrypt;   // Encrypt: <name>.cqac, Hash: <name>.sha512
+    std::vector<std::string> include;  // globs on the file name; empty = all
+    std::vector<std::string> exclude;
+    uint32_t chunkSize = 1u << 20;     // container record size
+    int settleMs = 250;                // quiet time for files without IN_CLOSE_WRITE (not with removeSource)
+    int batchWindowMs = 10;            // how long a batch collects arrivals
+    bool removeSource = false;         // unlink spool files once their output is published
+};
+
+struct WatchStats {
+    std::atomic<uint64_t> filesOk{0};
+    std::atomic<uint64_t> filesFailed{0};
+    std::atomic<uint64_t> batches{0};
+};
+
+// Called on the watcher thread after each file: error is empty on success,
+// latencyMs is the time from the file's first event to its published output.
+using WatchReport = std::function<void(const std::string& name, const std::string& error, double latencyMs)>;
+
+// Runs until `stop` becomes true (checked at least every 200 ms). Files
+// already in the spool when it starts are processed unless their output
+// exists. Returns false (with `error`) if the spool cannot be watched.
+bool runWatchFolder(const WatchOptions& opt, const CryptoPP::SecByteBlock& key, WatchStats& stats,
+                    const WatchReport& report, const std::atomic<bool>& stop, std::string& error);
@@ -0,0 +1,184 @@
+#include "workerpool.h"
+#include "numa.h"      // cgroup-aware sizing, CPU pinning
+#include "throttle.h"  // concurrency limit / thread throttle propagation
+
+#include <atomic>  // shared index/completion counters for parallelFor
+#include <memory>  // shared state kept alive by helper tasks
+
+// Set while the thread holds a concurrency slot, so nested parallelFor
+// calls run inside the outer slot instead of deadlocking on the limit.
+static thread_local bool tlHoldsSlot = false;
+
+static std::atomic<bool> sharedPinning{false};
+
+
+/**
+ * @brief Usable CPUs ordered round-robin across NUMA nodes, so a pool smaller
+ * than the machine (CPU quota) still uses every node's memory bandwidth.
+ */
+static std::vector<unsigned> spreadCpus() {
+    const CpuTopology& topo = CpuTopology::system();
+    std::vector<std::vector<unsigned>> perNode;
+    for (unsigned n = 0; n < topo.nodes; ++n) perNode.push_back(topo.cpusOfNode(n));
+    std::vector<unsigned> order;
+    for (size_t i = 0; order.size() < topo.cpus.size(); ++i)
+        for (const std::vector<unsigned>& cpus : perNode)
+            if (i < cpus.size()) order.push_back(cpus[i]);
+    return order;
+}
+
+
+/**
+ * @brief Starts the worker threads.
+ *
+ * @param threads Number of workers; 0 picks CpuTopology::usableThreads().
+ */
+WorkerPool::WorkerPool(unsigned threads) : WorkerPool(threads, std::vector<unsigned>()) {}
+
+
+/**
+ * @brief Starts the worker threads, optionally pinned.
+ *
+ * @param threads Number of workers; 0 picks CpuTopology::usableThreads().
+ * @param pinCpus Worker i is pinned to pinCpus[i % size]; empty = no pinning.
+ */
+WorkerPool::WorkerPool(unsigned threads, std::vector<unsigned> pinCpus) {
+    if (threads == 0) threads = CpuTopology::system().usableThreads();
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        const int cpu = pinCpus.empty() ? -1 : static_cast<int>(pinCpus[i % pinCpus.size()]);
+        workers.emplace_back([this, cpu] {
+            if (cpu >= 0) pinThreadToCpu(static_cast<unsigned>(cpu)); ///< before any buffer is touched
+            workerLoop();
+        });
+    }
+}
+
+
+/**
+ * @brief Drains the queue and joins all workers.
+ */
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+
+/**
+ * @brief Returns the process-wide pool, created on first use.
+ */
+WorkerPool& WorkerPool::shared() {
+    static WorkerPool pool(0, sharedPinning.load() ? spreadCpus() : std::vector<unsigned>());
+    return pool;
+}
+
+
+/**
+ * @brief Enables pinning for the shared pool (CLI --pin). No effect once it exists.
+ */
+void WorkerPool::setSharedPinning(bool pin) {
+    sharedPinning.store(pin);
+}
+
+
+/**
+ * @brief Queues a task for execution on any worker.
+ *
+ * @param task Callable to run; exceptions must not escape it.
+ */
+void WorkerPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    cv.notify_one();
+}
+
+
+/**
+ * @brief Runs fn(0) .. fn(count-1) across the pool and blocks until all are done.
+ *
+ * Indices are handed out dynamically, so uneven item costs (e.g. files of
+ * different sizes) still balance. The calling thread processes indices too.
+ *
+ * Under a throttle, an index is only taken while holding one of its
+ * concurrency slots. Helpers never wait for a slot: one that finds the
+ * limit reached returns its pool thread, and the caller (which waits for a
+ * slot if it has to) works through whatever is left. At most `limit`
+ * helpers are submitted in the first place.
+ *
+ * @param count Number of items.
+ * @param fn Item callback; must be thread-safe and must not throw.
+ */
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex m;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+    const size_t total = count;
+    Throttle* throttle = currentThrottle();
+
+    // wait = false: give up as soon as no slot is free (helpers)
+    auto drain = [state, total, throttle, &fn](bool wait) {
+        const bool limited = throttle && !tlHoldsSlot; ///< nested calls run inside the outer slot
+        while (state->next.load() < total) {
+            if (limited) {
+                if (wait) throttle->workers.acquire();
+                else if (!throttle->workers.tryAcquire()) return;
+                tlHoldsSlot = true;
+            }
+            const size_t i = state->next.fetch_add(1);
+            if (i < total) fn(i);
+            if (limited) {
+                tlHoldsSlot = false;
+                throttle->workers.release();
+            }
+            if (i >= total) return;
+            if (state->done.fetch_add(1) + 1 == total) {
+                std::lock_guard<std::mutex> lock(state->m);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = count - 1 < workers.size() ? count - 1 : workers.size();
+    const unsigned limit = throttle ? throttle->workers.limit() : 0;
+    if (limit != 0 && helpers > limit) helpers = limit;
+    for (size_t h = 0; h < helpers; ++h) {
+        submit([drain, throttle] {
+            ThrottleScope scope(throttle); ///< same rate limit and I/O class as the caller
+            drain(false);
+        });
+    }
+    drain(true); ///< calling thread works as well
+
+    std::unique_lock<std::mutex> lock(state->m);
+    state->finished.wait(lock, [&] { return state->done.load() == total; });
+}
+
+
+/**
+ * @brief Worker thread body: pops and runs tasks until the pool is destroyed.
+ */
+void WorkerPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return; ///< stopping and nothing left to do
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
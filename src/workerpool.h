@@ -0,0 +1,44 @@
+#pragma once  // ensures the header is only included once during compilation
+
+#include <condition_variable> // wake idle workers when tasks arrive
+#include <cstddef>            // size_t
+#include <deque>              // FIFO task queue
+#include <functional>         // std::function task type
+#include <mutex>              // protects the queue
+#include <thread>             // worker threads
+#include <vector>             // thread list
+
+// Fixed-size thread pool shared by the batch crypto operations.
+// Tasks are plain callables; parallelFor() lets the calling thread help out,
+// so it is safe to call from inside another pool task. parallelFor() carries
+// the caller's throttle (throttle.h) to the helpers and runs each item under
+// its concurrency limit.
+//
+// The default size follows the cgroup cpuset / CPU quota (numa.h). Pinned
+// pools bind worker i to cpus[i % n], so per-thread scratch buffers
+// (ScratchBuffer) end up on the worker's NUMA node.
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned threads = 0); // 0 = one worker per usable CPU
+    WorkerPool(unsigned threads, std::vector<unsigned> pinCpus); // pinned workers; empty list = unpinned
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void submit(std::function<void()> task);
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    static WorkerPool& shared(); // process-wide pool used by the GUI and engine
+    static void setSharedPinning(bool pin); // call before the first shared(); spreads workers over NUMA nodes
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+};